@@ -29,7 +29,9 @@ namespace Mandelbrot
 
 			std::array<sf::Color, 3> m_ButtonStyles;
 
-			ButtonState m_ButtonState;
+			ButtonState m_ButtonState = ButtonState::Idle;
+			// True only for the update in which the button got pressed.
+			bool m_Clicked = false;
 
 		public:
 			inline Button()
@@ -74,8 +76,10 @@ namespace Mandelbrot
 				auto mouse_pos = sf::Mouse::getPosition(win);
 
 				bool is_hovering = m_Button.getGlobalBounds().contains({ static_cast<float>(mouse_pos.x), static_cast<float>(mouse_pos.y) });
+				m_Clicked = false;
 				if (is_hovering && sf::Mouse::isButtonPressed(sf::Mouse::Button::Left))
 				{
+					m_Clicked = m_ButtonState != ButtonState::Pressed;
 					m_ButtonState = ButtonState::Pressed;
 				}
 				else if (is_hovering)
@@ -90,11 +94,29 @@ namespace Mandelbrot
 				m_Button.setFillColor(m_ButtonStyles[static_cast<std::size_t>(m_ButtonState)]);
 			}
 
+			// Moves the button and its label, see `Gui::ResizeGui`.
+			inline void SetPosition(sf::Vector2f position)
+			{
+				m_Button.setPosition(position);
+				m_ButtonText.setPosition(position);
+			}
+
+			inline sf::Vector2f GetSize() const
+			{
+				return m_Button.getSize();
+			}
+
 			inline ButtonState GetCurrentState() const
 			{
 				return m_ButtonState;
 			}
 
+			// Holding the button down only counts as one click.
+			inline bool WasClicked() const
+			{
+				return m_Clicked;
+			}
+
 		};
 	}
 }
@@ -6,6 +6,7 @@ namespace Mandelbrot
 {
 	namespace Config
 	{
+		// Size of the window when the program starts. Frames take their size from `SetResolution`.
 		static constexpr int WINDOW_WIDTH = 1280;
 		static constexpr int WINDOW_HEIGHT = 720;
 	}
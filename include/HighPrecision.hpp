@@ -0,0 +1,375 @@
+#pragma once
+#ifndef MANDELBROT_HIGHPRECISION_HPP
+#define MANDELBROT_HIGHPRECISION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Mandelbrot
+{
+	// Signed fixed point number with an arbitrary amount of fractional bits.
+	// Points of the Mandelbrot Set and their orbits are bounded, so a fixed point
+	// representation is enough and much simpler than a full floating point one.
+	//
+	// The value is stored in two's complement as 32 bit limbs, least significant first.
+	// The last limb holds the integer part, all the others the fraction.
+	class HighPrecision
+	{
+	public:
+		// Fractional limbs used when none is requested: more than a `long double` mantissa.
+		static constexpr std::size_t DefaultFractionLimbs = 4;
+
+	private:
+		std::vector<std::uint32_t> m_Limbs;
+
+	public:
+		inline HighPrecision()
+		{
+			m_Limbs.assign(DefaultFractionLimbs + 1, 0u);
+		}
+
+		inline HighPrecision(long double value, std::size_t fraction_limbs = DefaultFractionLimbs)
+		{
+			m_Limbs.assign(fraction_limbs + 1, 0u);
+
+			const bool negative = value < 0;
+			long double magnitude = std::fabs(value);
+
+			long double integer_part = std::floor(magnitude);
+			m_Limbs.back() = static_cast<std::uint32_t>(integer_part);
+			magnitude -= integer_part;
+
+			for (std::size_t i = fraction_limbs; i-- > 0;)
+			{
+				magnitude *= 4294967296.0L;
+				integer_part = std::floor(magnitude);
+				m_Limbs[i] = static_cast<std::uint32_t>(integer_part);
+				magnitude -= integer_part;
+			}
+
+			if (negative)
+			{
+				Negate();
+			}
+		}
+
+		// Parses a decimal number such as "-0.6140625273462111" or "1.5e-30".
+		// Parsing stops at the first invalid character.
+		inline static HighPrecision FromString(const std::string& text, std::size_t fraction_limbs = DefaultFractionLimbs)
+		{
+			std::size_t pos = 0;
+			bool negative = false;
+			if (pos < text.size() && (text[pos] == '-' || text[pos] == '+'))
+			{
+				negative = text[pos] == '-';
+				pos++;
+			}
+
+			std::string digits;
+			long long point = -1;
+			for (; pos < text.size(); pos++)
+			{
+				const char c = text[pos];
+				if (c >= '0' && c <= '9')
+				{
+					digits.push_back(c);
+				}
+				else if (c == '.' && point < 0)
+				{
+					point = static_cast<long long>(digits.size());
+				}
+				else
+				{
+					break;
+				}
+			}
+			if (point < 0)
+			{
+				point = static_cast<long long>(digits.size());
+			}
+
+			if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E'))
+			{
+				point += std::stoll(text.substr(pos + 1));
+			}
+
+			// Integer part: every digit left of the decimal point.
+			HighPrecision result(0.0L, fraction_limbs);
+			std::uint32_t integer_part = 0;
+			for (long long i = 0; i < point && i < static_cast<long long>(digits.size()); i++)
+			{
+				integer_part = integer_part * 10u + static_cast<std::uint32_t>(digits[static_cast<std::size_t>(i)] - '0');
+			}
+			for (long long i = static_cast<long long>(digits.size()); i < point; i++)
+			{
+				integer_part *= 10u;
+			}
+
+			// Fractional part, accumulated from the last digit: frac = (frac + digit) / 10.
+			for (long long i = static_cast<long long>(digits.size()) - 1; i >= std::max(point, 0LL); i--)
+			{
+				result.m_Limbs.back() += static_cast<std::uint32_t>(digits[static_cast<std::size_t>(i)] - '0');
+				result.DivideMagnitude(10u);
+			}
+			// Leading zeros implied by a negative exponent.
+			for (long long i = point; i < 0; i++)
+			{
+				result.DivideMagnitude(10u);
+			}
+
+			result.m_Limbs.back() = integer_part;
+
+			if (negative)
+			{
+				result.Negate();
+			}
+			return result;
+		}
+
+		// Fractional limbs needed to resolve `resolution`, plus a safety margin of `guard_bits`.
+		inline static std::size_t LimbsForResolution(long double resolution, std::size_t guard_bits = 64)
+		{
+			resolution = std::fabs(resolution);
+			if (resolution <= 0.0L || resolution >= 1.0L)
+			{
+				return DefaultFractionLimbs;
+			}
+			const std::size_t bits = static_cast<std::size_t>(std::ceil(-std::log2(resolution))) + guard_bits;
+			return std::max(DefaultFractionLimbs, (bits + 31) / 32);
+		}
+
+		inline std::size_t GetFractionLimbs() const
+		{
+			return m_Limbs.size() - 1;
+		}
+
+		// Changes the number of fractional limbs, truncating or padding the least significant ones.
+		inline void SetFractionLimbs(std::size_t fraction_limbs)
+		{
+			const std::size_t current = GetFractionLimbs();
+			if (fraction_limbs > current)
+			{
+				m_Limbs.insert(m_Limbs.begin(), fraction_limbs - current, 0u);
+			}
+			else if (fraction_limbs < current)
+			{
+				m_Limbs.erase(m_Limbs.begin(), m_Limbs.begin() + static_cast<std::ptrdiff_t>(current - fraction_limbs));
+			}
+		}
+
+		inline bool IsNegative() const
+		{
+			return (m_Limbs.back() & 0x80000000u) != 0;
+		}
+
+		inline long double ToLongDouble() const
+		{
+			HighPrecision magnitude = *this;
+			if (IsNegative())
+			{
+				magnitude.Negate();
+			}
+
+			long double value = 0.0L;
+			for (std::size_t i = 0; i < magnitude.m_Limbs.size(); i++)
+			{
+				value = value / 4294967296.0L + static_cast<long double>(magnitude.m_Limbs[i]);
+			}
+			return IsNegative() ? -value : value;
+		}
+
+		inline double ToDouble() const
+		{
+			return static_cast<double>(ToLongDouble());
+		}
+
+		// Decimal representation with `digits` fractional digits. Zero means "as many as the precision allows".
+		inline std::string ToString(std::size_t digits = 0) const
+		{
+			if (digits == 0)
+			{
+				// log10(2^32) is about 9.63 digits per limb.
+				digits = GetFractionLimbs() * 963 / 100;
+			}
+
+			HighPrecision magnitude = *this;
+			if (IsNegative())
+			{
+				magnitude.Negate();
+			}
+
+			std::string text = IsNegative() ? "-" : "";
+			text += std::to_string(magnitude.m_Limbs.back());
+			text += '.';
+
+			for (std::size_t i = 0; i < digits; i++)
+			{
+				magnitude.m_Limbs.back() = 0;
+				magnitude.MultiplyMagnitude(10u);
+				text += static_cast<char>('0' + magnitude.m_Limbs.back());
+			}
+			return text;
+		}
+
+		inline HighPrecision operator-() const
+		{
+			HighPrecision result = *this;
+			result.Negate();
+			return result;
+		}
+
+		inline HighPrecision& operator+=(const HighPrecision& other)
+		{
+			const HighPrecision* rhs = &other;
+			HighPrecision aligned;
+			if (other.GetFractionLimbs() != GetFractionLimbs())
+			{
+				if (other.GetFractionLimbs() > GetFractionLimbs())
+				{
+					SetFractionLimbs(other.GetFractionLimbs());
+				}
+				else
+				{
+					aligned = other;
+					aligned.SetFractionLimbs(GetFractionLimbs());
+					rhs = &aligned;
+				}
+			}
+
+			std::uint64_t carry = 0;
+			for (std::size_t i = 0; i < m_Limbs.size(); i++)
+			{
+				const std::uint64_t sum = static_cast<std::uint64_t>(m_Limbs[i]) + rhs->m_Limbs[i] + carry;
+				m_Limbs[i] = static_cast<std::uint32_t>(sum);
+				carry = sum >> 32;
+			}
+			return *this;
+		}
+
+		inline HighPrecision& operator-=(const HighPrecision& other)
+		{
+			return *this += -other;
+		}
+
+		inline HighPrecision operator+(const HighPrecision& other) const
+		{
+			HighPrecision result = *this;
+			result += other;
+			return result;
+		}
+
+		inline HighPrecision operator-(const HighPrecision& other) const
+		{
+			HighPrecision result = *this;
+			result -= other;
+			return result;
+		}
+
+		// The result has the precision of the most precise operand and is truncated toward zero.
+		inline HighPrecision operator*(const HighPrecision& other) const
+		{
+			const std::size_t fraction_limbs = std::max(GetFractionLimbs(), other.GetFractionLimbs());
+
+			HighPrecision a = *this;
+			HighPrecision b = other;
+			a.SetFractionLimbs(fraction_limbs);
+			b.SetFractionLimbs(fraction_limbs);
+
+			const bool negative = a.IsNegative() != b.IsNegative();
+			if (a.IsNegative())
+			{
+				a.Negate();
+			}
+			if (b.IsNegative())
+			{
+				b.Negate();
+			}
+
+			const std::size_t n = fraction_limbs + 1;
+			std::vector<std::uint32_t> product(2 * n, 0u);
+			for (std::size_t i = 0; i < n; i++)
+			{
+				if (a.m_Limbs[i] == 0)
+				{
+					continue;
+				}
+				std::uint64_t carry = 0;
+				for (std::size_t j = 0; j < n; j++)
+				{
+					const std::uint64_t cur = static_cast<std::uint64_t>(a.m_Limbs[i]) * b.m_Limbs[j] + product[i + j] + carry;
+					product[i + j] = static_cast<std::uint32_t>(cur);
+					carry = cur >> 32;
+				}
+				product[i + n] = static_cast<std::uint32_t>(carry);
+			}
+
+			// Dropping the lowest `fraction_limbs` limbs brings the product back to fixed point.
+			HighPrecision result;
+			result.m_Limbs.assign(product.begin() + static_cast<std::ptrdiff_t>(fraction_limbs), product.begin() + static_cast<std::ptrdiff_t>(fraction_limbs + n));
+			if (negative)
+			{
+				result.Negate();
+			}
+			return result;
+		}
+
+		inline bool operator==(const HighPrecision& other) const
+		{
+			if (GetFractionLimbs() == other.GetFractionLimbs())
+			{
+				return m_Limbs == other.m_Limbs;
+			}
+			HighPrecision a = *this;
+			HighPrecision b = other;
+			const std::size_t fraction_limbs = std::max(GetFractionLimbs(), other.GetFractionLimbs());
+			a.SetFractionLimbs(fraction_limbs);
+			b.SetFractionLimbs(fraction_limbs);
+			return a.m_Limbs == b.m_Limbs;
+		}
+
+		inline bool operator!=(const HighPrecision& other) const
+		{
+			return !(*this == other);
+		}
+
+	private:
+		inline void Negate()
+		{
+			std::uint64_t carry = 1;
+			for (auto& limb : m_Limbs)
+			{
+				const std::uint64_t sum = static_cast<std::uint64_t>(~limb) + carry;
+				limb = static_cast<std::uint32_t>(sum);
+				carry = sum >> 32;
+			}
+		}
+
+		// Both helpers below assume a non-negative value.
+		inline void DivideMagnitude(std::uint32_t divisor)
+		{
+			std::uint64_t remainder = 0;
+			for (std::size_t i = m_Limbs.size(); i-- > 0;)
+			{
+				const std::uint64_t cur = (remainder << 32) | m_Limbs[i];
+				m_Limbs[i] = static_cast<std::uint32_t>(cur / divisor);
+				remainder = cur % divisor;
+			}
+		}
+
+		inline void MultiplyMagnitude(std::uint32_t factor)
+		{
+			std::uint64_t carry = 0;
+			for (auto& limb : m_Limbs)
+			{
+				const std::uint64_t cur = static_cast<std::uint64_t>(limb) * factor + carry;
+				limb = static_cast<std::uint32_t>(cur);
+				carry = cur >> 32;
+			}
+		}
+	};
+}
+
+#endif
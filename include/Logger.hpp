@@ -13,14 +13,23 @@ private:
 	inline static std::shared_ptr<spdlog::logger> s_Logger = nullptr;
 
 public:
-	inline static void Init(const std::string& loggerName)
+	// Console output goes to stderr with `useStderr`, leaving stdout to data streams.
+	inline static void Init(const std::string& loggerName, bool useStderr = false)
 	{
 		std::string logger_name = loggerName.empty() ? "LOGGER" : loggerName;
 
 		spdlog::sink_ptr file_sink = std::make_shared< spdlog::sinks::basic_file_sink_mt>(logger_name, false);
-		spdlog::sink_ptr stdout_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>(spdlog::color_mode::always);
-
-		spdlog::sinks_init_list sinks = { file_sink, stdout_sink };
+		spdlog::sink_ptr console_sink;
+		if (useStderr)
+		{
+			console_sink = std::make_shared<spdlog::sinks::stderr_color_sink_mt>(spdlog::color_mode::always);
+		}
+		else
+		{
+			console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>(spdlog::color_mode::always);
+		}
+
+		spdlog::sinks_init_list sinks = { file_sink, console_sink };
 
 		s_Logger = std::make_shared<spdlog::logger>(logger_name, sinks);
 		s_Logger->set_pattern("[%l] %n: %^%v%$");
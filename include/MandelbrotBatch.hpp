@@ -0,0 +1,55 @@
+#pragma once
+#ifndef MANDELBROT_MANDELBROTBATCH_HPP
+#define MANDELBROT_MANDELBROTBATCH_HPP
+
+#include "HighPrecision.hpp"
+#include "MandelbrotPalette.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace Mandelbrot
+{
+	// Headless rendering: images are rendered into memory and written to a file, without any
+	// window or OpenGL context, so renders also run on servers without a display.
+	namespace Batch
+	{
+		struct Settings
+		{
+			HighPrecision CenterX = HighPrecision(-0.7L);
+			HighPrecision CenterY = HighPrecision(0.0L);
+			// Plane units per pixel, like `SetZoom`.
+			long double Zoom = 0.004L;
+			std::size_t MaxIterations = 1000;
+			std::size_t Width = 1280;
+			std::size_t Height = 720;
+			// Every hardware thread when 0.
+			std::size_t Threads = 0;
+			Palette ColorPalette = Palette::Classic;
+			bool Smooth = false;
+			// Bytes the frame buffers of a render may take.
+			std::size_t MemoryBudget = std::size_t(1024) << 20;
+			// The format is picked from the extension: .png, .bmp, .tga, .jpg or .ppm.
+			// Only .ppm images are streamed, the others must fit in `MemoryBudget`.
+			std::string OutputPath;
+			// Statistics of the rendered frames are written there as JSON unless empty, see `Stats::ToJson`.
+			// Banded images write an array with one object per band.
+			std::string StatsPath;
+			// Timeline of the rendering is written there as a Chrome trace unless empty, see `WriteTrace`. Long
+			// renders only keep the last events of each thread.
+			std::string TracePath;
+		};
+
+		// Renders the image described by `settings` and writes it to `settings.OutputPath`.
+		// `Init` must have been called. Returns false if the image couldn't be rendered or written.
+		bool Render(const Settings& settings);
+
+		// Renders the image in horizontal bands as tall as `MemoryBudget` allows, each written to the
+		// .ppm file as soon as it is done, so the image size is only limited by the disk.
+		// Finished rows are recorded next to the image: an interrupted render started again with the
+		// same settings continues after the last finished band.
+		bool RenderBands(const Settings& settings);
+	}
+}
+
+#endif
@@ -10,6 +10,9 @@ namespace Mandelbrot
 	{
 		void InitGui();
 
+		// Lays the axes and the buttons out again for the current resolution. See `Mandelbrot::SetResolution`.
+		void ResizeGui();
+
 		void UpdateGui(sf::RenderWindow& window);
 
 		void DrawGui(sf::RenderWindow& window);
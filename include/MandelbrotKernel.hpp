@@ -0,0 +1,251 @@
+#pragma once
+#ifndef MANDELBROT_MANDELBROTKERNEL_HPP
+#define MANDELBROT_MANDELBROTKERNEL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Mandelbrot
+{
+	namespace Kernel
+	{
+		enum class InstructionSet
+		{
+			Scalar,
+			Sse2,
+			Avx2,
+			Avx512
+		};
+
+		// Orbit of a pixel which reached the iteration limit without escaping or being found periodic,
+		// so that its iteration can go on from there once the limit is raised.
+		struct ResumePoint
+		{
+			// Position of the pixel: in its segment for the kernels, in the frame once stored by the caller.
+			std::uint32_t Pixel;
+			// Index in the reference orbit. Only used by perturbation.
+			std::uint32_t Reference;
+			// z after `MaxIterations` iterations, or dz with perturbation. `float` values are exact in `double`.
+			double Zr;
+			double Zi;
+		};
+
+		// A run of pixels along a row, or along a column when `Vertical` is set.
+		// The varying coordinate of the i-th pixel is `(FirstPixel + i) * Scale + Origin`,
+		// which is the same formula used by `ScaleToPlane`. The other one is `Fixed`.
+		// Rows vary the real part and columns the imaginary part.
+		template<typename T>
+		struct RowSegment
+		{
+			T Origin;
+			T Scale;
+			T FirstPixel;
+			T Fixed;
+			bool Vertical;
+			std::size_t Count;
+			std::size_t MaxIterations;
+			// Orbits coming back this close to a previous value are considered periodic, and so interior.
+			// Zero or less disables the periodicity check.
+			T PeriodTolerance;
+			// Output: one iteration count per pixel. Must hold at least `Count` elements.
+			std::uint32_t* Iterations;
+			// Optional output: one continuous iteration count per pixel, see `GetSmoothIterations`.
+			// Not written when null. Pixels reaching the limit get `MaxIterations`.
+			float* Smooth;
+			// Optional output: pixels reaching `MaxIterations` without being found periodic are appended. Unused when null.
+			std::vector<ResumePoint>* Resume;
+		};
+
+		// Points which all reached `StartIteration` without escaping, iterated on up to `MaxIterations`.
+		// Outputs are the same as the ones of `RowSegment`, indexed like `Points`.
+		template<typename T>
+		struct ResumeSegment
+		{
+			// c of every point, computed like the one of its pixel in a `RowSegment`.
+			const T* Cr;
+			const T* Ci;
+			const ResumePoint* Points;
+			std::size_t Count;
+			std::size_t StartIteration;
+			std::size_t MaxIterations;
+			T PeriodTolerance;
+			std::uint32_t* Iterations;
+			float* Smooth;
+			std::vector<ResumePoint>* Resume;
+		};
+
+		// Colours of a run of pixels, looked up from their iteration counts.
+		struct ColorSegment
+		{
+			// Colour of every count in `[0, MaxIterations]`, plus the entry right after, which
+			// smooth colouring blends towards. Must hold `MaxIterations + 2` entries. See `PackColor`.
+			const std::uint32_t* Table;
+			std::uint32_t MaxIterations;
+			// Colour of the pixels reaching `MaxIterations`.
+			std::uint32_t Interior;
+			std::size_t Count;
+			const std::uint32_t* Iterations;
+			// Optional input: continuous iteration counts. When set, every escaping pixel blends
+			// the two entries around its count instead of taking the entry of its whole count.
+			const float* Smooth;
+			// Output: RGBA bytes, 4 per pixel.
+			std::uint8_t* Colors;
+		};
+
+		struct RowStatistics
+		{
+			// Pixels found inside the main cardioid or the period-2 bulb without iterating.
+			std::size_t InteriorRejected = 0;
+			// Pixels whose orbit was found periodic before reaching `MaxIterations`.
+			std::size_t PeriodicExits = 0;
+			// Iterations actually run, summed over the pixels: rejected pixels run none, periodic ones stop early.
+			std::size_t Iterations = 0;
+		};
+
+		// Brent's cycle detection compares z against a value saved at powers of two,
+		// so any period is found within twice its length once the orbit has settled.
+		static constexpr std::size_t PeriodCheckFirstWindow = 8;
+
+		// The helpers below, up to `IsInMainCardioidOrBulb`, are `static`: the SIMD translation units are
+		// compiled with different target flags, and each keeps a copy of its own.
+
+		// Colour of one pixel of a `ColorSegment`. Every instruction set gives the same result.
+		static inline std::uint32_t GetTableColor(const ColorSegment& segment, std::uint32_t iterations, float smooth)
+		{
+			if (iterations >= segment.MaxIterations)
+			{
+				return segment.Interior;
+			}
+			if (!segment.Smooth)
+			{
+				return segment.Table[iterations];
+			}
+
+			// Far from the set, the first iterations can push the continuous count below zero.
+			const float position = smooth > 0.0f ? smooth : 0.0f;
+			std::uint32_t index = static_cast<std::uint32_t>(position);
+			index = index < segment.MaxIterations ? index : segment.MaxIterations;
+			const float weight = position - static_cast<float>(index);
+
+			const std::uint32_t low = segment.Table[index];
+			const std::uint32_t high = segment.Table[index + 1];
+			std::uint32_t color = 0;
+			for (unsigned int shift = 0; shift < 32; shift += 8)
+			{
+				const float a = static_cast<float>((low >> shift) & 0xFFu);
+				const float b = static_cast<float>((high >> shift) & 0xFFu);
+				color |= static_cast<std::uint32_t>(a + (b - a) * weight + 0.5f) << shift;
+			}
+			return color;
+		}
+
+		// Periodicity tolerance for pixels `scale` apart: far below a pixel, but never under
+		// a few ulps, as rounding keeps converged orbits wandering around the exact cycle.
+		// Without `std::max`, which would be shared between the translation units.
+		template<typename T>
+		static inline T GetPeriodTolerance(T scale)
+		{
+			const T tolerance = scale * static_cast<T>(1.0 / 1048576.0);
+			const T minimum = std::numeric_limits<T>::epsilon() * static_cast<T>(4.0);
+			return tolerance > minimum ? tolerance : minimum;
+		}
+
+		// Iterates `period` steps from z and returns whether the derivative along them is below one.
+		// Only an attracting cycle proves c interior: orbits also linger near repelling cycles
+		// (around Misiurewicz points such as c = i) and escape much later.
+		template<typename T>
+		static inline bool IsAttractingCycle(T zr, T zi, T cr, T ci, std::size_t period)
+		{
+			T dr = static_cast<T>(1.0);
+			T di = static_cast<T>(0.0);
+			for (std::size_t k = 0; k < period; k++)
+			{
+				// d' = 2 * z * d
+				const T new_dr = static_cast<T>(2.0) * (zr * dr - zi * di);
+				const T new_di = static_cast<T>(2.0) * (zr * di + zi * dr);
+				dr = new_dr;
+				di = new_di;
+
+				const T r2 = zr * zr;
+				const T i2 = zi * zi;
+				zi = static_cast<T>(2.0) * zr * zi + ci;
+				zr = r2 - i2 + cr;
+			}
+			// Overflowing derivatives end up infinite or NaN, and fail the test as they should.
+			return dr * dr + di * di < static_cast<T>(1.0);
+		}
+
+		// Continuous iteration count of a pixel which escaped after `iterations` iterations, with
+		// |z|^2 = `norm2` at that point: n + 1 - log2(log2(|z|)). It stays within one of the count
+		// and, unlike it, varies continuously across the escape bands.
+		static inline float GetSmoothIterations(std::uint32_t iterations, double norm2)
+		{
+			return static_cast<float>(static_cast<double>(iterations) + 1.0 - std::log2(0.5 * std::log2(norm2)));
+		}
+
+		// Closed form membership test for the two largest components of the set.
+		// Points passing it never escape, so they can skip the iteration loop entirely.
+		template<typename T>
+		static inline bool IsInMainCardioidOrBulb(T cr, T ci)
+		{
+			const T ci2 = ci * ci;
+
+			// Main cardioid: q * (q + (x - 1/4)) <= y^2 / 4, with q = (x - 1/4)^2 + y^2
+			const T xq = cr - static_cast<T>(0.25);
+			const T q = xq * xq + ci2;
+			if (q * (q + xq) <= static_cast<T>(0.25) * ci2)
+			{
+				return true;
+			}
+
+			// Period-2 bulb: (x + 1)^2 + y^2 <= 1/16
+			const T xb = cr + static_cast<T>(1.0);
+			return xb * xb + ci2 <= static_cast<T>(0.0625);
+		}
+
+		// Computes the iterations of every pixel of the segment using the active instruction set.
+		RowStatistics ComputeRow(const RowSegment<float>& segment);
+		RowStatistics ComputeRow(const RowSegment<double>& segment);
+		// `long double` has no vector registers, so this one is always scalar.
+		RowStatistics ComputeRow(const RowSegment<long double>& segment);
+
+		// Continues the iteration of points stopped by a lower limit, using the active instruction set.
+		// The results are the same as computing the points from scratch with the new limit.
+		RowStatistics ContinuePoints(const ResumeSegment<float>& segment);
+		RowStatistics ContinuePoints(const ResumeSegment<double>& segment);
+
+		// Appends `count` points to `resume`. Defined out of line, so that the SIMD translation units
+		// never instantiate `std::vector` code with their target flags.
+		void AppendResumePoints(std::vector<ResumePoint>& resume, const ResumePoint* points, std::size_t count);
+
+		struct ColorStatistics
+		{
+			// Iteration counts of the segment, summed.
+			std::uint64_t Iterations = 0;
+			// Pixels below `MaxIterations`.
+			std::size_t Escaped = 0;
+		};
+
+		// Colours every pixel of the segment, using gathers from the table where the instruction set has them.
+		// The counts are taken from the iterations loaded for the colours, so they come almost for free.
+		ColorStatistics ColorizeRow(const ColorSegment& segment);
+
+		// Returns the best instruction set supported by the running CPU.
+		InstructionSet DetectInstructionSet();
+
+		// Forces a specific instruction set. It is clamped to what the CPU supports.
+		void SetInstructionSet(InstructionSet set);
+		InstructionSet GetInstructionSet();
+
+		const char* GetInstructionSetName(InstructionSet set);
+
+		// Number of pixels iterated together by the active instruction set.
+		std::size_t GetLaneCount(bool single_precision);
+	}
+}
+
+#endif
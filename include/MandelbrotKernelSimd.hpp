@@ -0,0 +1,298 @@
+#pragma once
+#ifndef MANDELBROT_MANDELBROTKERNELSIMD_HPP
+#define MANDELBROT_MANDELBROTKERNELSIMD_HPP
+
+#include "MandelbrotKernel.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Generic escape-time loop shared by every SIMD kernel.
+// This header must only be included by the per-instruction-set translation units
+// (MandelbrotKernelSse2.cpp, MandelbrotKernelAvx2.cpp, ...) as it gets compiled
+// with different target flags in each of them.
+//
+// `Ops` wraps the intrinsics of one instruction set and one scalar type:
+//   Scalar, Vec, Lanes
+//   Set1(s), Ramp()          -> broadcast and {0, 1, 2, ...}
+//   Add(a, b), Sub(a, b), Mul(a, b)
+//   Load(in), Store(out, v)  -> unaligned load and store of every lane
+//   GreaterBits(a, b)        -> bitmask of lanes where a > b
+//   LessEqualBits(a, b)      -> bitmask of lanes where a <= b
+
+namespace Mandelbrot
+{
+	namespace Kernel
+	{
+		// `static` on purpose: every instruction set gets its own copy.
+		static inline unsigned int CountTrailingZeros(unsigned int value)
+		{
+#if defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward(&index, value);
+			return static_cast<unsigned int>(index);
+#else
+			return static_cast<unsigned int>(__builtin_ctz(value));
+#endif
+		}
+
+		static inline unsigned int PopCount(unsigned int value)
+		{
+			unsigned int count = 0;
+			for (; value; value &= value - 1u)
+			{
+				count++;
+			}
+			return count;
+		}
+
+		// Vectorized `IsInMainCardioidOrBulb`: bitmask of the lanes inside either component.
+		template<typename Ops>
+		inline unsigned int MainCardioidOrBulbBits(typename Ops::Vec cr, typename Ops::Vec ci)
+		{
+			using Scalar = typename Ops::Scalar;
+
+			const auto ci2 = Ops::Mul(ci, ci);
+
+			const auto xq = Ops::Sub(cr, Ops::Set1(static_cast<Scalar>(0.25)));
+			const auto q = Ops::Add(Ops::Mul(xq, xq), ci2);
+			const unsigned int cardioid = Ops::LessEqualBits(Ops::Mul(q, Ops::Add(q, xq)), Ops::Mul(Ops::Set1(static_cast<Scalar>(0.25)), ci2));
+
+			const auto xb = Ops::Add(cr, Ops::Set1(static_cast<Scalar>(1.0)));
+			const unsigned int bulb = Ops::LessEqualBits(Ops::Add(Ops::Mul(xb, xb), ci2), Ops::Set1(static_cast<Scalar>(0.0625)));
+
+			return cardioid | bulb;
+		}
+
+		// Lanes reaching the iteration limit, or found to be interior early, get `MaxIterations`.
+		static inline void StoreBounded(std::uint32_t* out, float* smooth, unsigned int lanes, std::uint32_t max_iterations)
+		{
+			while (lanes)
+			{
+				const unsigned int lane = CountTrailingZeros(lanes);
+				out[lane] = max_iterations;
+				if (smooth)
+				{
+					smooth[lane] = static_cast<float>(max_iterations);
+				}
+				lanes &= lanes - 1u;
+			}
+		}
+
+		// Iterates the `active` lanes from `first_iteration` up to `max_iterations`, starting from z.
+		// Counts are stored in `out` and `smooth` (when not null). Lanes reaching the limit without
+		// being found periodic are appended to `resume` (when not null) as pixel `first_pixel + lane`.
+		template<typename Ops>
+		inline void IterateLanes(typename Ops::Vec cr, typename Ops::Vec ci, typename Ops::Vec zr, typename Ops::Vec zi, unsigned int active,
+			std::uint32_t first_iteration, std::uint32_t max_iterations, typename Ops::Scalar period_tolerance,
+			std::uint32_t* out, float* smooth, std::vector<ResumePoint>* resume, std::size_t first_pixel, RowStatistics& statistics)
+		{
+			using Vec = typename Ops::Vec;
+			using Scalar = typename Ops::Scalar;
+
+			const Vec four = Ops::Set1(static_cast<Scalar>(4.0));
+			const bool check_period = period_tolerance > static_cast<Scalar>(0.0);
+			const Vec tolerance2 = Ops::Set1(period_tolerance * period_tolerance);
+
+			// Every lane starts together, so they share the Brent window.
+			Vec saved_r = zr;
+			Vec saved_i = zi;
+			std::size_t window = PeriodCheckFirstWindow;
+			std::size_t steps = 0;
+
+			for (std::uint32_t iter = first_iteration; iter < max_iterations; iter++)
+			{
+				const Vec r2 = Ops::Mul(zr, zr);
+				const Vec i2 = Ops::Mul(zi, zi);
+
+				// Lanes escaping at this iteration record it and get masked out.
+				const Vec norm2 = Ops::Add(r2, i2);
+				unsigned int escaped = Ops::GreaterBits(norm2, four) & active;
+				if (escaped)
+				{
+					active &= ~escaped;
+					statistics.Iterations += static_cast<std::size_t>(iter - first_iteration) * PopCount(escaped);
+
+					Scalar lanes_norm2[Ops::Lanes];
+					if (smooth)
+					{
+						Ops::Store(lanes_norm2, norm2);
+					}
+					while (escaped)
+					{
+						const unsigned int lane = CountTrailingZeros(escaped);
+						out[lane] = iter;
+						if (smooth)
+						{
+							smooth[lane] = GetSmoothIterations(iter, static_cast<double>(lanes_norm2[lane]));
+						}
+						escaped &= escaped - 1u;
+					}
+					if (!active)
+					{
+						return;
+					}
+				}
+
+				zi = Ops::Add(Ops::Mul(Ops::Add(zr, zr), zi), ci);
+				zr = Ops::Add(Ops::Sub(r2, i2), cr);
+
+				if (check_period)
+				{
+					steps++;
+					const Vec dr = Ops::Sub(zr, saved_r);
+					const Vec di = Ops::Sub(zi, saved_i);
+					unsigned int close = Ops::LessEqualBits(Ops::Add(Ops::Mul(dr, dr), Ops::Mul(di, di)), tolerance2) & active;
+
+					// Candidates are rare, so they get confirmed one lane at a time.
+					unsigned int periodic = 0;
+					if (close)
+					{
+						Scalar lanes_zr[Ops::Lanes];
+						Scalar lanes_zi[Ops::Lanes];
+						Scalar lanes_cr[Ops::Lanes];
+						Scalar lanes_ci[Ops::Lanes];
+						Ops::Store(lanes_zr, zr);
+						Ops::Store(lanes_zi, zi);
+						Ops::Store(lanes_cr, cr);
+						Ops::Store(lanes_ci, ci);
+						while (close)
+						{
+							const unsigned int lane = CountTrailingZeros(close);
+							if (IsAttractingCycle(lanes_zr[lane], lanes_zi[lane], lanes_cr[lane], lanes_ci[lane], steps))
+							{
+								periodic |= 1u << lane;
+							}
+							close &= close - 1u;
+						}
+					}
+					if (periodic)
+					{
+						StoreBounded(out, smooth, periodic, max_iterations);
+						statistics.PeriodicExits += static_cast<std::size_t>(PopCount(periodic));
+						statistics.Iterations += static_cast<std::size_t>(iter + 1 - first_iteration) * PopCount(periodic);
+						active &= ~periodic;
+						if (!active)
+						{
+							return;
+						}
+					}
+					if (steps == window)
+					{
+						saved_r = zr;
+						saved_i = zi;
+						steps = 0;
+						window *= 2;
+					}
+				}
+			}
+
+			// Lanes still active reached the iteration limit.
+			StoreBounded(out, smooth, active, max_iterations);
+			statistics.Iterations += static_cast<std::size_t>(max_iterations - first_iteration) * PopCount(active);
+			if (resume)
+			{
+				Scalar lanes_zr[Ops::Lanes];
+				Scalar lanes_zi[Ops::Lanes];
+				Ops::Store(lanes_zr, zr);
+				Ops::Store(lanes_zi, zi);
+				ResumePoint points[Ops::Lanes];
+				std::size_t count = 0;
+				for (; active; active &= active - 1u)
+				{
+					const unsigned int lane = CountTrailingZeros(active);
+					points[count++] = { static_cast<std::uint32_t>(first_pixel + lane), 0, static_cast<double>(lanes_zr[lane]), static_cast<double>(lanes_zi[lane]) };
+				}
+				AppendResumePoints(*resume, points, count);
+			}
+		}
+
+		template<typename Ops>
+		inline RowStatistics ComputeRowSimd(const RowSegment<typename Ops::Scalar>& segment)
+		{
+			RowStatistics statistics;
+
+			using Vec = typename Ops::Vec;
+			using Scalar = typename Ops::Scalar;
+
+			constexpr unsigned int all_lanes = (Ops::Lanes >= 32) ? ~0u : ((1u << Ops::Lanes) - 1u);
+
+			const Vec scale = Ops::Set1(segment.Scale);
+			const Vec origin = Ops::Set1(segment.Origin);
+			const Vec fixed = Ops::Set1(segment.Fixed);
+			const Vec ramp = Ops::Ramp();
+
+			const std::uint32_t max_iterations = static_cast<std::uint32_t>(segment.MaxIterations);
+
+			for (std::size_t base = 0; base < segment.Count; base += Ops::Lanes)
+			{
+				const std::size_t remaining = segment.Count - base;
+				unsigned int active = remaining >= Ops::Lanes ? all_lanes : ((1u << remaining) - 1u);
+
+				// Same formula as `ScaleToPlane`: (pixel - half_width) * zoom + offset.
+				const Vec pixel = Ops::Add(Ops::Set1(segment.FirstPixel + static_cast<Scalar>(base)), ramp);
+				const Vec along = Ops::Add(Ops::Mul(pixel, scale), origin);
+				const Vec cr = segment.Vertical ? fixed : along;
+				const Vec ci = segment.Vertical ? along : fixed;
+
+				std::uint32_t* out = segment.Iterations + base;
+				float* smooth = segment.Smooth ? segment.Smooth + base : nullptr;
+
+				const unsigned int interior = MainCardioidOrBulbBits<Ops>(cr, ci) & active;
+				if (interior)
+				{
+					StoreBounded(out, smooth, interior, max_iterations);
+					statistics.InteriorRejected += static_cast<std::size_t>(PopCount(interior));
+					active &= ~interior;
+					if (!active)
+					{
+						continue;
+					}
+				}
+
+				IterateLanes<Ops>(cr, ci, cr, ci, active, 0, max_iterations, segment.PeriodTolerance, out, smooth, segment.Resume, base, statistics);
+			}
+
+			return statistics;
+		}
+
+		template<typename Ops>
+		inline RowStatistics ContinuePointsSimd(const ResumeSegment<typename Ops::Scalar>& segment)
+		{
+			RowStatistics statistics;
+
+			using Scalar = typename Ops::Scalar;
+
+			constexpr unsigned int all_lanes = (Ops::Lanes >= 32) ? ~0u : ((1u << Ops::Lanes) - 1u);
+
+			for (std::size_t base = 0; base < segment.Count; base += Ops::Lanes)
+			{
+				const std::size_t remaining = segment.Count - base;
+				const std::size_t lanes = remaining < Ops::Lanes ? remaining : Ops::Lanes;
+				const unsigned int active = remaining >= Ops::Lanes ? all_lanes : ((1u << remaining) - 1u);
+
+				// Missing lanes of the last vector start at 0, which never escapes, and are masked out anyway.
+				Scalar lanes_cr[Ops::Lanes] = {};
+				Scalar lanes_ci[Ops::Lanes] = {};
+				Scalar lanes_zr[Ops::Lanes] = {};
+				Scalar lanes_zi[Ops::Lanes] = {};
+				for (std::size_t lane = 0; lane < lanes; lane++)
+				{
+					lanes_cr[lane] = segment.Cr[base + lane];
+					lanes_ci[lane] = segment.Ci[base + lane];
+					lanes_zr[lane] = static_cast<Scalar>(segment.Points[base + lane].Zr);
+					lanes_zi[lane] = static_cast<Scalar>(segment.Points[base + lane].Zi);
+				}
+
+				IterateLanes<Ops>(Ops::Load(lanes_cr), Ops::Load(lanes_ci), Ops::Load(lanes_zr), Ops::Load(lanes_zi), active,
+					static_cast<std::uint32_t>(segment.StartIteration), static_cast<std::uint32_t>(segment.MaxIterations), segment.PeriodTolerance,
+					segment.Iterations + base, segment.Smooth ? segment.Smooth + base : nullptr, segment.Resume, base, statistics);
+			}
+
+			return statistics;
+		}
+	}
+}
+
+#endif
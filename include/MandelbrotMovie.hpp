@@ -0,0 +1,57 @@
+#pragma once
+#ifndef MANDELBROT_MANDELBROTMOVIE_HPP
+#define MANDELBROT_MANDELBROTMOVIE_HPP
+
+#include "HighPrecision.hpp"
+#include "MandelbrotPalette.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace Mandelbrot
+{
+	// Zoom movies into a fixed center, rendered from an exponential map instead of frame by frame.
+	//
+	// The map samples the plane at center + e^(r + i * theta): its columns go around the center and
+	// its rows go down in log radius by as much as the columns turn, so every sample is square. One
+	// octave of rows, where the radius halves, is computed at a time and every frame is resampled from
+	// the octaves it covers. The samples of a frame are shared with every frame zoomed less than an
+	// octave away, so each point of the path is only iterated once.
+	namespace Movie
+	{
+		struct Settings
+		{
+			HighPrecision CenterX = HighPrecision(-0.7L);
+			HighPrecision CenterY = HighPrecision(0.0L);
+			// Plane units per pixel of the first and the last frame, like `SetZoom`.
+			long double StartZoom = 0.004L;
+			long double EndZoom = 4e-9L;
+			// Frames between two zooms by a factor of two.
+			std::size_t FramesPerOctave = 60;
+			// Frame rate written to the stream header.
+			std::size_t FrameRate = 30;
+			std::size_t MaxIterations = 1000;
+			std::size_t Width = 1280;
+			std::size_t Height = 720;
+			// Every hardware thread when 0.
+			std::size_t Threads = 0;
+			Palette ColorPalette = Palette::Classic;
+			bool Smooth = false;
+			// YUV4MPEG2 stream of 4:4:4 frames, written to the standard output when "-".
+			std::string OutputPath = "-";
+			// Statistics of the frames are written there as a JSON array unless empty, see `Stats::ToJson`.
+			// Octaves count towards the frame they are computed for, and frames have no tiles.
+			std::string StatsPath;
+			// Timeline of the movie is written there as a Chrome trace unless empty. Long movies only keep
+			// the last events of each thread.
+			std::string TracePath;
+		};
+
+		// Renders the frames from `StartZoom` to `EndZoom` and streams them as they are done, so an encoder
+		// reading the standard output never needs temporary files. Logs must not go to the standard output then.
+		// Returns false if the movie couldn't be rendered or written.
+		bool Render(const Settings& settings);
+	}
+}
+
+#endif
@@ -0,0 +1,121 @@
+#pragma once
+#ifndef MANDELBROT_MANDELBROTPALETTE_HPP
+#define MANDELBROT_MANDELBROTPALETTE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Mandelbrot
+{
+	// Colours given to the escape time of the pixels. Interior pixels are always black.
+	enum class Palette
+	{
+		Classic,
+		Grayscale
+	};
+
+	// Colours are RGBA bytes in memory order, the layout of `sf::Color`, read as a little-endian `std::uint32_t`.
+	constexpr std::uint32_t PackColor(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a = 255)
+	{
+		return static_cast<std::uint32_t>(r) | static_cast<std::uint32_t>(g) << 8 | static_cast<std::uint32_t>(b) << 16 | static_cast<std::uint32_t>(a) << 24;
+	}
+
+	// Palettes are generated at compile time into flat tables, so colouring a pixel is a single load.
+	namespace Palettes
+	{
+		// Entries before a palette starts repeating.
+		static constexpr std::size_t FirstEntries = 16;
+		// Past `FirstEntries`, every palette repeats with this period.
+		static constexpr std::size_t Period = 256;
+		static constexpr std::size_t TableSize = FirstEntries + Period;
+
+		static constexpr std::uint32_t InteriorColor = PackColor(0, 0, 0);
+
+		// Colour of the `index`-th entry of `palette`, from its formula. Channels wrap around like `std::uint8_t` arithmetic.
+		constexpr std::uint32_t ComputeEntry(Palette palette, std::size_t index)
+		{
+			if (palette == Palette::Grayscale)
+			{
+				// Bands of 32 entries, from black to white and back.
+				const std::size_t level = (index * 8) % 512;
+				const std::uint8_t value = static_cast<std::uint8_t>(level < 256 ? level : 511 - level);
+				return PackColor(value, value, value);
+			}
+
+			if (index == 0)
+			{
+				return PackColor(255, 0, 0);
+			}
+			// colour gradient:      Red -> Blue -> Green -> Red -> Black
+			// corresponding values:  0  ->  16  ->  32   -> 64  ->  127 (or -1)
+			const int entry = static_cast<std::uint8_t>(index);
+			if (index < 16)
+			{
+				return PackColor(static_cast<std::uint8_t>(16 * (16 - entry)), 0, static_cast<std::uint8_t>(16 * entry - 1));
+			}
+			if (entry < 32)
+			{
+				return PackColor(0, static_cast<std::uint8_t>(16 * (entry - 16)), static_cast<std::uint8_t>(16 * (32 - entry) - 1));
+			}
+			if (entry < 64)
+			{
+				return PackColor(static_cast<std::uint8_t>(8 * (entry - 32)), static_cast<std::uint8_t>(8 * (64 - entry) - 1), 0);
+			}
+			// range is 64 - 127
+			return PackColor(static_cast<std::uint8_t>(255 - (entry - 64) * 4), 0, 0);
+		}
+
+		constexpr std::array<std::uint32_t, TableSize> MakeTable(Palette palette)
+		{
+			std::array<std::uint32_t, TableSize> table{};
+			for (std::size_t i = 0; i < TableSize; i++)
+			{
+				table[i] = ComputeEntry(palette, i);
+			}
+			return table;
+		}
+
+		static constexpr std::array<std::uint32_t, TableSize> ClassicTable = MakeTable(Palette::Classic);
+		static constexpr std::array<std::uint32_t, TableSize> GrayscaleTable = MakeTable(Palette::Grayscale);
+
+		constexpr const std::array<std::uint32_t, TableSize>& GetTable(Palette palette)
+		{
+			return palette == Palette::Grayscale ? GrayscaleTable : ClassicTable;
+		}
+
+		// Colour of the `index`-th entry of `palette`, for any index.
+		constexpr std::uint32_t GetEntry(Palette palette, std::size_t index)
+		{
+			const std::array<std::uint32_t, TableSize>& table = GetTable(palette);
+			return index < TableSize ? table[index] : table[FirstEntries + (index - FirstEntries) % Period];
+		}
+
+		// Entries of the first gradient of `palette`, from its first colour to its last one before it
+		// turns back. Histogram colouring spreads the escape times over these.
+		constexpr std::size_t GetGradientLength(Palette palette)
+		{
+			return palette == Palette::Grayscale ? 32 : 128;
+		}
+
+		// Colour at `position` between the entries of `palette`, blended like smooth colouring does.
+		constexpr std::uint32_t GetBlendedEntry(Palette palette, double position)
+		{
+			const std::size_t index = static_cast<std::size_t>(position);
+			const double weight = position - static_cast<double>(index);
+			const std::uint32_t first = GetEntry(palette, index);
+			const std::uint32_t second = GetEntry(palette, index + 1);
+
+			std::uint32_t color = 0;
+			for (int shift = 0; shift < 32; shift += 8)
+			{
+				const double a = static_cast<double>((first >> shift) & 0xFF);
+				const double b = static_cast<double>((second >> shift) & 0xFF);
+				color |= static_cast<std::uint32_t>(a + (b - a) * weight + 0.5) << shift;
+			}
+			return color;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,114 @@
+#pragma once
+#ifndef MANDELBROT_MANDELBROTPERTURBATION_HPP
+#define MANDELBROT_MANDELBROTPERTURBATION_HPP
+
+#include "HighPrecision.hpp"
+#include "MandelbrotKernel.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Mandelbrot
+{
+	namespace Perturbation
+	{
+		// Orbit of a reference point computed at arbitrary precision and stored in `double`.
+		// `Real[0]` and `Imag[0]` are Z_0 = 0, so the orbit holds Z_0 ... Z_Length.
+		struct ReferenceOrbit
+		{
+			HighPrecision CenterX;
+			HighPrecision CenterY;
+			std::size_t MaxIterations = 0;
+
+			std::vector<double> Real;
+			std::vector<double> Imag;
+
+			// Index of the last element: the iteration where the reference escaped, or `MaxIterations`.
+			std::size_t Length = 0;
+		};
+
+		// Bivariate linear approximation of `Length` perturbation steps starting at some index m:
+		// dz_{m+Length} = A * dz_m + B * dc, valid as long as |dz_m| < Radius.
+		struct BlaStep
+		{
+			double Ar, Ai;
+			double Br, Bi;
+			double Radius;
+			std::size_t Length;
+		};
+
+		// Binary tree of BLA steps built over a reference orbit.
+		// `Levels[k][j]` covers 2^k steps starting at orbit index 1 + j * 2^k.
+		struct BlaTable
+		{
+			// Largest |dc| the table was built for, i.e. the distance from the reference to the farthest pixel.
+			double MaxDeltaC = 0.0;
+			std::vector<std::vector<BlaStep>> Levels;
+		};
+
+		struct RowStatistics
+		{
+			// Times a pixel had to be rebased onto the start of the orbit.
+			std::size_t Rebases = 0;
+			// Iterations covered by BLA steps instead of being iterated one by one.
+			std::size_t SkippedIterations = 0;
+			// Iterations iterated one by one, summed over the pixels.
+			std::size_t Iterations = 0;
+		};
+
+		// A run of pixels expressed as offsets from the reference point, along a row or a column.
+		// The varying offset of the i-th pixel is `(FirstPixel + i) * Scale`, the other one is `DeltaFixed`.
+		// Rows vary the real part and columns the imaginary part.
+		struct DeltaRowSegment
+		{
+			double FirstPixel;
+			double Scale;
+			double DeltaFixed;
+			bool Vertical;
+			std::size_t Count;
+			std::size_t MaxIterations;
+			// Output: one iteration count per pixel. Must hold at least `Count` elements.
+			std::uint32_t* Iterations;
+			// Optional output: continuous iteration counts, as in `Kernel::RowSegment`. Not written when null.
+			float* Smooth;
+			// Optional output: pixels reaching `MaxIterations` are appended with their dz and orbit index. Unused when null.
+			std::vector<Kernel::ResumePoint>* Resume;
+		};
+
+		// Points which all reached `StartIteration` without escaping, iterated on up to `MaxIterations`.
+		// Outputs are the same as the ones of `DeltaRowSegment`, indexed like `Points`.
+		struct DeltaResumeSegment
+		{
+			// dc of every point, computed like the one of its pixel in a `DeltaRowSegment`.
+			const double* DeltaCr;
+			const double* DeltaCi;
+			const Kernel::ResumePoint* Points;
+			std::size_t Count;
+			std::size_t StartIteration;
+			std::size_t MaxIterations;
+			std::uint32_t* Iterations;
+			float* Smooth;
+			std::vector<Kernel::ResumePoint>* Resume;
+		};
+
+		// Iterates Z_{n+1} = Z_n^2 + C at the precision of the center coordinates.
+		void ComputeReferenceOrbit(const HighPrecision& center_x, const HighPrecision& center_y, std::size_t max_iterations, ReferenceOrbit& orbit);
+
+		// Builds the BLA table of `orbit` for pixels at most `max_delta_c` away from the reference.
+		// The validity radii keep the neglected terms below `double` rounding, so skipping
+		// iterations does not change the image.
+		void BuildBlaTable(const ReferenceOrbit& orbit, double max_delta_c, BlaTable& table);
+
+		// Iterates every pixel of the segment as a `double` delta from the reference orbit.
+		// When `bla` is not null, iterations are skipped wherever one of its steps is valid.
+		RowStatistics ComputeRow(const ReferenceOrbit& orbit, const BlaTable* bla, const DeltaRowSegment& segment);
+
+		// Continues the iteration of points stopped by a lower limit. `orbit` must have the same
+		// center as the one the points were saved with. BLA steps are chosen for the new limit,
+		// so the results match a full computation within the tolerance of the approximation.
+		RowStatistics ContinuePoints(const ReferenceOrbit& orbit, const BlaTable* bla, const DeltaResumeSegment& segment);
+	}
+}
+
+#endif
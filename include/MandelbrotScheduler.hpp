@@ -0,0 +1,62 @@
+#pragma once
+#ifndef MANDELBROT_MANDELBROTSCHEDULER_HPP
+#define MANDELBROT_MANDELBROTSCHEDULER_HPP
+
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Mandelbrot
+{
+	// Work-stealing tile scheduler. The frame is cut into small tiles which are dealt to
+	// per-worker deques. Workers take tiles from the front of their own deque and, once it is
+	// empty, steal from the back of the others, so the expensive tiles near the boundary of
+	// the set never leave a core idle while another one still has a queue.
+	namespace Scheduler
+	{
+		// Pixels `[MinX, MaxX)` x `[MinY, MaxY)`.
+		struct Tile
+		{
+			std::size_t MinX;
+			std::size_t MinY;
+			std::size_t MaxX;
+			std::size_t MaxY;
+		};
+
+		static constexpr std::size_t CacheLineSize = 64;
+
+		// Vertical tile edges fall on multiples of this many pixels, so with 4 bytes per pixel
+		// (iterations, colours) two tiles never write to the same cache line of a row.
+		static constexpr std::size_t TileAlignment = CacheLineSize / sizeof(std::uint32_t);
+
+		static constexpr std::size_t DefaultTileWidth = 64;
+		static constexpr std::size_t DefaultTileHeight = 32;
+
+		// Cuts a `width` x `height` frame into tiles covering every pixel exactly once.
+		// `tile_width` is rounded up to a multiple of `TileAlignment`, the last row and column of tiles are clipped.
+		std::vector<Tile> MakeTiles(std::size_t width, std::size_t height, std::size_t tile_width = DefaultTileWidth, std::size_t tile_height = DefaultTileHeight);
+
+		// Processes one tile. `worker` is in `[0, workers)` and unique among the running calls.
+		using TileFunction = std::function<void(const Tile& tile, std::size_t worker)>;
+
+		struct RunStatistics
+		{
+			// Tiles processed by another worker than the one they were dealt to.
+			std::size_t Steals = 0;
+			// Time each worker spent processing tiles.
+			std::vector<std::chrono::nanoseconds> WorkerBusy;
+		};
+
+		// Calls `process` once for every tile, spread over `workers` workers: the calling thread and
+		// threads of `pool`. Returns once every tile is done.
+		// Once `cancel` is set, workers stop taking tiles and the remaining ones are skipped.
+		RunStatistics Run(ThreadPool& pool, const std::vector<Tile>& tiles, std::size_t workers, const TileFunction& process, const std::atomic<bool>* cancel = nullptr);
+	}
+}
+
+#endif
@@ -0,0 +1,133 @@
+#pragma once
+#ifndef MANDELBROT_MANDELBROTSTATS_HPP
+#define MANDELBROT_MANDELBROTSTATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Mandelbrot
+{
+	// See `MandelbrotUtils.hpp`.
+	enum class Precision;
+
+	// Instrumentation of the rendered frames. Every frame records where its time went, how many iterations
+	// each tile took and how busy each worker was, read back with `GetLastFrameStats`.
+	namespace Stats
+	{
+		enum class Phase
+		{
+			// Everything but the phases below: iterating the pixels, reference orbits, cache lookups.
+			Compute,
+			// Turning iterations into colours, histogram included.
+			Colorize,
+			// Copying the colours to the vertex array or the image of the draw function.
+			Publish,
+			// Uploading the published frame to the GPU, on the drawing thread.
+			Upload,
+			// Submitting the draw call, on the drawing thread. The GPU may still be busy with it afterwards.
+			Draw
+		};
+
+		static constexpr std::size_t PhaseCount = 5;
+
+		const char* GetPhaseName(Phase phase);
+
+		// Adds the time from its construction to its destruction to `total`.
+		class ScopedTimer
+		{
+		private:
+			std::chrono::nanoseconds& m_Total;
+			std::chrono::steady_clock::time_point m_Start;
+
+		public:
+			inline explicit ScopedTimer(std::chrono::nanoseconds& total)
+				: m_Total(total), m_Start(std::chrono::steady_clock::now())
+			{
+			}
+
+			inline ~ScopedTimer()
+			{
+				m_Total += std::chrono::steady_clock::now() - m_Start;
+			}
+
+			ScopedTimer(const ScopedTimer&) = delete;
+			ScopedTimer& operator=(const ScopedTimer&) = delete;
+		};
+
+		// Pixels `[MinX, MaxX)` x `[MinY, MaxY)` of a frame, as handed out by the tile scheduler.
+		struct TileStats
+		{
+			std::size_t MinX = 0;
+			std::size_t MinY = 0;
+			std::size_t MaxX = 0;
+			std::size_t MaxY = 0;
+			// Iteration counts of the pixels, summed.
+			std::uint64_t Iterations = 0;
+			// Pixels which escaped before the max iterations.
+			std::size_t Escaped = 0;
+		};
+
+		struct FrameStats
+		{
+			// Frames ended since `Init`, this one included. 0 before the first frame.
+			std::uint64_t Frame = 0;
+			// Render mode which produced the frame, e.g. "tiled", "pan" or "recolor".
+			const char* Mode = "none";
+			// False when the frame was cancelled by a newer one: the counts below then cover a partial frame.
+			bool Complete = false;
+			std::size_t Width = 0;
+			std::size_t Height = 0;
+			std::size_t MaxIterations = 0;
+			Precision FramePrecision{};
+
+			// From the start of the frame to its end. Upload and draw are not part of it, see `Phase`.
+			std::chrono::nanoseconds Total = std::chrono::nanoseconds::zero();
+			// Indexed by `Phase`. Upload and draw are those of the last frame drawn, zero without a window.
+			std::array<std::chrono::nanoseconds, PhaseCount> Phases = {};
+
+			// Iteration counts of every pixel, summed: pixels filled by interior rejection, periodicity
+			// detection or subdivision count as the iterations they stand for.
+			std::uint64_t Iterations = 0;
+			std::size_t EscapedPixels = 0;
+			// Pixels which reached the max iterations, found interior or not.
+			std::size_t LimitPixels = 0;
+			std::size_t InteriorRejectedPixels = 0;
+			std::size_t PeriodicPixels = 0;
+			// Iterations skipped by the linear approximation of perturbation frames.
+			std::size_t SkippedIterations = 0;
+			// Iterations the kernels actually ran for the frame, unlike `Iterations`: rejected, filled and
+			// cached pixels run none, periodic ones stop when found, and BLA steps are left out.
+			std::uint64_t ExecutedIterations = 0;
+
+			// Row by row, in the order of the scheduler.
+			std::vector<TileStats> Tiles;
+
+			// Time each worker spent processing the frame, and the rest of `Total`.
+			std::vector<std::chrono::nanoseconds> WorkerBusy;
+			std::vector<std::chrono::nanoseconds> WorkerIdle;
+
+			inline std::chrono::nanoseconds GetPhase(Phase phase) const
+			{
+				return Phases[static_cast<std::size_t>(phase)];
+			}
+
+			// Share of the pixels which escaped, 0 for an empty frame.
+			double GetEscapedFraction() const;
+		};
+
+		// Single JSON object with every field of `stats`, durations in nanoseconds.
+		std::string ToJson(const FrameStats& stats);
+
+		// A few lines summing `stats` up, as shown by the overlay.
+		std::string ToText(const FrameStats& stats);
+
+		// Writes `json` to `path`. Returns false if it couldn't be written.
+		bool WriteJson(const std::string& json, const std::string& path);
+	}
+}
+
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef MANDELBROT_MANDELBROTSUBDIVISION_HPP
+#define MANDELBROT_MANDELBROTSUBDIVISION_HPP
+
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Mandelbrot
+{
+	// Mariani-Silver rendering: the border of a rectangle is computed first. When the whole
+	// border has the same iteration count the inside is filled with it, otherwise the rectangle
+	// is split in two and each half is processed the same way.
+	// The Mandelbrot Set is connected, so a border of interior points never hides escaping ones.
+	// Escape bands are not guaranteed to be, which is why this is a render mode and not the default.
+	namespace Subdivision
+	{
+		struct Statistics
+		{
+			// Pixels whose iterations were actually computed.
+			std::size_t ComputedPixels = 0;
+			// Pixels filled from the border of a uniform rectangle.
+			std::size_t FilledPixels = 0;
+			// Time each worker spent processing rectangles.
+			std::vector<std::chrono::nanoseconds> WorkerBusy;
+		};
+
+		// Computes the iterations of `count` consecutive pixels starting at (x, y), going right,
+		// or down when `vertical` is set. The results are stored contiguously.
+		using LineFunction = std::function<void(std::size_t x, std::size_t y, std::size_t count, bool vertical, std::uint32_t* iterations)>;
+
+		// Renders a `width` x `height` frame into `iterations`, stored row by row.
+		// Rectangles are handed out to `threads` workers: the calling thread and threads of `pool`.
+		// Once `cancel` is set, the rectangles not started yet are dropped and the frame is left incomplete.
+		Statistics Render(ThreadPool& pool, std::size_t width, std::size_t height, const LineFunction& compute_line, std::uint32_t* iterations, std::size_t threads, const std::atomic<bool>* cancel = nullptr);
+	}
+}
+
+#endif
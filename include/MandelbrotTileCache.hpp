@@ -0,0 +1,210 @@
+#pragma once
+#ifndef MANDELBROT_MANDELBROTTILECACHE_HPP
+#define MANDELBROT_MANDELBROTTILECACHE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Mandelbrot
+{
+	// Cache of the iterations of finished tiles, so views visited again are assembled instead of computed.
+	//
+	// Every zoom has its own grid of `TileSize` x `TileSize` pixels, anchored at the origin of the plane:
+	// pixel (i, j) of the grid is the point ((i + phase) * zoom, (j + phase) * zoom), the phase being the
+	// position of the view within a pixel, rounded to `1 / PhaseSteps` pixels. Views moved by whole pixels
+	// share the grid of their zoom, which is the case of every view reached with the buttons. Tiles are only
+	// found at the zoom and phase they were computed at: the grids of other zooms are never looked up.
+	namespace TileCache
+	{
+		static constexpr std::size_t TileSize = 64;
+		static constexpr std::size_t TilePixels = TileSize * TileSize;
+
+		// Steps the sub-pixel position of a grid is rounded to, per pixel.
+		static constexpr long long PhaseSteps = 1024;
+
+		// Everything the iterations of a tile depend on. Laid out without padding, as it is also written to the disk store.
+		struct Key
+		{
+			double Zoom = 0.0;
+			std::int64_t TileX = 0;
+			std::int64_t TileY = 0;
+			// Position of the grid within a pixel, in `1 / PhaseSteps` pixels.
+			std::int32_t PhaseX = 0;
+			std::int32_t PhaseY = 0;
+			std::uint32_t MaxIterations = 0;
+			// A `Precision`.
+			std::uint32_t KeyPrecision = 0;
+
+			inline bool operator==(const Key& other) const
+			{
+				return Zoom == other.Zoom && TileX == other.TileX && TileY == other.TileY && PhaseX == other.PhaseX && PhaseY == other.PhaseY
+					&& MaxIterations == other.MaxIterations && KeyPrecision == other.KeyPrecision;
+			}
+		};
+
+		struct KeyHash
+		{
+			std::size_t operator()(const Key& key) const;
+		};
+
+		struct Tile
+		{
+			// `Values` iteration counts: `TilePixels` row by row, or a single one shared by every pixel.
+			const std::uint32_t* Iterations = nullptr;
+			// Continuous iteration counts laid out the same way, null when they weren't computed.
+			const float* Smooth = nullptr;
+			std::size_t Values = 0;
+			// Owner of the values: a buffer of the tile, or the mapping of the segment it was read from.
+			std::shared_ptr<const void> Storage;
+		};
+
+		// Makes a tile from `TilePixels` iterations, and as many continuous ones unless `smooth` is null.
+		// Tiles of a single value, such as interior ones, only keep that value.
+		std::shared_ptr<const Tile> MakeTile(const std::uint32_t* iterations, const float* smooth);
+
+		// Copies the row `y` of `tile` from column `x` on into `iterations`, and into `smooth` unless it is null.
+		void CopyTileRow(const Tile& tile, std::size_t x, std::size_t y, std::size_t count, std::uint32_t* iterations, float* smooth);
+
+		struct Statistics
+		{
+			std::size_t MemoryHits = 0;
+			std::size_t DiskHits = 0;
+			std::size_t Misses = 0;
+		};
+
+		// Read-only mapping of part of a file. Defined in `MandelbrotTileCache.cpp`.
+		class MappedFile;
+
+		// Tiles kept in memory up to a byte budget, least recently used first out. With a directory, the
+		// tiles evicted from memory are appended to segment files in it, up to a disk budget, oldest
+		// segment first out. Records are mapped once, and tiles found in them are read in place.
+		// Every process appends to and trims segments of its own, and reads the ones of the others,
+		// so processes may share a directory. Every member is thread-safe.
+		class Cache
+		{
+		private:
+			struct Entry
+			{
+				Key TileKey;
+				std::shared_ptr<const Tile> Data;
+				// Set once the directory has the tile as well, so evicting it writes nothing.
+				bool Stored = false;
+			};
+
+			// Where a tile of the disk store is: its record in a segment, at `Offset` in a mapping of part of it.
+			struct Location
+			{
+				std::uint64_t SegmentId = 0;
+				std::shared_ptr<const MappedFile> Mapping;
+				std::size_t Offset = 0;
+			};
+
+			struct Segment
+			{
+				std::filesystem::path Path;
+				// Bytes indexed, up to the end of the last whole record.
+				std::size_t Size = 0;
+				// Written by this process. The segments of other processes are theirs to trim.
+				bool Own = false;
+				// Last write time when indexed, so segments other processes append to are indexed again.
+				std::filesystem::file_time_type Modified;
+			};
+
+			std::list<Entry> m_Entries;
+			std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_Index;
+			std::size_t m_Bytes = 0;
+			std::size_t m_Budget = std::size_t(256) << 20;
+
+			std::filesystem::path m_Directory;
+			std::size_t m_DiskBudget = std::size_t(1024) << 20;
+			// Segments by id, oldest first.
+			std::map<std::uint64_t, Segment> m_Segments;
+			std::unordered_map<Key, Location, KeyHash> m_DiskIndex;
+			std::uint64_t m_NextSegmentId = 0;
+			// Tiles evicted from memory and not written to the directory yet. See `Flush`.
+			std::unordered_map<Key, std::shared_ptr<const Tile>, KeyHash> m_Pending;
+			// Lookups missed since the directory was last listed, for the segments of other processes.
+			std::size_t m_MissesSinceScan = 0;
+			std::chrono::steady_clock::time_point m_LastScan;
+
+			Statistics m_Statistics;
+			mutable std::mutex m_Mutex;
+
+			// Held while writing to the directory, without `m_Mutex`, so lookups don't wait for the disk.
+			// Segments and the disk index change under both.
+			std::mutex m_DiskMutex;
+			// Segment this process appends to, its id and size. Only used under `m_DiskMutex`, as is `m_NextSegmentId`.
+			std::ofstream m_Writer;
+			std::uint64_t m_WriterId = 0;
+			std::size_t m_WriterBytes = 0;
+
+			// Tile written to the segment of `m_Writer`, at `Offset`.
+			struct Record
+			{
+				Key TileKey;
+				std::shared_ptr<const Tile> Data;
+				std::size_t Offset = 0;
+			};
+
+			// Stores `tile` as the most recent entry, then evicts entries until the budget is met.
+			void Store(const Key& key, const std::shared_ptr<const Tile>& tile, bool stored);
+			// Evicted tiles go to `m_Pending`, unless the directory has them already or is not set.
+			void Evict();
+
+			// The members below are called under `m_DiskMutex`.
+			// Starts a new segment for `m_Writer`. False when the file couldn't be created.
+			bool OpenSegment(const std::filesystem::path& directory);
+			// Maps the records `written` to the segment of `m_Writer` since the last call, then indexes them.
+			void PublishSegment(const std::vector<Record>& written);
+			// Maps and indexes the segments of `directory` not known yet and the records appended to the ones
+			// of other processes, and forgets the segments of other processes no longer there.
+			void ScanSegments(const std::filesystem::path& directory);
+			// Deletes the oldest segments of this process until the disk budget is met, but the one of `m_Writer`,
+			// and the segments of other processes not written to for `StaleSegmentAge`.
+			void TrimSegments();
+			// Drops the records of the disk index whose segment is gone. Called under `m_Mutex`.
+			void EraseLocations();
+
+		public:
+			// Returns the tile of `key`, or null if neither the memory nor the directory has it.
+			// A tile without continuous iteration counts doesn't count when `smooth` is set.
+			std::shared_ptr<const Tile> Find(const Key& key, bool smooth);
+
+			// Keeps `tile` for `key`, unless the tile already kept has everything `tile` has.
+			void Insert(const Key& key, std::shared_ptr<const Tile> tile);
+
+			// Appends the tiles evicted since the last call to the directory. After misses, also indexes the
+			// segments other processes wrote since, at most every `RescanInterval`.
+			void Flush();
+
+			void SetBudget(std::size_t bytes);
+			std::size_t GetBudget() const;
+			std::size_t GetBytes() const;
+
+			// Bytes of the segment files of this process kept in the directory. The segments of other processes
+			// are left to them, and only deleted once not written to for a day.
+			void SetDiskBudget(std::size_t bytes);
+			std::size_t GetDiskBudget() const;
+			std::size_t GetDiskBytes() const;
+
+			// Directory of the tiles kept on disk, created if needed. Tiles stay in memory only when empty, the default.
+			void SetDirectory(const std::string& path);
+			std::string GetDirectory() const;
+
+			// Lookups since the last call.
+			Statistics TakeStatistics();
+		};
+	}
+}
+
+#endif
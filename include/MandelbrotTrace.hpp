@@ -0,0 +1,98 @@
+#pragma once
+#ifndef MANDELBROT_MANDELBROTTRACE_HPP
+#define MANDELBROT_MANDELBROTTRACE_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+namespace Mandelbrot
+{
+	// Timeline of the rendering: frames, phases, worker runs and tiles, each with the time it started and
+	// ended on the thread it ran on, exported as a Chrome trace (chrome://tracing or ui.perfetto.dev).
+	//
+	// Every thread records into a ring buffer of its own, without locks, and only once tracing is enabled:
+	// the oldest events of a thread are overwritten once its ring is full. Rings of exited threads are
+	// reused by the next threads, so there are only as many as threads recording at once. Disabled, a
+	// trace point costs the load of a flag.
+	namespace Trace
+	{
+		// Events kept per thread.
+		static constexpr std::size_t BufferEvents = std::size_t(1) << 14;
+		static constexpr std::size_t MaxArguments = 4;
+
+		// Integer shown along with an event. `Name` must outlive the trace, e.g. a literal.
+		struct Argument
+		{
+			const char* Name = nullptr;
+			std::uint64_t Value = 0;
+		};
+
+		struct Event
+		{
+			// Literals, which must outlive the trace.
+			const char* Name = nullptr;
+			const char* Category = nullptr;
+			std::chrono::steady_clock::time_point Start;
+			std::chrono::nanoseconds Duration = std::chrono::nanoseconds::zero();
+			// Unused entries have no name.
+			std::array<Argument, MaxArguments> Arguments = {};
+		};
+
+		void Enable(bool enabled);
+		bool IsEnabled();
+
+		// Name of the calling thread in the trace, kept while the thread lives. Unnamed threads are numbered
+		// after their ring, which may have been another thread's.
+		void SetThreadName(const char* name);
+
+		// Records an event of the calling thread from `start` to `end`, unless tracing is disabled.
+		// Arguments past `MaxArguments` are dropped.
+		void Record(const char* name, const char* category, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, std::initializer_list<Argument> arguments = {});
+
+		// Records an event from its construction to its destruction, if tracing was enabled at its construction.
+		class Scope
+		{
+		private:
+			const char* m_Name;
+			const char* m_Category;
+			Argument m_Argument;
+			bool m_Enabled;
+			std::chrono::steady_clock::time_point m_Start;
+
+		public:
+			inline Scope(const char* name, const char* category, Argument argument = {})
+				: m_Name(name), m_Category(category), m_Argument(argument), m_Enabled(IsEnabled())
+			{
+				if (m_Enabled)
+				{
+					m_Start = std::chrono::steady_clock::now();
+				}
+			}
+
+			inline ~Scope()
+			{
+				if (m_Enabled)
+				{
+					Record(m_Name, m_Category, m_Start, std::chrono::steady_clock::now(), { m_Argument });
+				}
+			}
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+		};
+
+		// Chrome trace JSON of the events of every thread, oldest first per thread. Timestamps are in
+		// microseconds since the program started.
+		// Reads the rings without locks: no thread may record meanwhile. See `Mandelbrot::WriteTrace`.
+		std::string ToJson();
+
+		// Drops every event. Same restriction as `ToJson`.
+		void Clear();
+	}
+}
+
+#endif
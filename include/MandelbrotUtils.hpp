@@ -3,24 +3,51 @@
 #define MANDELBROT_MANDELBROTUTILS_HPP
 
 #include <iostream>
+#include <string>
+#include <vector>
 #include <SFML/Graphics.hpp>
 
+#include "HighPrecision.hpp"
+#include "MandelbrotPalette.hpp"
+#include "MandelbrotStats.hpp"
+#include "RenderJob.hpp"
+
 namespace sf
 {
 	typedef Vector2<long double>  Vector2ld;
+	typedef Vector2<Mandelbrot::HighPrecision>  Vector2hp;
 }
 
 namespace Mandelbrot
 {
+	// Floating point type used to compute a frame, from the cheapest to the most precise.
+	// `Perturbation` iterates `double` deltas from an arbitrary precision reference orbit.
+	// `Exhausted` means that none of the above can tell adjacent pixels apart.
+	enum class Precision
+	{
+		Float,
+		Double,
+		LongDouble,
+		Perturbation,
+		Exhausted
+	};
+
 	// Initializes the Mandelbrot set
 	void Init();
 
 	// Process Mandelbrot points in Single-threaded Mode
 	void ProcessSt();
 
-	// Process Mandelbrot points in Multi-threaded Mode
+	// Process Mandelbrot points in Multi-threaded Mode. Blocks until the frame is done.
 	void ProcessMt();
 
+	// Renders the current plane in the background and returns immediately. The job is tagged
+	// with the current plane generation and cancels the previously submitted one: only the
+	// pixels of the newest job are ever published to the vertex buffer or the sprite.
+	RenderJob SubmitRender();
+	// Incremented by every change of the zoom, the offset or the max iterations.
+	std::uint64_t GetPlaneGeneration();
+
 	std::size_t GetPointIterations(const sf::Vector2ld& plane_coords);
 
 	// Returns the true x-y coordinates of the Set.
@@ -32,6 +59,25 @@ namespace Mandelbrot
 	std::size_t GetDefaultMaxIterations();
 
 	sf::Color GetPointColor(std::size_t iter);
+	// Colour of the `index`-th entry of `palette`. Entries repeat, so any index is valid.
+	sf::Color GetPaletteColor(Palette palette, std::size_t index);
+
+	// Colouring of the frames. Every frame keeps its iterations, so changing any of these,
+	// or lowering the max iterations, only recolours the last frame instead of computing a new one.
+	void SetPalette(Palette palette);
+	Palette GetPalette();
+	const char* GetPaletteName(Palette palette);
+	// Colour cycling: pixels take the palette entry `offset` places after their iterations.
+	void SetColorCycle(std::size_t offset);
+	std::size_t GetColorCycle();
+	// Smooth colouring: blends palette entries with continuous iteration counts instead of showing bands.
+	// The first frame after enabling it is computed again, to get the continuous counts.
+	void UseSmoothColoring(bool enable = true);
+	bool IsUsingSmoothColoring();
+	// Histogram colouring: every escape time takes the colour of its rank among the escaping pixels
+	// of the frame, so the palette stays spread over the frame whatever the max iterations.
+	void UseHistogramColoring(bool enable = true);
+	bool IsUsingHistogramColoring();
 
 	// Multi Thread Functions
 	void SetMaxThreads(std::size_t threads);
@@ -43,6 +89,20 @@ namespace Mandelbrot
 	void UseVertexBuffer(bool enable = sf::VertexBuffer::isAvailable());
 	bool IsUsingVertexBuffer();
 
+	// Colours of the frame, row by row, as wide as the resolution. Only complete once
+	// `ProcessSt` or `ProcessMt` returned. Needs no OpenGL context, unlike the draw functions.
+	const sf::Color* GetFramePixels();
+	// Iteration counts of the same frame, laid out the same way.
+	const std::uint32_t* GetFrameIterations();
+	// Forgets the last frame, so the next one is computed from scratch whatever changed, e.g. to time it.
+	void DiscardRetainedFrame();
+
+	// Size of the frames in pixels, `Config::WINDOW_WIDTH` x `Config::WINDOW_HEIGHT` until changed.
+	// Changing it waits for the frame being rendered, releases the frame buffers and computes the next
+	// frame from scratch: buffers are only ever allocated with the size of the frames rendered.
+	void SetResolution(const sf::Vector2u& resolution);
+	sf::Vector2u GetResolution();
+
 	void DrawMandelbrotSet(sf::RenderWindow& renderer);
 
 	void SetZoom(const long double& zoom);
@@ -50,15 +110,115 @@ namespace Mandelbrot
 	void SetDefaultZoom(long double zoom);
 	long double GetDefaultZoom();
 
+	// Returns the precision used by the last processed frame.
+	Precision GetFramePrecision();
+	// Returns the precision the current plane data would be processed with.
+	Precision GetRequiredPrecision();
+	// Frames are computed with at least `precision`, even where a cheaper one resolves their pixels,
+	// e.g. to compare precisions on the same view. Perturbation is only forced down to its zoom limit.
+	void SetMinimumPrecision(Precision precision);
+	Precision GetMinimumPrecision();
+	const char* GetPrecisionName(Precision precision);
+
+	// Deep zoom mode: once `double` runs out of precision, frames are computed by
+	// perturbation around a reference orbit instead of in `long double`.
+	void UseDeepZoom(bool enable = true);
+	bool IsUsingDeepZoom();
+
+	// Skips deep zoom iterations with a bivariate linear approximation of the reference orbit.
+	void UseLinearApproximation(bool enable = true);
+	bool IsUsingLinearApproximation();
+	// Returns how many iterations were skipped by the linear approximation in the last frame.
+	std::size_t GetSkippedIterations();
+
+	// Returns how many pixels of the last frame were found inside the main cardioid
+	// or the period-2 bulb by the closed form test, without iterating.
+	std::size_t GetInteriorRejectedPixels();
+
+	// Stops iterating interior pixels once their orbit settles on an attracting cycle.
+	void UsePeriodicityDetection(bool enable = true);
+	bool IsUsingPeriodicityDetection();
+	// Returns how many pixels of the last frame were found periodic before `MaxIterations`.
+	std::size_t GetPeriodicPixels();
+
+	// Share of the last frame, from its start to its end, each worker spent computing or colouring pixels.
+	// Worker 0 runs on the thread rendering the frame.
+	std::vector<double> GetWorkerUtilization();
+	// Timings, iteration counts and worker times of the last frame, see `MandelbrotStats.hpp`.
+	// Safe to call from any thread, while frames render.
+	Stats::FrameStats GetLastFrameStats();
+
+	// Mariani-Silver subdivision: rectangles with a uniform border are filled instead of computed.
+	// Skipped while smooth colouring is on: filled pixels have no continuous counts.
+	void UseSubdivision(bool enable = true);
+	bool IsUsingSubdivision();
+	// Pixels of the last subdivided frame which were computed, and which were filled.
+	std::size_t GetComputedPixels();
+	std::size_t GetFilledPixels();
+
+	// Progressive rendering: multi-threaded frames are shown at 1 sample per 16x16 block first,
+	// then refined down to full resolution. Subdivision takes precedence when both are enabled.
+	void UseProgressiveRendering(bool enable = true);
+	bool IsUsingProgressiveRendering();
+
+	// Incremental panning: when only the offset changed, by a whole number of pixels, the previous
+	// frame is shifted and only the strips it exposes are computed.
+	void UseIncrementalPanning(bool enable = true);
+	bool IsUsingIncrementalPanning();
+
+	// Zoom reprojection: any other change of view is first shown as the previous frame resampled
+	// to it. Zooms by a power of two around the same offset then only compute the pixels which
+	// don't fall on a pixel of the previous frame.
+	void UseZoomReprojection(bool enable = true);
+	bool IsUsingZoomReprojection();
+
+	// Resumable iterations: raising the max iterations only continues the pixels of the previous
+	// frame which reached the old limit, from the orbit value they stopped at.
+	void UseResumableIterations(bool enable = true);
+	bool IsUsingResumableIterations();
+
+	// Tile cache: finished frames are kept as 64x64 tiles on a grid per zoom, anchored at the origin of the
+	// plane, so views visited again, e.g. with the zoom and offset buttons or the reset key, are assembled
+	// from them and only compute the tiles missing. Not used at deep zoom nor with subdivision.
+	void UseTileCache(bool enable = true);
+	bool IsUsingTileCache();
+	// Bytes of tiles kept in memory, least recently used first out.
+	void SetTileCacheBudget(std::size_t bytes);
+	std::size_t GetTileCacheBudget();
+	// Directory the tiles evicted from memory are written to, and read from when not in memory. Processes may
+	// share it. Tiles only stay in memory while it is empty, which is the default.
+	void SetTileCacheDirectory(const std::string& path);
+	std::string GetTileCacheDirectory();
+	// Bytes of tiles kept in the directory, oldest first out.
+	void SetTileCacheDiskBudget(std::size_t bytes);
+	std::size_t GetTileCacheDiskBudget();
+
+	// Tracing: frames, their phases, worker runs and tiles are recorded on a timeline, see `MandelbrotTrace.hpp`.
+	void UseTracing(bool enable = true);
+	bool IsUsingTracing();
+	// Writes the events recorded since the last call to `path` as a Chrome trace, then drops them. Waits for
+	// the job rendering, if any, so it must not be called by a job. Returns false if it couldn't be written.
+	bool WriteTrace(const std::string& path);
+
 	void SetOffset(const sf::Vector2ld& offset);
 	sf::Vector2ld GetOffset();
 	void SetDefaultOffset(const sf::Vector2ld& offset);
 	sf::Vector2ld GetDefaultOffset();
 
+	// Offsets are stored at arbitrary precision, `long double` ones are rounded.
+	void SetPreciseOffset(const sf::Vector2hp& offset);
+	sf::Vector2hp GetPreciseOffset();
+	void SetPreciseDefaultOffset(const sf::Vector2hp& offset);
+	sf::Vector2hp GetPreciseDefaultOffset();
+
+	// Moves the offset by `delta` without losing the precision of the current offset.
+	void MoveOffset(const sf::Vector2ld& delta);
+
 	// Updates the plane(vertex buffer or sprite) only if something has changed.
-	void Update();
-	// Updates the plane(vertex buffer or sprite).
-	void ForceUpdate();
+	// Returns the job rendering the plane, without waiting for it.
+	RenderJob Update();
+	// Updates the plane(vertex buffer or sprite). Returns the job rendering it, without waiting for it.
+	RenderJob ForceUpdate();
 }
 
 #endif
\ No newline at end of file
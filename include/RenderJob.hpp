@@ -0,0 +1,105 @@
+#pragma once
+#ifndef MANDELBROT_RENDERJOB_HPP
+#define MANDELBROT_RENDERJOB_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace Mandelbrot
+{
+	// Handle to a frame rendered in the background. Copies refer to the same job.
+	// The generation is the one of the plane state the frame was taken from.
+	class RenderJob
+	{
+	private:
+		struct State
+		{
+			std::uint64_t Generation = 0;
+			std::atomic<bool> Cancelled = false;
+
+			std::mutex Mutex;
+			std::condition_variable Condition;
+			bool Done = false;
+		};
+
+		std::shared_ptr<State> m_State;
+
+	public:
+		// Refers to no job: it is done, and can't be cancelled.
+		inline RenderJob() = default;
+
+		inline explicit RenderJob(std::uint64_t generation)
+			: m_State(std::make_shared<State>())
+		{
+			m_State->Generation = generation;
+		}
+
+		inline bool IsValid() const
+		{
+			return m_State != nullptr;
+		}
+
+		inline std::uint64_t GetGeneration() const
+		{
+			return m_State ? m_State->Generation : 0;
+		}
+
+		// Workers stop at the next tile, and nothing the job computed reaches the screen anymore.
+		inline void Cancel()
+		{
+			if (m_State)
+			{
+				m_State->Cancelled = true;
+			}
+		}
+
+		inline bool IsCancelled() const
+		{
+			return m_State && m_State->Cancelled;
+		}
+
+		// Flag polled by the workers between tiles. Null for a handle without job.
+		inline const std::atomic<bool>* GetCancellationToken() const
+		{
+			return m_State ? &m_State->Cancelled : nullptr;
+		}
+
+		inline bool IsDone() const
+		{
+			if (!m_State)
+			{
+				return true;
+			}
+			std::lock_guard<std::mutex> lock(m_State->Mutex);
+			return m_State->Done;
+		}
+
+		// Blocks until the job is done, either completed or cancelled.
+		inline void Wait() const
+		{
+			if (m_State)
+			{
+				std::unique_lock<std::mutex> lock(m_State->Mutex);
+				m_State->Condition.wait(lock, [this]() { return m_State->Done; });
+			}
+		}
+
+		// Called by the renderer once it is done with the job.
+		inline void Finish()
+		{
+			if (m_State)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_State->Mutex);
+					m_State->Done = true;
+				}
+				m_State->Condition.notify_all();
+			}
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,153 @@
+#pragma once
+#ifndef MANDELBROT_THREADPOOL_HPP
+#define MANDELBROT_THREADPOOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Mandelbrot
+{
+	// Long-lived worker threads. Threads are only created by `Start`, never on the per-frame path.
+	class ThreadPool
+	{
+	private:
+		std::vector<std::thread> m_Threads;
+		std::deque<std::function<void()>> m_Tasks;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_Stopping = false;
+
+	public:
+		inline ThreadPool() = default;
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		inline ~ThreadPool()
+		{
+			Stop();
+		}
+
+		// (Re)starts the pool with `threads` threads. Tasks already queued are run first.
+		inline void Start(std::size_t threads)
+		{
+			if (threads == m_Threads.size())
+			{
+				return;
+			}
+
+			Stop();
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stopping = false;
+			for (std::size_t i = 0; i < threads; i++)
+			{
+				m_Threads.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+			}
+		}
+
+		// Runs the remaining tasks, then joins every thread.
+		inline void Stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Stopping = true;
+			}
+			m_Condition.notify_all();
+
+			for (auto& t : m_Threads)
+			{
+				t.join();
+			}
+			m_Threads.clear();
+		}
+
+		inline std::size_t GetThreadCount() const
+		{
+			return m_Threads.size();
+		}
+
+		// Queues `task` and returns immediately.
+		inline void Submit(std::function<void()> task)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Tasks.push_back(std::move(task));
+			}
+			m_Condition.notify_one();
+		}
+
+		// Calls `task(worker)` for every worker in `[0, workers)` and returns once they are all done.
+		// Worker 0 runs on the calling thread, which also helps with queued tasks while it waits:
+		// a pool thread calling `Run` can't deadlock the pool, and without threads everything runs inline.
+		inline void Run(std::size_t workers, const std::function<void(std::size_t)>& task)
+		{
+			workers = std::max<std::size_t>(workers, 1);
+
+			std::size_t remaining = workers - 1;
+			for (std::size_t w = 1; w < workers; w++)
+			{
+				Submit([this, w, &task, &remaining]()
+				{
+					task(w);
+
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					if (--remaining == 0)
+					{
+						m_Condition.notify_all();
+					}
+				});
+			}
+
+			task(0);
+
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			while (remaining > 0)
+			{
+				if (!m_Tasks.empty())
+				{
+					RunOne(lock);
+				}
+				else
+				{
+					m_Condition.wait(lock);
+				}
+			}
+		}
+
+	private:
+		// Pops and runs the first task, with `lock` released while it runs.
+		inline void RunOne(std::unique_lock<std::mutex>& lock)
+		{
+			std::function<void()> task = std::move(m_Tasks.front());
+			m_Tasks.pop_front();
+
+			lock.unlock();
+			task();
+			lock.lock();
+		}
+
+		inline void WorkerLoop()
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			while (true)
+			{
+				m_Condition.wait(lock, [this]() { return m_Stopping || !m_Tasks.empty(); });
+				if (m_Tasks.empty())
+				{
+					return;
+				}
+				RunOne(lock);
+			}
+		}
+	};
+}
+
+#endif
@@ -19,6 +19,7 @@ public:
 		m_bRunning = false;
 	}
 
+	// Down to the microsecond: whole milliseconds would hide the passes which take less.
 	inline double elapsedMilliseconds()
 	{
 		std::chrono::time_point<std::chrono::high_resolution_clock> endTime;
@@ -32,7 +33,7 @@ public:
 			endTime = m_EndTime;
 		}
 
-		return static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(endTime - m_StartTime).count());
+		return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(endTime - m_StartTime).count()) / 1000.0;
 	}
 
 	inline double elapsedSeconds()
@@ -2,18 +2,201 @@
 #include "Config.hpp"
 #include "MandelbrotUtils.hpp"
 #include "MandelbrotGui.hpp"
+#include "MandelbrotBatch.hpp"
+#include "MandelbrotMovie.hpp"
+#include "MandelbrotTrace.hpp"
 #include "Logger.hpp"
 #include "Timer.hpp"
 
 #include <SFML/Graphics.hpp>
 #include <SFML/OpenGL.hpp>
 
+#include <docopt/docopt.h>
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+static constexpr const char* Usage = R"(Mandelbrot Set.
+
+Usage:
+  Mandelbrot [--tile-cache=<dir>]
+  Mandelbrot render <output> [options]
+  Mandelbrot movie <output> [options]
+  Mandelbrot (-h | --help)
+
+`render` writes a single image to <output> (.png, .bmp, .tga, .jpg or .ppm) without opening a window.
+.ppm images are rendered in bands which fit in the memory budget, and streamed to the file.
+An interrupted .ppm render run again with the same options continues where it stopped.
+
+`movie` zooms from --zoom to --end-zoom into the center and streams the frames to <output> as
+YUV4MPEG2, or to the standard output when <output> is -, e.g. `Mandelbrot movie - | ffmpeg -i - zoom.mp4`.
+
+Options:
+  -h --help            Show this screen.
+  --center-x=<x>       Real part of the center of the image [default: -0.7].
+  --center-y=<y>       Imaginary part of the center of the image [default: 0].
+  --zoom=<zoom>        Plane units per pixel, of the first frame of a movie [default: 0.004].
+  --end-zoom=<zoom>    Plane units per pixel of the last frame of a movie [default: 4e-9].
+  --frames-per-octave=<n>  Movie frames per zoom by two [default: 60].
+  --fps=<n>            Frame rate of the movie [default: 30].
+  --iterations=<n>     Max iterations [default: 1000].
+  --width=<pixels>     Width of the image [default: 1280].
+  --height=<pixels>    Height of the image [default: 720].
+  --threads=<n>        Worker threads, 0 for every hardware thread [default: 0].
+  --palette=<name>     classic or grayscale [default: classic].
+  --smooth             Smooth colouring.
+  --memory=<MiB>       Memory budget of the frame buffers [default: 1024].
+  --stats=<path>       Write the statistics of the rendered frames to <path> as JSON.
+  --trace=<path>       Write a timeline of the rendering to <path> as a Chrome trace.
+  --tile-cache=<dir>   Keep the tiles the window evicts from memory in <dir>, shared with other instances.
+)";
+
+static bool ParsePalette(const std::string& name, Mandelbrot::Palette& palette)
+{
+	if (name != "classic" && name != "grayscale")
+	{
+		Logger::GetLogger()->error("Unknown palette \"{}\".", name);
+		return false;
+	}
+	palette = name == "grayscale" ? Mandelbrot::Palette::Grayscale : Mandelbrot::Palette::Classic;
+	return true;
+}
+
+// Parses a coordinate of the center at arbitrary precision, keeping every digit given and at least the
+// digits `resolution` needs. Throws `std::invalid_argument` when `text` is not a decimal number.
+static Mandelbrot::HighPrecision ParseCenter(const std::string& text, long double resolution)
+{
+	std::size_t pos = text.size() > 0 && (text[0] == '-' || text[0] == '+') ? 1 : 0;
+	std::size_t mantissa_digits = 0;
+	long long fraction_digits = 0;
+	bool point = false;
+	for (; pos < text.size(); pos++)
+	{
+		if (text[pos] >= '0' && text[pos] <= '9')
+		{
+			mantissa_digits++;
+			fraction_digits += point ? 1 : 0;
+		}
+		else if (text[pos] == '.' && !point)
+		{
+			point = true;
+		}
+		else
+		{
+			break;
+		}
+	}
+	if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E'))
+	{
+		std::size_t exponent_length = 0;
+		fraction_digits -= std::stoll(text.substr(pos + 1), &exponent_length);
+		pos += exponent_length + 1;
+	}
+	if (mantissa_digits == 0 || pos != text.size())
+	{
+		throw std::invalid_argument(text);
+	}
+
+	// log2(10) bits per decimal digit, rounded up.
+	const std::size_t digit_bits = static_cast<std::size_t>(std::max(fraction_digits, 0LL) * 3322 / 1000 + 1);
+	const std::size_t digit_limbs = (digit_bits + 31) / 32;
+	return Mandelbrot::HighPrecision::FromString(text, std::max(Mandelbrot::HighPrecision::LimbsForResolution(resolution), digit_limbs));
+}
+
+// Renders the image requested on the command line. Returns the exit code of the program.
+int RenderHeadless(std::map<std::string, docopt::value>& args)
+{
+	Mandelbrot::Batch::Settings settings;
+	try
+	{
+		settings.Zoom = std::stold(args["--zoom"].asString());
+		// Centers are parsed at arbitrary precision, so deep zooms keep every digit given.
+		settings.CenterX = ParseCenter(args["--center-x"].asString(), settings.Zoom);
+		settings.CenterY = ParseCenter(args["--center-y"].asString(), settings.Zoom);
+		settings.MaxIterations = std::stoull(args["--iterations"].asString());
+		settings.Width = std::stoull(args["--width"].asString());
+		settings.Height = std::stoull(args["--height"].asString());
+		settings.Threads = std::stoull(args["--threads"].asString());
+		settings.MemoryBudget = static_cast<std::size_t>(std::stoull(args["--memory"].asString())) << 20;
+	}
+	catch (const std::exception&)
+	{
+		Logger::GetLogger()->error("Invalid numeric option.\n{}", Usage);
+		return 1;
+	}
+
+	if (!ParsePalette(args["--palette"].asString(), settings.ColorPalette))
+	{
+		return 1;
+	}
+	if (settings.Width == 0 || settings.Height == 0 || settings.Zoom <= 0)
+	{
+		Logger::GetLogger()->error("The image size and the zoom must be positive.");
+		return 1;
+	}
+	settings.Smooth = args["--smooth"].asBool();
+	settings.OutputPath = args["<output>"].asString();
+	settings.StatsPath = args["--stats"] ? args["--stats"].asString() : std::string();
+	settings.TracePath = args["--trace"] ? args["--trace"].asString() : std::string();
+
+	Mandelbrot::Init();
+	return Mandelbrot::Batch::Render(settings) ? 0 : 1;
+}
+
+// Renders the zoom movie requested on the command line. Returns the exit code of the program.
+int RenderMovie(std::map<std::string, docopt::value>& args)
+{
+	Mandelbrot::Movie::Settings settings;
+	try
+	{
+		settings.StartZoom = std::stold(args["--zoom"].asString());
+		settings.EndZoom = std::stold(args["--end-zoom"].asString());
+		// Precise enough for the last frame, the deepest one.
+		settings.CenterX = ParseCenter(args["--center-x"].asString(), std::min(settings.StartZoom, settings.EndZoom));
+		settings.CenterY = ParseCenter(args["--center-y"].asString(), std::min(settings.StartZoom, settings.EndZoom));
+		settings.FramesPerOctave = std::stoull(args["--frames-per-octave"].asString());
+		settings.FrameRate = std::stoull(args["--fps"].asString());
+		settings.MaxIterations = std::stoull(args["--iterations"].asString());
+		settings.Width = std::stoull(args["--width"].asString());
+		settings.Height = std::stoull(args["--height"].asString());
+		settings.Threads = std::stoull(args["--threads"].asString());
+	}
+	catch (const std::exception&)
+	{
+		Logger::GetLogger()->error("Invalid numeric option.\n{}", Usage);
+		return 1;
+	}
+
+	if (!ParsePalette(args["--palette"].asString(), settings.ColorPalette))
+	{
+		return 1;
+	}
+	settings.Smooth = args["--smooth"].asBool();
+	settings.OutputPath = args["<output>"].asString();
+	settings.StatsPath = args["--stats"] ? args["--stats"].asString() : std::string();
+	settings.TracePath = args["--trace"] ? args["--trace"].asString() : std::string();
+
+	return Mandelbrot::Movie::Render(settings) ? 0 : 1;
+}
+
 void RendererThread(sf::RenderWindow* window)
 {
 	window->setActive(true);
+	Mandelbrot::Trace::SetThreadName("draw");
 
+	sf::Vector2u view_size = window->getSize();
 	while (window->isOpen())
 	{
+		// The view follows the resolution, so frames are drawn pixel for pixel instead of stretched to the window.
+		const sf::Vector2u resolution = Mandelbrot::GetResolution();
+		if (resolution != view_size)
+		{
+			window->setView(sf::View(sf::FloatRect(0.f, 0.f, static_cast<float>(resolution.x), static_cast<float>(resolution.y))));
+			view_size = resolution;
+		}
+
 		window->clear();
 
 		Mandelbrot::DrawMandelbrotSet(*window);
@@ -23,9 +206,21 @@ void RendererThread(sf::RenderWindow* window)
 	}
 }
 
-int main()
+int main(int argc, const char** argv)
 {
-	Logger::Init("MANDELBROT");
+	std::map<std::string, docopt::value> args = docopt::docopt(Usage, { argv + 1, argv + argc }, true);
+
+	// Movies may be streamed to the standard output, so the log goes to stderr then.
+	Logger::Init("MANDELBROT", args["movie"].asBool());
+	if (args["render"].asBool())
+	{
+		return RenderHeadless(args);
+	}
+	if (args["movie"].asBool())
+	{
+		return RenderMovie(args);
+	}
+
 	Logger::GetLogger()->trace("Size of `double`: {}", sizeof(double));
 	Logger::GetLogger()->trace("Size of `long double`: {}", sizeof(long double));
 
@@ -46,6 +241,12 @@ int main()
 	Mandelbrot::SetDefaultOffset({ offsetX, offsetY });
 	Mandelbrot::SetDefaultMaxIterations(1000u);
 
+	// Tiles only outlive the window when asked for.
+	if (args["--tile-cache"])
+	{
+		Mandelbrot::SetTileCacheDirectory(args["--tile-cache"].asString());
+	}
+
 	
 
 	Timer timer;
@@ -61,7 +262,7 @@ int main()
 	sf::RenderWindow window = sf::RenderWindow(
 		sf::VideoMode(Mandelbrot::Config::WINDOW_WIDTH, Mandelbrot::Config::WINDOW_HEIGHT),
 		"Mandelbrot Set - by Vaccher Diego",
-		sf::Style::Close | sf::Style::Titlebar,
+		sf::Style::Close | sf::Style::Titlebar | sf::Style::Resize,
 		settings
 	);
 
@@ -70,6 +271,9 @@ int main()
 	sf::Thread renderer_thread(&RendererThread, &window);
 	renderer_thread.launch();
 
+	// Frames render in the background, so a held click would otherwise move the offset on every loop.
+	bool was_clicking = false;
+
 	while (window.isOpen())
 	{
 		sf::Event events;
@@ -80,19 +284,31 @@ int main()
 				case sf::Event::Closed:
 					window.close();
 					break;
+				case sf::Event::Resized:
+					// Frames are rendered at the size of the window, buffers only change when it does.
+					Mandelbrot::SetResolution({ events.size.width, events.size.height });
+					Mandelbrot::Gui::ResizeGui();
+					Mandelbrot::ForceUpdate();
+					break;
 			}
 		}
 		// Updating the Mandelbrot GUI 
 		Mandelbrot::Gui::UpdateGui(window);
 
-		if (sf::Mouse::isButtonPressed(sf::Mouse::Button::Left) && sf::Keyboard::isKeyPressed(sf::Keyboard::LControl))
+		const bool is_clicking = sf::Mouse::isButtonPressed(sf::Mouse::Button::Left) && sf::Keyboard::isKeyPressed(sf::Keyboard::LControl);
+		if (is_clicking && !was_clicking)
 		{
-			auto pos = sf::Mouse::getPosition();
+			auto pos = sf::Mouse::getPosition(window);
+			const sf::Vector2u resolution = Mandelbrot::GetResolution();
 
-			auto offset = Mandelbrot::ScaleToPlane({ static_cast<long double>(pos.x), static_cast<long double>(pos.y) });
-			Mandelbrot::SetOffset(offset);
+			// Moving by a delta keeps the offset precise at deep zoom levels.
+			Mandelbrot::MoveOffset({
+				(static_cast<long double>(pos.x) - resolution.x / 2.0L) * Mandelbrot::GetZoom(),
+				(static_cast<long double>(pos.y) - resolution.y / 2.0L) * Mandelbrot::GetZoom()
+			});
 			Mandelbrot::Update();
 		}
+		was_clicking = is_clicking;
 	}
 
 	return 0;
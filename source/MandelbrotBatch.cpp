@@ -0,0 +1,263 @@
+#include "MandelbrotBatch.hpp"
+
+#include "MandelbrotUtils.hpp"
+#include "Logger.hpp"
+#include "Timer.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Mandelbrot
+{
+	namespace Batch
+	{
+		// Bytes taken by each pixel of a frame: its iterations, its colour, and the published copy of it.
+		// Continuous iteration counts come on top with smooth colouring.
+		static constexpr std::size_t BytesPerPixel = 12;
+		static constexpr std::size_t SmoothBytesPerPixel = 4;
+
+		static std::size_t GetFrameBytes(const Settings& settings, std::size_t width, std::size_t height)
+		{
+			return width * height * (BytesPerPixel + (settings.Smooth ? SmoothBytesPerPixel : 0));
+		}
+
+		static bool HasExtension(const std::string& path, const std::string& extension)
+		{
+			return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+		}
+
+		// Everything the pixels of the image depend on. A render only continues a file made with the same.
+		static std::string GetSignature(const Settings& settings)
+		{
+			return fmt::format("{} {} {} {} {} {} {} {}", settings.CenterX.ToString(), settings.CenterY.ToString(), settings.Zoom,
+				settings.MaxIterations, settings.Width, settings.Height, GetPaletteName(settings.ColorPalette), settings.Smooth);
+		}
+
+		static std::string GetProgressPath(const Settings& settings)
+		{
+			return settings.OutputPath + ".progress";
+		}
+
+		// Rows already written by an interrupted render of the same image, or 0.
+		static std::size_t ReadProgress(const Settings& settings)
+		{
+			std::ifstream progress(GetProgressPath(settings));
+			if (!std::ifstream(settings.OutputPath).good())
+			{
+				return 0;
+			}
+			std::string signature;
+			std::size_t rows = 0;
+			if (!std::getline(progress, signature) || !(progress >> rows) || signature != GetSignature(settings))
+			{
+				return 0;
+			}
+			return std::min(rows, settings.Height);
+		}
+
+		// Written to a temporary file first, so an interruption never leaves a truncated record.
+		static void WriteProgress(const Settings& settings, std::size_t rows)
+		{
+			const std::string path = GetProgressPath(settings);
+			{
+				std::ofstream progress(path + ".tmp", std::ios::trunc);
+				progress << GetSignature(settings) << '\n' << rows << '\n';
+			}
+			std::remove(path.c_str());
+			std::rename((path + ".tmp").c_str(), path.c_str());
+		}
+
+		static void ApplySettings(const Settings& settings, std::size_t threads)
+		{
+			SetMaxThreads(threads);
+			SetZoom(settings.Zoom);
+			SetMaxIterations(settings.MaxIterations);
+			SetPalette(settings.ColorPalette);
+			UseSmoothColoring(settings.Smooth);
+			// Nobody looks at the coarse passes and the sprite is never drawn. Bands never overlap and
+			// the max iterations are never raised, so nothing of a previous frame is worth keeping either:
+			// the previews, resume points and cached tiles would only take memory out of the budget.
+			UseProgressiveRendering(false);
+			UseVertexBuffer(false);
+			UseIncrementalPanning(false);
+			UseZoomReprojection(false);
+			UseResumableIterations(false);
+			UseTileCache(false);
+			UseTracing(!settings.TracePath.empty());
+		}
+
+		static std::size_t GetThreads(const Settings& settings)
+		{
+			return settings.Threads > 0 ? settings.Threads : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+		}
+
+		// Writes `json` to the statistics file of `settings`, if it has one.
+		static bool WriteStats(const Settings& settings, const std::string& json)
+		{
+			if (settings.StatsPath.empty())
+			{
+				return true;
+			}
+			if (!Stats::WriteJson(json, settings.StatsPath))
+			{
+				Logger::GetLogger()->error("Couldn't write the statistics to \"{}\".", settings.StatsPath);
+				return false;
+			}
+			Logger::GetLogger()->info("Statistics written to \"{}\".", settings.StatsPath);
+			return true;
+		}
+
+		// Writes the trace of the frames rendered to the trace file of `settings`, if it has one.
+		static bool SaveTrace(const Settings& settings)
+		{
+			if (settings.TracePath.empty())
+			{
+				return true;
+			}
+			if (!WriteTrace(settings.TracePath))
+			{
+				Logger::GetLogger()->error("Couldn't write the trace to \"{}\".", settings.TracePath);
+				return false;
+			}
+			Logger::GetLogger()->info("Trace written to \"{}\".", settings.TracePath);
+			return true;
+		}
+
+		bool Render(const Settings& settings)
+		{
+			if (HasExtension(settings.OutputPath, ".ppm"))
+			{
+				return RenderBands(settings);
+			}
+			// The encoder takes a copy of the frame.
+			if (GetFrameBytes(settings, settings.Width, settings.Height) + settings.Width * settings.Height * 4 > settings.MemoryBudget)
+			{
+				Logger::GetLogger()->error("A {}x{} image doesn't fit in the memory budget: raise it, or write a .ppm image, which is rendered band by band.", settings.Width, settings.Height);
+				return false;
+			}
+
+			const std::size_t threads = GetThreads(settings);
+			ApplySettings(settings, threads);
+			SetResolution({ static_cast<unsigned int>(settings.Width), static_cast<unsigned int>(settings.Height) });
+			SetPreciseOffset({ settings.CenterX, settings.CenterY });
+
+			Timer timer;
+			timer.start();
+			ProcessMt();
+			timer.stop();
+
+			Logger::GetLogger()->info("Rendered {}x{} on {} threads: {} ms.", settings.Width, settings.Height, threads, timer.elapsedMilliseconds());
+			if (!WriteStats(settings, Stats::ToJson(GetLastFrameStats())) || !SaveTrace(settings))
+			{
+				return false;
+			}
+
+			sf::Image image;
+			static_assert(sizeof(sf::Color) == 4, "`sf::Color` must be laid out as RGBA bytes.");
+			image.create(static_cast<unsigned int>(settings.Width), static_cast<unsigned int>(settings.Height), reinterpret_cast<const sf::Uint8*>(GetFramePixels()));
+			if (!image.saveToFile(settings.OutputPath))
+			{
+				Logger::GetLogger()->error("Couldn't write the image to \"{}\".", settings.OutputPath);
+				return false;
+			}
+			Logger::GetLogger()->info("Image written to \"{}\".", settings.OutputPath);
+			return true;
+		}
+
+		bool RenderBands(const Settings& settings)
+		{
+			// Resolutions are `unsigned int`, like window sizes.
+			if (settings.Width > std::numeric_limits<unsigned int>::max() || settings.Height > std::numeric_limits<unsigned int>::max())
+			{
+				Logger::GetLogger()->error("A {}x{} image is too large.", settings.Width, settings.Height);
+				return false;
+			}
+			const std::size_t row_bytes = GetFrameBytes(settings, settings.Width, 1);
+			const std::size_t band_height = std::clamp<std::size_t>(settings.MemoryBudget / row_bytes, 1, settings.Height);
+
+			// Binary PPM: a text header, then RGB rows top to bottom, so any row can be written in place.
+			const std::string header = fmt::format("P6\n{} {}\n255\n", settings.Width, settings.Height);
+			std::size_t done = ReadProgress(settings);
+			if (done == 0)
+			{
+				std::ofstream create(settings.OutputPath, std::ios::binary | std::ios::trunc);
+				create << header;
+			}
+			std::fstream file(settings.OutputPath, std::ios::binary | std::ios::in | std::ios::out);
+			if (!file)
+			{
+				Logger::GetLogger()->error("Couldn't open \"{}\".", settings.OutputPath);
+				return false;
+			}
+			if (done > 0)
+			{
+				Logger::GetLogger()->info("Continuing \"{}\" from row {}.", settings.OutputPath, done);
+			}
+
+			const std::size_t threads = GetThreads(settings);
+			ApplySettings(settings, threads);
+			Logger::GetLogger()->info("Rendering {}x{} on {} threads, in bands of {} rows.", settings.Width, settings.Height, threads, band_height);
+
+			std::vector<char> row(settings.Width * 3);
+			const std::size_t first_row = done;
+			std::string stats;
+
+			Timer timer;
+			timer.start();
+			while (done < settings.Height)
+			{
+				const std::size_t height = std::min(band_height, settings.Height - done);
+				SetResolution({ static_cast<unsigned int>(settings.Width), static_cast<unsigned int>(height) });
+
+				// The band is a frame of its own, centered on its part of the image.
+				SetPreciseOffset({ settings.CenterX, settings.CenterY });
+				MoveOffset({ 0.0L, (static_cast<long double>(done) + height / 2.0L - settings.Height / 2.0L) * settings.Zoom });
+				ProcessMt();
+				if (!settings.StatsPath.empty())
+				{
+					stats += (stats.empty() ? "[\n" : ",\n") + Stats::ToJson(GetLastFrameStats());
+				}
+
+				const sf::Color* pixels = GetFramePixels();
+				file.seekp(static_cast<std::streamoff>(header.size() + done * row.size()));
+				for (std::size_t y = 0; y < height; y++)
+				{
+					for (std::size_t x = 0; x < settings.Width; x++)
+					{
+						const sf::Color& color = pixels[y * settings.Width + x];
+						row[x * 3] = static_cast<char>(color.r);
+						row[x * 3 + 1] = static_cast<char>(color.g);
+						row[x * 3 + 2] = static_cast<char>(color.b);
+					}
+					file.write(row.data(), static_cast<std::streamsize>(row.size()));
+				}
+				file.flush();
+				if (!file)
+				{
+					Logger::GetLogger()->error("Couldn't write to \"{}\".", settings.OutputPath);
+					return false;
+				}
+
+				// Only recorded once the rows are in the file.
+				done += height;
+				WriteProgress(settings, done);
+
+				const double elapsed = timer.elapsedSeconds();
+				const double remaining = elapsed / static_cast<double>(done - first_row) * static_cast<double>(settings.Height - done);
+				Logger::GetLogger()->info("{}/{} rows ({:.1f}%), {:.0f} s elapsed, ETA {:.0f} s.", done, settings.Height, 100.0 * static_cast<double>(done) / static_cast<double>(settings.Height), elapsed, remaining);
+			}
+
+			std::remove(GetProgressPath(settings).c_str());
+			Logger::GetLogger()->info("Image written to \"{}\".", settings.OutputPath);
+			return WriteStats(settings, stats.empty() ? "[]" : stats + "\n]") && SaveTrace(settings);
+		}
+	}
+}
@@ -0,0 +1,329 @@
+#include "MandelbrotUtils.hpp"
+#include "MandelbrotKernel.hpp"
+#include "Logger.hpp"
+
+#include <docopt/docopt.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr const char* Usage = R"(Mandelbrot benchmark.
+
+Usage:
+  mandelbrot_bench [options]
+  mandelbrot_bench (-h | --help)
+
+Renders fixed views with every instruction set, precision and scheduler the machine supports,
+without opening a window, and writes the throughput of each configuration as JSON.
+
+Options:
+  -h --help            Show this screen.
+  --output=<path>      JSON file, or - for the standard output [default: -].
+  --view=<name>        Only this view: default, seahorse-valley, nice-zoom or interior.
+  --width=<pixels>     Width of the frames [default: 1280].
+  --height=<pixels>    Height of the frames [default: 720].
+  --threads=<n>        Workers of the multi-threaded schedulers, 0 for every hardware thread [default: 0].
+  --repeat=<n>         Timed frames per configuration, after an untimed one [default: 5].
+)";
+
+struct BenchView
+{
+	const char* Name;
+	const char* CenterX;
+	const char* CenterY;
+	long double Zoom;
+	std::size_t MaxIterations;
+};
+
+static const BenchView Views[] = {
+	// The view the program starts with.
+	{ "default", "-0.7", "0", 0.004L, 1000 },
+	{ "seahorse-valley", "-0.7453", "0.1127", 1e-5L, 2000 },
+	// The "Nice Zoom" of `main`, magnified 3.9041710026e+06 times from the default view.
+	{ "nice-zoom", "-0.6140625273462111", "-0.40633146872742876", 0.004L / 3.9041710026e+06L, 5000 },
+	// Inside the period-3 bulb: every pixel reaches the limit, unless periodicity detection stops it.
+	// The main cardioid would only time the closed form interior test.
+	{ "interior", "-0.1225611668766536", "0.7448617666197442", 3e-5L, 1000 },
+};
+
+struct BenchScheduler
+{
+	const char* Name;
+	bool MultiThreaded;
+	bool Progressive;
+	bool Subdivision;
+};
+
+static const BenchScheduler Schedulers[] = {
+	{ "single", false, false, false },
+	{ "tiled", true, false, false },
+	{ "progressive", true, true, false },
+	{ "subdivision", true, false, true },
+};
+
+static const Mandelbrot::Precision Precisions[] = {
+	Mandelbrot::Precision::Float,
+	Mandelbrot::Precision::Double,
+	Mandelbrot::Precision::LongDouble,
+	Mandelbrot::Precision::Perturbation,
+};
+
+static const Mandelbrot::Kernel::InstructionSet InstructionSets[] = {
+	Mandelbrot::Kernel::InstructionSet::Scalar,
+	Mandelbrot::Kernel::InstructionSet::Sse2,
+	Mandelbrot::Kernel::InstructionSet::Avx2,
+	Mandelbrot::Kernel::InstructionSet::Avx512,
+};
+
+struct BenchResult
+{
+	std::string View;
+	std::string InstructionSet;
+	std::string FramePrecision;
+	std::string Scheduler;
+	std::size_t Threads = 0;
+	std::vector<double> FrameMilliseconds;
+	// Iterations the kernels ran per frame, see `Stats::FrameStats::ExecutedIterations`.
+	std::uint64_t Iterations = 0;
+	// Mean over the frames, per worker.
+	std::vector<double> Utilization;
+};
+
+static double GetMean(const std::vector<double>& values)
+{
+	double sum = 0.0;
+	for (const double value : values)
+	{
+		sum += value;
+	}
+	return values.empty() ? 0.0 : sum / static_cast<double>(values.size());
+}
+
+static double GetVariance(const std::vector<double>& values)
+{
+	const double mean = GetMean(values);
+	double sum = 0.0;
+	for (const double value : values)
+	{
+		sum += (value - mean) * (value - mean);
+	}
+	return values.empty() ? 0.0 : sum / static_cast<double>(values.size());
+}
+
+static std::string GetCompilerName()
+{
+#if defined(__clang__)
+	return fmt::format("clang {}.{}.{}", __clang_major__, __clang_minor__, __clang_patchlevel__);
+#elif defined(__GNUC__)
+	return fmt::format("gcc {}.{}.{}", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
+#elif defined(_MSC_VER)
+	return fmt::format("msvc {}", _MSC_VER);
+#else
+	return "unknown";
+#endif
+}
+
+static void RenderFrame(const BenchScheduler& scheduler)
+{
+	if (scheduler.MultiThreaded)
+	{
+		Mandelbrot::ProcessMt();
+	}
+	else
+	{
+		Mandelbrot::ProcessSt();
+	}
+}
+
+// Renders the current view `repeat` times from scratch, after an untimed frame which computes
+// the reference orbit and allocates the buffers.
+static BenchResult Measure(const BenchScheduler& scheduler, std::size_t threads, std::size_t repeat)
+{
+	BenchResult result;
+	result.Scheduler = scheduler.Name;
+	result.Threads = scheduler.MultiThreaded ? threads : 1;
+	result.Utilization.assign(result.Threads, 0.0);
+
+	Mandelbrot::DiscardRetainedFrame();
+	RenderFrame(scheduler);
+
+	for (std::size_t r = 0; r < repeat; r++)
+	{
+		Mandelbrot::DiscardRetainedFrame();
+		const auto start = std::chrono::steady_clock::now();
+		RenderFrame(scheduler);
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		result.FrameMilliseconds.push_back(elapsed.count());
+
+		// Every frame runs the same iterations.
+		result.Iterations = Mandelbrot::GetLastFrameStats().ExecutedIterations;
+
+		const std::vector<double> utilization = Mandelbrot::GetWorkerUtilization();
+		for (std::size_t w = 0; w < result.Threads && w < utilization.size(); w++)
+		{
+			result.Utilization[w] += utilization[w] / static_cast<double>(repeat);
+		}
+	}
+	return result;
+}
+
+static std::string FormatValues(const std::vector<double>& values)
+{
+	std::string text = "[";
+	for (std::size_t i = 0; i < values.size(); i++)
+	{
+		text += fmt::format("{}{:.4f}", i > 0 ? ", " : "", values[i]);
+	}
+	return text + "]";
+}
+
+static std::string FormatResult(const BenchResult& result, std::size_t pixels)
+{
+	const double mean = GetMean(result.FrameMilliseconds);
+	const double seconds = mean / 1000.0;
+	return fmt::format(
+		"    {{\"view\": \"{}\", \"kernel\": \"{}\", \"precision\": \"{}\", \"scheduler\": \"{}\", \"threads\": {},\n"
+		"     \"frame_ms\": {{\"mean\": {:.4f}, \"min\": {:.4f}, \"max\": {:.4f}, \"variance\": {:.6f}}},\n"
+		"     \"mpixels_per_s\": {:.4f}, \"giterations_per_s\": {:.4f}, \"iterations\": {},\n"
+		"     \"thread_utilization\": {}, \"utilization_mean\": {:.4f}, \"utilization_variance\": {:.6f}}}",
+		result.View, result.InstructionSet, result.FramePrecision, result.Scheduler, result.Threads,
+		mean, *std::min_element(result.FrameMilliseconds.begin(), result.FrameMilliseconds.end()),
+		*std::max_element(result.FrameMilliseconds.begin(), result.FrameMilliseconds.end()), GetVariance(result.FrameMilliseconds),
+		static_cast<double>(pixels) / seconds / 1e6, static_cast<double>(result.Iterations) / seconds / 1e9, result.Iterations,
+		FormatValues(result.Utilization), GetMean(result.Utilization), GetVariance(result.Utilization));
+}
+
+int main(int argc, const char** argv)
+{
+	std::map<std::string, docopt::value> args = docopt::docopt(Usage, { argv + 1, argv + argc }, true);
+
+	// The JSON may go to the standard output, so the log goes to stderr. Per frame traces would swamp it.
+	Logger::Init("MANDELBROT_BENCH", true);
+	Logger::SetLoggerLevel(spdlog::level::info);
+
+	std::size_t width = 0;
+	std::size_t height = 0;
+	std::size_t threads = 0;
+	std::size_t repeat = 0;
+	try
+	{
+		width = std::stoull(args["--width"].asString());
+		height = std::stoull(args["--height"].asString());
+		threads = std::stoull(args["--threads"].asString());
+		repeat = std::stoull(args["--repeat"].asString());
+	}
+	catch (const std::exception&)
+	{
+		Logger::GetLogger()->error("Invalid numeric option.\n{}", Usage);
+		return 1;
+	}
+	if (width == 0 || height == 0 || repeat == 0)
+	{
+		Logger::GetLogger()->error("The frame size and the repeat count must be positive.");
+		return 1;
+	}
+	const std::string only_view = args["--view"] ? args["--view"].asString() : std::string();
+	threads = threads > 0 ? threads : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+	Mandelbrot::Init();
+	Mandelbrot::SetMaxThreads(threads);
+	Mandelbrot::SetResolution({ static_cast<unsigned int>(width), static_cast<unsigned int>(height) });
+	// Every frame is computed from scratch: nothing of the previous one may be reused.
+	Mandelbrot::UseVertexBuffer(false);
+	Mandelbrot::UseIncrementalPanning(false);
+	Mandelbrot::UseZoomReprojection(false);
+	Mandelbrot::UseResumableIterations(false);
+	Mandelbrot::UseTileCache(false);
+
+	const Mandelbrot::Kernel::InstructionSet detected = Mandelbrot::Kernel::DetectInstructionSet();
+	std::vector<BenchResult> results;
+
+	for (const BenchView& view : Views)
+	{
+		if (!only_view.empty() && only_view != view.Name)
+		{
+			continue;
+		}
+		Mandelbrot::SetPreciseOffset({ Mandelbrot::HighPrecision::FromString(view.CenterX), Mandelbrot::HighPrecision::FromString(view.CenterY) });
+		Mandelbrot::SetZoom(view.Zoom);
+		Mandelbrot::SetMaxIterations(view.MaxIterations);
+
+		for (const Mandelbrot::Precision precision : Precisions)
+		{
+			// Views needing more precision than this one are skipped.
+			Mandelbrot::SetMinimumPrecision(precision);
+			if (Mandelbrot::GetRequiredPrecision() != precision)
+			{
+				continue;
+			}
+
+			// Only `float` and `double` have SIMD kernels, the others would time the same code again.
+			const bool vectorized = precision == Mandelbrot::Precision::Float || precision == Mandelbrot::Precision::Double;
+			for (const Mandelbrot::Kernel::InstructionSet instruction_set : InstructionSets)
+			{
+				if (vectorized ? instruction_set > detected : instruction_set != Mandelbrot::Kernel::InstructionSet::Scalar)
+				{
+					continue;
+				}
+				Mandelbrot::Kernel::SetInstructionSet(vectorized ? instruction_set : detected);
+
+				for (const BenchScheduler& scheduler : Schedulers)
+				{
+					Mandelbrot::UseProgressiveRendering(scheduler.Progressive);
+					Mandelbrot::UseSubdivision(scheduler.Subdivision);
+
+					BenchResult result = Measure(scheduler, threads, repeat);
+					result.View = view.Name;
+					result.InstructionSet = Mandelbrot::Kernel::GetInstructionSetName(instruction_set);
+					result.FramePrecision = Mandelbrot::GetPrecisionName(Mandelbrot::GetFramePrecision());
+					Logger::GetLogger()->info("{} / {} / {} / {}: {:.2f} ms.", result.View, result.InstructionSet, result.FramePrecision, result.Scheduler, GetMean(result.FrameMilliseconds));
+					results.push_back(std::move(result));
+				}
+			}
+		}
+	}
+	Mandelbrot::SetMinimumPrecision(Mandelbrot::Precision::Float);
+	Mandelbrot::Kernel::SetInstructionSet(detected);
+
+	std::string json = fmt::format(
+		"{{\n  \"build\": {{\"compiler\": \"{}\", \"debug\": {}}},\n"
+		"  \"machine\": {{\"instruction_set\": \"{}\", \"hardware_threads\": {}}},\n"
+		"  \"settings\": {{\"width\": {}, \"height\": {}, \"threads\": {}, \"repeat\": {}}},\n"
+		"  \"results\": [\n",
+#ifdef NDEBUG
+		GetCompilerName(), "false",
+#else
+		GetCompilerName(), "true",
+#endif
+		Mandelbrot::Kernel::GetInstructionSetName(detected), std::thread::hardware_concurrency(), width, height, threads, repeat);
+	for (std::size_t i = 0; i < results.size(); i++)
+	{
+		json += FormatResult(results[i], width * height) + (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	json += "  ]\n}\n";
+
+	const std::string output = args["--output"].asString();
+	if (output == "-")
+	{
+		std::cout << json;
+		return 0;
+	}
+	std::ofstream file(output, std::ios::trunc);
+	file << json;
+	if (!file)
+	{
+		Logger::GetLogger()->error("Couldn't write \"{}\".", output);
+		return 1;
+	}
+	Logger::GetLogger()->info("Results written to \"{}\".", output);
+	return 0;
+}
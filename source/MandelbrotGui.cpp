@@ -1,51 +1,152 @@
 #include "MandelbrotGui.hpp"
 
-#include "Config.hpp"
 #include "Button.hpp"
 #include "MandelbrotUtils.hpp"
+#include "MandelbrotTrace.hpp"
 #include "Logger.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
 namespace Mandelbrot
 {
 	namespace Gui
 	{
 		struct MandelbrotGuiInternalData
 		{
-			static inline sf::RectangleShape ImaginaryAxis = sf::RectangleShape({ 1.f , Mandelbrot::Config::WINDOW_HEIGHT });
-			static inline sf::RectangleShape RealAxis = sf::RectangleShape({ Mandelbrot::Config::WINDOW_WIDTH , 1.f });
+			// Laid out by `ResizeGui`, as are the buttons and the statistics overlay.
+			static inline sf::RectangleShape ImaginaryAxis = sf::RectangleShape();
+			static inline sf::RectangleShape RealAxis = sf::RectangleShape();
 
 			static inline Mandelbrot::Gui::Button ZoomInButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "ZOOM-IN");
-			static inline Mandelbrot::Gui::Button ZoomOutButton = Mandelbrot::Gui::Button({ 100, 25 }, { 100, 0 }, "ZOOM-OUT");
-
-			static inline Mandelbrot::Gui::Button OffsetXPlusButton = Mandelbrot::Gui::Button({ 100, 25 }, { 200, 0 }, "OFFX+");
-			static inline Mandelbrot::Gui::Button OffsetXMinusButton = Mandelbrot::Gui::Button({ 100, 25 }, { 300, 0 }, "OFFX-");
+			static inline Mandelbrot::Gui::Button ZoomOutButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "ZOOM-OUT");
+
+			static inline Mandelbrot::Gui::Button OffsetXPlusButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "OFFX+");
+			static inline Mandelbrot::Gui::Button OffsetXMinusButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "OFFX-");
+
+			static inline Mandelbrot::Gui::Button OffsetYPlusButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "OFFY+");
+			static inline Mandelbrot::Gui::Button OffsetYMinusButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "OFFY-");
+
+			static inline Mandelbrot::Gui::Button IterationsPlusButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "ITER+");
+			static inline Mandelbrot::Gui::Button IterationsMinusButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "ITER-");
+
+			static inline Mandelbrot::Gui::Button ToggleVertexBufferButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "TOGGLE VB");
+			static inline Mandelbrot::Gui::Button ToggleSubdivisionButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "SUBDIVIDE");
+			static inline Mandelbrot::Gui::Button ToggleProgressiveButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "PROGRESSIVE");
+
+			// Colouring buttons only recolour the last frame.
+			static inline Mandelbrot::Gui::Button PaletteButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "PALETTE");
+			static inline Mandelbrot::Gui::Button ColorCycleButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "CYCLE");
+			static inline Mandelbrot::Gui::Button ToggleSmoothButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "SMOOTH");
+			static inline Mandelbrot::Gui::Button ToggleHistogramButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "EQUALIZE");
+
+			// Overlay of the statistics of the last frame, see `Mandelbrot::GetLastFrameStats`.
+			static inline Mandelbrot::Gui::Button ToggleStatsButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "STATS");
+			static inline bool ShowingStats = false;
+			static inline sf::Font StatsFont = sf::Font();
+			static inline sf::Text StatsText = sf::Text();
+			static inline sf::RectangleShape StatsBackground = sf::RectangleShape();
+			// The text is only laid out again this often, so the overlay costs nothing noticeable.
+			static inline sf::Clock StatsClock = sf::Clock();
+			static constexpr float StatsRefreshSeconds = 0.25f;
+			// Where the J key writes the statistics of the last frame.
+			static inline const std::string StatsPath = "mandelbrot-stats.json";
+			static inline bool WasDumpingStats = false;
+
+			// Starts tracing, then writes the trace once clicked again, see `Mandelbrot::WriteTrace`.
+			static inline Mandelbrot::Gui::Button ToggleTraceButton = Mandelbrot::Gui::Button({ 100, 25 }, { 0, 0 }, "TRACE");
+			static inline const std::string TracePath = "mandelbrot-trace.json";
 
-			static inline Mandelbrot::Gui::Button OffsetYPlusButton = Mandelbrot::Gui::Button({ 100, 25 }, { 400, 0 }, "OFFY+");
-			static inline Mandelbrot::Gui::Button OffsetYMinusButton = Mandelbrot::Gui::Button({ 100, 25 }, { 500, 0 }, "OFFY-");
+			static inline bool ShouldUpdateProcess = false;
 
-			static inline Mandelbrot::Gui::Button IterationsPlusButton = Mandelbrot::Gui::Button({ 100, 25 }, { 600, 0 }, "ITER+");
-			static inline Mandelbrot::Gui::Button IterationsMinusButton = Mandelbrot::Gui::Button({ 100, 25 }, { 700, 0 }, "ITER-");
+			static inline bool HiddenGui = false;
 
-			static inline Mandelbrot::Gui::Button ToggleVertexBufferButton = Mandelbrot::Gui::Button({ 100, 25 }, { 800, 0 }, "TOGGLE VB");
+			// Distance moved by the offset buttons, rounded to whole pixels of the current zoom when it spans one at least.
+			static constexpr long double OffsetStep = 0.0008L;
 
-			static inline bool ShouldUpdateProcess = false;
+			// Palette entries each click of the cycle button shifts the colours by.
+			static constexpr std::size_t ColorCycleStep = 4;
 
-			static inline bool HiddenGui = false;
+			// Zoom of the zoom buttons while Shift is held. With zoom reprojection, powers of two keep a quarter of the previous frame.
+			static constexpr long double PowerOfTwoZoomIn = 0.5L;
+			static constexpr long double PowerOfTwoZoomOut = 2.0L;
 		};
 
+		// Moves the offset by `steps` offset steps. Whole pixel moves let the previous frame be reused, steps
+		// under a pixel are kept as they are and render the whole frame.
+		static void MoveOffsetSteps(long double steps_x, long double steps_y)
+		{
+			const long double zoom = Mandelbrot::GetZoom();
+			const long double pixels = MandelbrotGuiInternalData::OffsetStep / zoom;
+			const long double step = (pixels >= 1.0L ? std::round(pixels) : pixels) * zoom;
+			Mandelbrot::MoveOffset({ steps_x * step, steps_y * step });
+		}
+
 
 		void InitGui()
 		{
-			MandelbrotGuiInternalData::RealAxis.setPosition({ 0, Mandelbrot::Config::WINDOW_HEIGHT / 2.f });
-			MandelbrotGuiInternalData::ImaginaryAxis.setPosition({ Mandelbrot::Config::WINDOW_WIDTH / 2.f,  0 });
+			ResizeGui();
 
 			MandelbrotGuiInternalData::RealAxis.setFillColor(sf::Color(255, 255, 255, 100));
 			MandelbrotGuiInternalData::ImaginaryAxis.setFillColor(sf::Color(255, 255, 100));
+			Mandelbrot::Trace::SetThreadName("gui");
+
+			MandelbrotGuiInternalData::StatsFont.loadFromFile("./assets/fonts/Roboto-Regular.ttf");
+			MandelbrotGuiInternalData::StatsText.setFont(MandelbrotGuiInternalData::StatsFont);
+			MandelbrotGuiInternalData::StatsText.setCharacterSize(13);
+			MandelbrotGuiInternalData::StatsBackground.setFillColor(sf::Color(0, 0, 0, 180));
+		}
+
+		void ResizeGui()
+		{
+			const sf::Vector2f size = static_cast<sf::Vector2f>(Mandelbrot::GetResolution());
+
+			MandelbrotGuiInternalData::RealAxis.setSize({ size.x, 1.f });
+			MandelbrotGuiInternalData::RealAxis.setPosition({ 0, size.y / 2.f });
+			MandelbrotGuiInternalData::ImaginaryAxis.setSize({ 1.f, size.y });
+			MandelbrotGuiInternalData::ImaginaryAxis.setPosition({ size.x / 2.f, 0 });
+
+			// Rows of buttons, each one wrapped onto as many lines as the width needs.
+			using Data = MandelbrotGuiInternalData;
+			const std::vector<std::vector<Button*>> rows = {
+				{ &Data::ZoomInButton, &Data::ZoomOutButton, &Data::OffsetXPlusButton, &Data::OffsetXMinusButton, &Data::OffsetYPlusButton, &Data::OffsetYMinusButton,
+					&Data::IterationsPlusButton, &Data::IterationsMinusButton, &Data::ToggleVertexBufferButton, &Data::ToggleSubdivisionButton, &Data::ToggleProgressiveButton },
+				{ &Data::PaletteButton, &Data::ColorCycleButton, &Data::ToggleSmoothButton, &Data::ToggleHistogramButton, &Data::ToggleStatsButton, &Data::ToggleTraceButton }
+			};
+			sf::Vector2f position = { 0.f, 0.f };
+			for (const std::vector<Button*>& row : rows)
+			{
+				position.x = 0.f;
+				float height = 0.f;
+				for (Button* button : row)
+				{
+					const sf::Vector2f button_size = button->GetSize();
+					if (position.x > 0.f && position.x + button_size.x > size.x)
+					{
+						position = { 0.f, position.y + height };
+						height = 0.f;
+					}
+					button->SetPosition(position);
+					position.x += button_size.x;
+					height = std::max(height, button_size.y);
+				}
+				position.y += height;
+			}
+
+			// The overlay goes under the buttons.
+			Data::StatsBackground.setPosition({ 0.f, position.y });
+			Data::StatsText.setPosition({ 5.f, position.y + 5.f });
 		}
 
 
 		void UpdateGui(sf::RenderWindow& window)
 		{
+			// Traced when the update submits a render, along with the generation the render is tagged with.
+			const auto update_start = std::chrono::steady_clock::now();
+
 #pragma omp parallel for
 			{
 				MandelbrotGuiInternalData::ZoomInButton.Update(window);
@@ -61,75 +162,61 @@ namespace Mandelbrot
 				MandelbrotGuiInternalData::IterationsMinusButton.Update(window);
 
 				MandelbrotGuiInternalData::ToggleVertexBufferButton.Update(window);
+				MandelbrotGuiInternalData::ToggleSubdivisionButton.Update(window);
+				MandelbrotGuiInternalData::ToggleProgressiveButton.Update(window);
+
+				MandelbrotGuiInternalData::PaletteButton.Update(window);
+				MandelbrotGuiInternalData::ColorCycleButton.Update(window);
+				MandelbrotGuiInternalData::ToggleSmoothButton.Update(window);
+				MandelbrotGuiInternalData::ToggleHistogramButton.Update(window);
+				MandelbrotGuiInternalData::ToggleStatsButton.Update(window);
+				MandelbrotGuiInternalData::ToggleTraceButton.Update(window);
 			}
 
 			// TODO Code below MUST be cleaned up. Either move button events on a function or create a `OnButtonPress` method inside the button class.
-			if (MandelbrotGuiInternalData::OffsetXPlusButton.GetCurrentState() == Mandelbrot::Gui::Button::ButtonState::Pressed)
+			if (MandelbrotGuiInternalData::OffsetXPlusButton.WasClicked())
 			{
-				auto offset = Mandelbrot::GetOffset();
-				Mandelbrot::SetOffset(
-					{
-						offset.x + 0.0008,
-						offset.y
-					}
-				);
+				MoveOffsetSteps(1.0L, 0.0L);
 				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
 			}
-			else if (MandelbrotGuiInternalData::OffsetXMinusButton.GetCurrentState() == Mandelbrot::Gui::Button::ButtonState::Pressed)
+			else if (MandelbrotGuiInternalData::OffsetXMinusButton.WasClicked())
 			{
-				auto offset = Mandelbrot::GetOffset();
-				Mandelbrot::SetOffset(
-					{
-						offset.x - 0.0008,
-						offset.y
-					}
-				);
+				MoveOffsetSteps(-1.0L, 0.0L);
 				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
 			}
 
-			if (MandelbrotGuiInternalData::OffsetYPlusButton.GetCurrentState() == Mandelbrot::Gui::Button::ButtonState::Pressed)
+			if (MandelbrotGuiInternalData::OffsetYPlusButton.WasClicked())
 			{
-				auto offset = Mandelbrot::GetOffset();
-				Mandelbrot::SetOffset(
-					{
-						offset.x,
-						offset.y + 0.0008
-					}
-				);
+				MoveOffsetSteps(0.0L, 1.0L);
 				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
 			}
-			else if (MandelbrotGuiInternalData::OffsetYMinusButton.GetCurrentState() == Mandelbrot::Gui::Button::ButtonState::Pressed)
+			else if (MandelbrotGuiInternalData::OffsetYMinusButton.WasClicked())
 			{
-				auto offset = Mandelbrot::GetOffset();
-				Mandelbrot::SetOffset(
-					{
-						offset.x,
-						offset.y - 0.0008
-					}
-				);
+				MoveOffsetSteps(0.0L, -1.0L);
 				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
 			}
 
-			if (MandelbrotGuiInternalData::ZoomInButton.GetCurrentState() == Mandelbrot::Gui::Button::ButtonState::Pressed)
+			const bool power_of_two_zoom = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LShift) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::RShift);
+			if (MandelbrotGuiInternalData::ZoomInButton.WasClicked())
 			{
 				auto lzoom = Mandelbrot::GetZoom();
-				Mandelbrot::SetZoom(lzoom * 0.7);
+				Mandelbrot::SetZoom(lzoom * (power_of_two_zoom ? MandelbrotGuiInternalData::PowerOfTwoZoomIn : 0.7));
 				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
 			}
-			else if (MandelbrotGuiInternalData::ZoomOutButton.GetCurrentState() == Mandelbrot::Gui::Button::ButtonState::Pressed)
+			else if (MandelbrotGuiInternalData::ZoomOutButton.WasClicked())
 			{
 				auto lzoom = Mandelbrot::GetZoom();
-				Mandelbrot::SetZoom(lzoom * 7);
+				Mandelbrot::SetZoom(lzoom * (power_of_two_zoom ? MandelbrotGuiInternalData::PowerOfTwoZoomOut : 7));
 				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
 			}
 
-			if (MandelbrotGuiInternalData::IterationsPlusButton.GetCurrentState() == Mandelbrot::Gui::Button::ButtonState::Pressed)
+			if (MandelbrotGuiInternalData::IterationsPlusButton.WasClicked())
 			{
 				auto iters = Mandelbrot::GetMaxIterations();
 				Mandelbrot::SetMaxIterations(iters + 1000);
 				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
 			}
-			else if (MandelbrotGuiInternalData::IterationsMinusButton.GetCurrentState() == Mandelbrot::Gui::Button::ButtonState::Pressed)
+			else if (MandelbrotGuiInternalData::IterationsMinusButton.WasClicked())
 			{
 				auto iters = Mandelbrot::GetMaxIterations();
 				if (iters != 1000)
@@ -139,7 +226,7 @@ namespace Mandelbrot
 				}
 			}
 
-			if (MandelbrotGuiInternalData::ToggleVertexBufferButton.GetCurrentState() == Mandelbrot::Gui::Button::ButtonState::Pressed)
+			if (MandelbrotGuiInternalData::ToggleVertexBufferButton.WasClicked())
 			{
 				bool using_vertex_buffer = Mandelbrot::IsUsingVertexBuffer();
 
@@ -153,11 +240,91 @@ namespace Mandelbrot
 				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
 			}
 
+			if (MandelbrotGuiInternalData::ToggleSubdivisionButton.WasClicked())
+			{
+				Mandelbrot::UseSubdivision(!Mandelbrot::IsUsingSubdivision());
+				Logger::GetLogger()->info("Subdivision set to {}", Mandelbrot::IsUsingSubdivision());
+				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
+			}
+
+			if (MandelbrotGuiInternalData::ToggleProgressiveButton.WasClicked())
+			{
+				Mandelbrot::UseProgressiveRendering(!Mandelbrot::IsUsingProgressiveRendering());
+				Logger::GetLogger()->info("Progressive rendering set to {}", Mandelbrot::IsUsingProgressiveRendering());
+				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
+			}
+
+			if (MandelbrotGuiInternalData::PaletteButton.WasClicked())
+			{
+				const bool classic = Mandelbrot::GetPalette() == Mandelbrot::Palette::Classic;
+				Mandelbrot::SetPalette(classic ? Mandelbrot::Palette::Grayscale : Mandelbrot::Palette::Classic);
+				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
+			}
+
+			if (MandelbrotGuiInternalData::ColorCycleButton.WasClicked())
+			{
+				Mandelbrot::SetColorCycle(Mandelbrot::GetColorCycle() + MandelbrotGuiInternalData::ColorCycleStep);
+				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
+			}
+
+			if (MandelbrotGuiInternalData::ToggleSmoothButton.WasClicked())
+			{
+				Mandelbrot::UseSmoothColoring(!Mandelbrot::IsUsingSmoothColoring());
+				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
+			}
+
+			if (MandelbrotGuiInternalData::ToggleHistogramButton.WasClicked())
+			{
+				Mandelbrot::UseHistogramColoring(!Mandelbrot::IsUsingHistogramColoring());
+				MandelbrotGuiInternalData::ShouldUpdateProcess = true;
+			}
+
+			if (MandelbrotGuiInternalData::ToggleStatsButton.WasClicked())
+			{
+				MandelbrotGuiInternalData::ShowingStats = !MandelbrotGuiInternalData::ShowingStats;
+			}
+
+			// Holding the key only writes the file once.
+			const bool dumping_stats = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::J);
+			if (dumping_stats && !MandelbrotGuiInternalData::WasDumpingStats)
+			{
+				if (Stats::WriteJson(Stats::ToJson(Mandelbrot::GetLastFrameStats()), MandelbrotGuiInternalData::StatsPath))
+				{
+					Logger::GetLogger()->info("Frame statistics written to \"{}\".", MandelbrotGuiInternalData::StatsPath);
+				}
+				else
+				{
+					Logger::GetLogger()->error("Couldn't write \"{}\".", MandelbrotGuiInternalData::StatsPath);
+				}
+			}
+			MandelbrotGuiInternalData::WasDumpingStats = dumping_stats;
+
+			if (MandelbrotGuiInternalData::ToggleTraceButton.WasClicked())
+			{
+				if (!Mandelbrot::IsUsingTracing())
+				{
+					Mandelbrot::UseTracing(true);
+					Logger::GetLogger()->info("Tracing started, click TRACE again to write \"{}\".", MandelbrotGuiInternalData::TracePath);
+				}
+				else
+				{
+					Mandelbrot::UseTracing(false);
+					if (Mandelbrot::WriteTrace(MandelbrotGuiInternalData::TracePath))
+					{
+						Logger::GetLogger()->info("Trace written to \"{}\".", MandelbrotGuiInternalData::TracePath);
+					}
+					else
+					{
+						Logger::GetLogger()->error("Couldn't write \"{}\".", MandelbrotGuiInternalData::TracePath);
+					}
+				}
+			}
+
 			// This will reset Mandelbrot data to default values.
 			if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::R))
 			{
 				Mandelbrot::SetZoom(Mandelbrot::GetDefaultZoom());
-				Mandelbrot::SetOffset(Mandelbrot::GetDefaultOffset());
+				Mandelbrot::SetPreciseOffset(Mandelbrot::GetPreciseDefaultOffset());
 				Mandelbrot::UseVertexBuffer(false);
 				Mandelbrot::SetMaxIterations(Mandelbrot::GetDefaultMaxIterations());
 				Mandelbrot::SetMaxThreads(std::thread::hardware_concurrency());
@@ -167,19 +334,43 @@ namespace Mandelbrot
 			if (MandelbrotGuiInternalData::ShouldUpdateProcess)
 			{
 				Logger::GetLogger()->info("Current Settings:");
-				Logger::GetLogger()->info("\tOffsetX: {:<10}", Mandelbrot::GetOffset().x);
-				Logger::GetLogger()->info("\tOffsetY: {:<10}", Mandelbrot::GetOffset().y);
+				Logger::GetLogger()->info("\tOffsetX: {:<10}", Mandelbrot::GetPreciseOffset().x.ToString());
+				Logger::GetLogger()->info("\tOffsetY: {:<10}", Mandelbrot::GetPreciseOffset().y.ToString());
 				Logger::GetLogger()->info("\tZoom: {:<10}", Mandelbrot::GetZoom());
 				Logger::GetLogger()->info("\tMax Iterations: {:<10}", Mandelbrot::GetMaxIterations());
 				Logger::GetLogger()->info("\tThreads: {:<10}", Mandelbrot::GetMaxThreads());
-
-
-				sf::Thread process_thread(&Mandelbrot::ProcessMt);
-				process_thread.launch();
+				Logger::GetLogger()->info("\tPrecision: {:<10}", Mandelbrot::GetPrecisionName(Mandelbrot::GetRequiredPrecision()));
+				Logger::GetLogger()->info("\tSubdivision: {:<10}", Mandelbrot::IsUsingSubdivision());
+				Logger::GetLogger()->info("\tProgressive: {:<10}", Mandelbrot::IsUsingProgressiveRendering());
+				Logger::GetLogger()->info("\tPalette: {:<10}", Mandelbrot::GetPaletteName(Mandelbrot::GetPalette()));
+				Logger::GetLogger()->info("\tColor Cycle: {:<10}", Mandelbrot::GetColorCycle());
+				Logger::GetLogger()->info("\tSmooth: {:<10}", Mandelbrot::IsUsingSmoothColoring());
+				Logger::GetLogger()->info("\tEqualized: {:<10}", Mandelbrot::IsUsingHistogramColoring());
+
+
+				// The frame is rendered in the background: the input loop never waits for it, and a
+				// newer frame cancels the one still rendering.
+				const RenderJob job = Mandelbrot::ForceUpdate();
+				Trace::Record("UpdateGui", "gui", update_start, std::chrono::steady_clock::now(), { { "generation", job.GetGeneration() } });
 				MandelbrotGuiInternalData::ShouldUpdateProcess = false;
 			}
 		}
 
+		// Lays the text out again from the last frame once it is old enough, on the drawing thread.
+		static void DrawStats(sf::RenderWindow& window)
+		{
+			auto& text = MandelbrotGuiInternalData::StatsText;
+			if (text.getString().isEmpty() || MandelbrotGuiInternalData::StatsClock.getElapsedTime().asSeconds() >= MandelbrotGuiInternalData::StatsRefreshSeconds)
+			{
+				text.setString(Stats::ToText(Mandelbrot::GetLastFrameStats()));
+				const sf::FloatRect bounds = text.getLocalBounds();
+				MandelbrotGuiInternalData::StatsBackground.setSize({ bounds.left + bounds.width + 10.f, bounds.top + bounds.height + 10.f });
+				MandelbrotGuiInternalData::StatsClock.restart();
+			}
+			window.draw(MandelbrotGuiInternalData::StatsBackground);
+			window.draw(text);
+		}
+
 		void DrawGui(sf::RenderWindow& window)
 		{
 			if (!MandelbrotGuiInternalData::HiddenGui)
@@ -195,6 +386,19 @@ namespace Mandelbrot
 				window.draw(MandelbrotGuiInternalData::IterationsPlusButton);
 				window.draw(MandelbrotGuiInternalData::IterationsMinusButton);
 				window.draw(MandelbrotGuiInternalData::ToggleVertexBufferButton);
+				window.draw(MandelbrotGuiInternalData::ToggleSubdivisionButton);
+				window.draw(MandelbrotGuiInternalData::ToggleProgressiveButton);
+				window.draw(MandelbrotGuiInternalData::PaletteButton);
+				window.draw(MandelbrotGuiInternalData::ColorCycleButton);
+				window.draw(MandelbrotGuiInternalData::ToggleSmoothButton);
+				window.draw(MandelbrotGuiInternalData::ToggleHistogramButton);
+				window.draw(MandelbrotGuiInternalData::ToggleStatsButton);
+				window.draw(MandelbrotGuiInternalData::ToggleTraceButton);
+
+				if (MandelbrotGuiInternalData::ShowingStats)
+				{
+					DrawStats(window);
+				}
 			}
 		}
 
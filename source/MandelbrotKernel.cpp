@@ -0,0 +1,350 @@
+#include "MandelbrotKernel.hpp"
+
+#include <cstring>
+
+#if defined(MANDELBROT_ENABLE_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace Mandelbrot
+{
+	namespace Kernel
+	{
+#ifdef MANDELBROT_ENABLE_SIMD
+		// Defined in the per-instruction-set translation units.
+		RowStatistics ComputeRowSse2(const RowSegment<double>& segment);
+		RowStatistics ComputeRowSse2(const RowSegment<float>& segment);
+		RowStatistics ComputeRowAvx2(const RowSegment<double>& segment);
+		RowStatistics ComputeRowAvx2(const RowSegment<float>& segment);
+		RowStatistics ComputeRowAvx512(const RowSegment<double>& segment);
+		RowStatistics ComputeRowAvx512(const RowSegment<float>& segment);
+		RowStatistics ContinuePointsSse2(const ResumeSegment<double>& segment);
+		RowStatistics ContinuePointsSse2(const ResumeSegment<float>& segment);
+		RowStatistics ContinuePointsAvx2(const ResumeSegment<double>& segment);
+		RowStatistics ContinuePointsAvx2(const ResumeSegment<float>& segment);
+		RowStatistics ContinuePointsAvx512(const ResumeSegment<double>& segment);
+		RowStatistics ContinuePointsAvx512(const ResumeSegment<float>& segment);
+		ColorStatistics ColorizeRowAvx2(const ColorSegment& segment);
+		ColorStatistics ColorizeRowAvx512(const ColorSegment& segment);
+#endif
+
+		struct KernelInternalData
+		{
+			static inline const InstructionSet DetectedSet = DetectInstructionSet();
+			static inline InstructionSet ActiveSet = DetectedSet;
+		};
+
+		// Iterates z from `first_iteration` up to `max_iterations` and stores the result at `index`
+		// of the outputs. Same as `IterateLanes`, one pixel at a time.
+		template<typename T>
+		void IteratePoint(T cr, T ci, T zr, T zi, std::size_t first_iteration, std::size_t max_iterations, T period_tolerance,
+			std::size_t index, std::uint32_t* iterations, float* smooth, std::vector<ResumePoint>* resume, RowStatistics& statistics)
+		{
+			const bool check_period = period_tolerance > static_cast<T>(0.0);
+			const T tolerance2 = period_tolerance * period_tolerance;
+
+			T saved_r = zr;
+			T saved_i = zi;
+			std::size_t window = PeriodCheckFirstWindow;
+			std::size_t steps = 0;
+
+			std::size_t iter = first_iteration;
+			T norm2 = static_cast<T>(0.0);
+			bool periodic = false;
+			for (; iter < max_iterations; iter++)
+			{
+				const T r2 = zr * zr;
+				const T i2 = zi * zi;
+				norm2 = r2 + i2;
+				if (norm2 > static_cast<T>(4.0))
+				{
+					break;
+				}
+				zi = static_cast<T>(2.0) * zr * zi + ci;
+				zr = r2 - i2 + cr;
+
+				if (check_period)
+				{
+					steps++;
+					const T dr = zr - saved_r;
+					const T di = zi - saved_i;
+					if (dr * dr + di * di <= tolerance2 && IsAttractingCycle(zr, zi, cr, ci, steps))
+					{
+						statistics.Iterations += iter + 1 - first_iteration;
+						iter = max_iterations;
+						periodic = true;
+						statistics.PeriodicExits++;
+						break;
+					}
+					if (steps == window)
+					{
+						saved_r = zr;
+						saved_i = zi;
+						steps = 0;
+						window *= 2;
+					}
+				}
+			}
+			if (!periodic)
+			{
+				statistics.Iterations += iter - first_iteration;
+			}
+			iterations[index] = static_cast<std::uint32_t>(iter);
+			if (smooth)
+			{
+				smooth[index] = iter < max_iterations ? GetSmoothIterations(static_cast<std::uint32_t>(iter), static_cast<double>(norm2)) : static_cast<float>(iter);
+			}
+			if (resume && iter == max_iterations && !periodic)
+			{
+				resume->push_back({ static_cast<std::uint32_t>(index), 0, static_cast<double>(zr), static_cast<double>(zi) });
+			}
+		}
+
+		template<typename T>
+		RowStatistics ComputeRowScalar(const RowSegment<T>& segment)
+		{
+			RowStatistics statistics;
+
+			for (std::size_t i = 0; i < segment.Count; i++)
+			{
+				const T along = (segment.FirstPixel + static_cast<T>(i)) * segment.Scale + segment.Origin;
+				const T cr = segment.Vertical ? segment.Fixed : along;
+				const T ci = segment.Vertical ? along : segment.Fixed;
+
+				if (IsInMainCardioidOrBulb(cr, ci))
+				{
+					segment.Iterations[i] = static_cast<std::uint32_t>(segment.MaxIterations);
+					if (segment.Smooth)
+					{
+						segment.Smooth[i] = static_cast<float>(segment.MaxIterations);
+					}
+					statistics.InteriorRejected++;
+					continue;
+				}
+
+				IteratePoint(cr, ci, cr, ci, 0, segment.MaxIterations, segment.PeriodTolerance, i, segment.Iterations, segment.Smooth, segment.Resume, statistics);
+			}
+
+			return statistics;
+		}
+
+		template<typename T>
+		RowStatistics ContinuePointsScalar(const ResumeSegment<T>& segment)
+		{
+			RowStatistics statistics;
+
+			for (std::size_t i = 0; i < segment.Count; i++)
+			{
+				const T zr = static_cast<T>(segment.Points[i].Zr);
+				const T zi = static_cast<T>(segment.Points[i].Zi);
+				IteratePoint(segment.Cr[i], segment.Ci[i], zr, zi, segment.StartIteration, segment.MaxIterations, segment.PeriodTolerance, i, segment.Iterations, segment.Smooth, segment.Resume, statistics);
+			}
+
+			return statistics;
+		}
+
+		template<typename T>
+		RowStatistics Dispatch(const RowSegment<T>& segment)
+		{
+			switch (KernelInternalData::ActiveSet)
+			{
+#ifdef MANDELBROT_ENABLE_SIMD
+			case InstructionSet::Avx512:
+				return ComputeRowAvx512(segment);
+			case InstructionSet::Avx2:
+				return ComputeRowAvx2(segment);
+			case InstructionSet::Sse2:
+				return ComputeRowSse2(segment);
+#endif
+			default:
+				return ComputeRowScalar(segment);
+			}
+		}
+
+		RowStatistics ComputeRow(const RowSegment<float>& segment)
+		{
+			return Dispatch(segment);
+		}
+
+		RowStatistics ComputeRow(const RowSegment<double>& segment)
+		{
+			return Dispatch(segment);
+		}
+
+		RowStatistics ComputeRow(const RowSegment<long double>& segment)
+		{
+			return ComputeRowScalar(segment);
+		}
+
+		ColorStatistics ColorizeRowScalar(const ColorSegment& segment)
+		{
+			ColorStatistics statistics;
+			for (std::size_t i = 0; i < segment.Count; i++)
+			{
+				const std::uint32_t iterations = segment.Iterations[i];
+				const std::uint32_t color = GetTableColor(segment, iterations, segment.Smooth ? segment.Smooth[i] : 0.0f);
+				std::memcpy(segment.Colors + i * sizeof(color), &color, sizeof(color));
+				statistics.Iterations += iterations;
+				statistics.Escaped += iterations < segment.MaxIterations ? 1 : 0;
+			}
+			return statistics;
+		}
+
+		ColorStatistics ColorizeRow(const ColorSegment& segment)
+		{
+			switch (KernelInternalData::ActiveSet)
+			{
+#ifdef MANDELBROT_ENABLE_SIMD
+			case InstructionSet::Avx512:
+				return ColorizeRowAvx512(segment);
+			case InstructionSet::Avx2:
+				return ColorizeRowAvx2(segment);
+#endif
+			// SSE2 has no gather: one lookup per pixel is as fast as it gets there.
+			default:
+				return ColorizeRowScalar(segment);
+			}
+		}
+
+		template<typename T>
+		RowStatistics DispatchContinue(const ResumeSegment<T>& segment)
+		{
+			switch (KernelInternalData::ActiveSet)
+			{
+#ifdef MANDELBROT_ENABLE_SIMD
+			case InstructionSet::Avx512:
+				return ContinuePointsAvx512(segment);
+			case InstructionSet::Avx2:
+				return ContinuePointsAvx2(segment);
+			case InstructionSet::Sse2:
+				return ContinuePointsSse2(segment);
+#endif
+			default:
+				return ContinuePointsScalar(segment);
+			}
+		}
+
+		RowStatistics ContinuePoints(const ResumeSegment<float>& segment)
+		{
+			return DispatchContinue(segment);
+		}
+
+		RowStatistics ContinuePoints(const ResumeSegment<double>& segment)
+		{
+			return DispatchContinue(segment);
+		}
+
+		void AppendResumePoints(std::vector<ResumePoint>& resume, const ResumePoint* points, std::size_t count)
+		{
+			resume.insert(resume.end(), points, points + count);
+		}
+
+		InstructionSet DetectInstructionSet()
+		{
+#ifdef MANDELBROT_ENABLE_SIMD
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			const int max_leaf = info[0];
+
+			__cpuid(info, 1);
+			const bool has_sse2 = (info[3] & (1 << 26)) != 0;
+			const bool has_osxsave = (info[2] & (1 << 27)) != 0;
+
+			// The OS must save the YMM/ZMM registers on context switches.
+			const unsigned long long xcr0 = has_osxsave ? _xgetbv(0) : 0;
+			const bool os_ymm = (xcr0 & 0x6) == 0x6;
+			const bool os_zmm = (xcr0 & 0xe6) == 0xe6;
+
+			bool has_avx2 = false;
+			bool has_avx512 = false;
+			if (max_leaf >= 7)
+			{
+				__cpuidex(info, 7, 0);
+				has_avx2 = (info[1] & (1 << 5)) != 0;
+				has_avx512 = (info[1] & (1 << 16)) != 0;
+			}
+
+			if (has_avx512 && os_zmm)
+			{
+				return InstructionSet::Avx512;
+			}
+			if (has_avx2 && os_ymm)
+			{
+				return InstructionSet::Avx2;
+			}
+			if (has_sse2)
+			{
+				return InstructionSet::Sse2;
+			}
+#else
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f"))
+			{
+				return InstructionSet::Avx512;
+			}
+			if (__builtin_cpu_supports("avx2"))
+			{
+				return InstructionSet::Avx2;
+			}
+			if (__builtin_cpu_supports("sse2"))
+			{
+				return InstructionSet::Sse2;
+			}
+#endif
+#endif
+			return InstructionSet::Scalar;
+		}
+
+		void SetInstructionSet(InstructionSet set)
+		{
+			// The enum is ordered from the least to the most capable set.
+			if (static_cast<int>(set) > static_cast<int>(KernelInternalData::DetectedSet))
+			{
+				set = KernelInternalData::DetectedSet;
+			}
+			KernelInternalData::ActiveSet = set;
+		}
+
+		InstructionSet GetInstructionSet()
+		{
+			return KernelInternalData::ActiveSet;
+		}
+
+		const char* GetInstructionSetName(InstructionSet set)
+		{
+			switch (set)
+			{
+			case InstructionSet::Avx512:
+				return "AVX-512";
+			case InstructionSet::Avx2:
+				return "AVX2";
+			case InstructionSet::Sse2:
+				return "SSE2";
+			default:
+				return "Scalar";
+			}
+		}
+
+		std::size_t GetLaneCount(bool single_precision)
+		{
+			std::size_t lanes = 1;
+			switch (KernelInternalData::ActiveSet)
+			{
+			case InstructionSet::Avx512:
+				lanes = 8;
+				break;
+			case InstructionSet::Avx2:
+				lanes = 4;
+				break;
+			case InstructionSet::Sse2:
+				lanes = 2;
+				break;
+			default:
+				return 1;
+			}
+			return single_precision ? lanes * 2 : lanes;
+		}
+	}
+}
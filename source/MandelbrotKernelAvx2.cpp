@@ -0,0 +1,145 @@
+#include "MandelbrotKernelSimd.hpp"
+
+#ifdef MANDELBROT_ENABLE_SIMD
+
+#include <immintrin.h>
+
+#include <cstring>
+
+namespace Mandelbrot
+{
+	namespace Kernel
+	{
+		namespace
+		{
+			struct Avx2DoubleOps
+			{
+				using Scalar = double;
+				using Vec = __m256d;
+				static constexpr std::size_t Lanes = 4;
+
+				static inline Vec Set1(Scalar s) { return _mm256_set1_pd(s); }
+				static inline Vec Ramp() { return _mm256_setr_pd(0.0, 1.0, 2.0, 3.0); }
+				static inline Vec Add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+				static inline Vec Sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+				static inline Vec Mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+				static inline Vec Load(const Scalar* in) { return _mm256_loadu_pd(in); }
+				static inline void Store(Scalar* out, Vec v) { _mm256_storeu_pd(out, v); }
+				static inline unsigned int GreaterBits(Vec a, Vec b) { return static_cast<unsigned int>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ))); }
+				static inline unsigned int LessEqualBits(Vec a, Vec b) { return static_cast<unsigned int>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LE_OQ))); }
+			};
+
+			struct Avx2FloatOps
+			{
+				using Scalar = float;
+				using Vec = __m256;
+				static constexpr std::size_t Lanes = 8;
+
+				static inline Vec Set1(Scalar s) { return _mm256_set1_ps(s); }
+				static inline Vec Ramp() { return _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f); }
+				static inline Vec Add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+				static inline Vec Sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+				static inline Vec Mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+				static inline Vec Load(const Scalar* in) { return _mm256_loadu_ps(in); }
+				static inline void Store(Scalar* out, Vec v) { _mm256_storeu_ps(out, v); }
+				static inline unsigned int GreaterBits(Vec a, Vec b) { return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ))); }
+				static inline unsigned int LessEqualBits(Vec a, Vec b) { return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LE_OQ))); }
+			};
+		}
+
+		RowStatistics ComputeRowAvx2(const RowSegment<double>& segment)
+		{
+			return ComputeRowSimd<Avx2DoubleOps>(segment);
+		}
+
+		RowStatistics ComputeRowAvx2(const RowSegment<float>& segment)
+		{
+			return ComputeRowSimd<Avx2FloatOps>(segment);
+		}
+
+		RowStatistics ContinuePointsAvx2(const ResumeSegment<double>& segment)
+		{
+			return ContinuePointsSimd<Avx2DoubleOps>(segment);
+		}
+
+		RowStatistics ContinuePointsAvx2(const ResumeSegment<float>& segment)
+		{
+			return ContinuePointsSimd<Avx2FloatOps>(segment);
+		}
+
+		// Blends one byte channel of `low` and `high` by `weight`, rounded like `GetTableColor`.
+		template<int Shift>
+		static inline __m256i BlendChannelAvx2(__m256i low, __m256i high, __m256 weight)
+		{
+			const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+			const __m256 a = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(low, Shift), byte_mask));
+			const __m256 b = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(high, Shift), byte_mask));
+			const __m256 channel = _mm256_add_ps(_mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), weight)), _mm256_set1_ps(0.5f));
+			return _mm256_slli_epi32(_mm256_cvttps_epi32(channel), Shift);
+		}
+
+		ColorStatistics ColorizeRowAvx2(const ColorSegment& segment)
+		{
+			const int* table = reinterpret_cast<const int*>(segment.Table);
+			const __m256i max_iterations = _mm256_set1_epi32(static_cast<int>(segment.MaxIterations));
+			const __m256i interior = _mm256_set1_epi32(static_cast<int>(segment.Interior));
+
+			// Counts are summed on 64 bits, the even and the odd lanes apart. Interior lanes count down from 0.
+			const __m256i low_half = _mm256_set1_epi64x(0xFFFFFFFF);
+			__m256i sum = _mm256_setzero_si256();
+			__m256i inside_lanes = _mm256_setzero_si256();
+
+			ColorStatistics statistics;
+			std::size_t i = 0;
+			for (; i + 8 <= segment.Count; i += 8)
+			{
+				const __m256i iterations = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(segment.Iterations + i));
+				const __m256i clamped = _mm256_min_epu32(iterations, max_iterations);
+				const __m256i inside = _mm256_cmpeq_epi32(clamped, max_iterations);
+				sum = _mm256_add_epi64(sum, _mm256_add_epi64(_mm256_and_si256(iterations, low_half), _mm256_srli_epi64(iterations, 32)));
+				inside_lanes = _mm256_add_epi32(inside_lanes, inside);
+
+				__m256i color;
+				if (!segment.Smooth)
+				{
+					color = _mm256_i32gather_epi32(table, clamped, 4);
+				}
+				else
+				{
+					const __m256 position = _mm256_max_ps(_mm256_loadu_ps(segment.Smooth + i), _mm256_setzero_ps());
+					const __m256i index = _mm256_min_epu32(_mm256_cvttps_epi32(position), max_iterations);
+					const __m256 weight = _mm256_sub_ps(position, _mm256_cvtepi32_ps(index));
+					const __m256i low = _mm256_i32gather_epi32(table, index, 4);
+					const __m256i high = _mm256_i32gather_epi32(table, _mm256_add_epi32(index, _mm256_set1_epi32(1)), 4);
+					color = _mm256_or_si256(_mm256_or_si256(BlendChannelAvx2<0>(low, high, weight), BlendChannelAvx2<8>(low, high, weight)),
+						_mm256_or_si256(BlendChannelAvx2<16>(low, high, weight), BlendChannelAvx2<24>(low, high, weight)));
+				}
+				color = _mm256_blendv_epi8(color, interior, inside);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(segment.Colors + i * 4), color);
+			}
+
+			alignas(32) std::uint64_t sums[4];
+			alignas(32) std::int32_t inside_counts[8];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(sums), sum);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(inside_counts), inside_lanes);
+			statistics.Iterations = sums[0] + sums[1] + sums[2] + sums[3];
+			statistics.Escaped = i;
+			for (const std::int32_t count : inside_counts)
+			{
+				statistics.Escaped -= static_cast<std::size_t>(-count);
+			}
+
+			for (; i < segment.Count; i++)
+			{
+				const std::uint32_t iterations = segment.Iterations[i];
+				const std::uint32_t color = GetTableColor(segment, iterations, segment.Smooth ? segment.Smooth[i] : 0.0f);
+				std::memcpy(segment.Colors + i * 4, &color, sizeof(color));
+				statistics.Iterations += iterations;
+				statistics.Escaped += iterations < segment.MaxIterations ? 1 : 0;
+			}
+			return statistics;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,149 @@
+#include "MandelbrotKernelSimd.hpp"
+
+#ifdef MANDELBROT_ENABLE_SIMD
+
+#include <immintrin.h>
+
+#include <cstring>
+
+namespace Mandelbrot
+{
+	namespace Kernel
+	{
+		namespace
+		{
+			struct Avx512DoubleOps
+			{
+				using Scalar = double;
+				using Vec = __m512d;
+				static constexpr std::size_t Lanes = 8;
+
+				static inline Vec Set1(Scalar s) { return _mm512_set1_pd(s); }
+				static inline Vec Ramp() { return _mm512_setr_pd(0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0); }
+				static inline Vec Add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+				static inline Vec Sub(Vec a, Vec b) { return _mm512_sub_pd(a, b); }
+				static inline Vec Mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+				static inline Vec Load(const Scalar* in) { return _mm512_loadu_pd(in); }
+				static inline void Store(Scalar* out, Vec v) { _mm512_storeu_pd(out, v); }
+				static inline unsigned int GreaterBits(Vec a, Vec b) { return static_cast<unsigned int>(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ)); }
+				static inline unsigned int LessEqualBits(Vec a, Vec b) { return static_cast<unsigned int>(_mm512_cmp_pd_mask(a, b, _CMP_LE_OQ)); }
+			};
+
+			struct Avx512FloatOps
+			{
+				using Scalar = float;
+				using Vec = __m512;
+				static constexpr std::size_t Lanes = 16;
+
+				static inline Vec Set1(Scalar s) { return _mm512_set1_ps(s); }
+				static inline Vec Ramp() { return _mm512_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 11.f, 12.f, 13.f, 14.f, 15.f); }
+				static inline Vec Add(Vec a, Vec b) { return _mm512_add_ps(a, b); }
+				static inline Vec Sub(Vec a, Vec b) { return _mm512_sub_ps(a, b); }
+				static inline Vec Mul(Vec a, Vec b) { return _mm512_mul_ps(a, b); }
+				static inline Vec Load(const Scalar* in) { return _mm512_loadu_ps(in); }
+				static inline void Store(Scalar* out, Vec v) { _mm512_storeu_ps(out, v); }
+				static inline unsigned int GreaterBits(Vec a, Vec b) { return static_cast<unsigned int>(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ)); }
+				static inline unsigned int LessEqualBits(Vec a, Vec b) { return static_cast<unsigned int>(_mm512_cmp_ps_mask(a, b, _CMP_LE_OQ)); }
+			};
+		}
+
+		RowStatistics ComputeRowAvx512(const RowSegment<double>& segment)
+		{
+			return ComputeRowSimd<Avx512DoubleOps>(segment);
+		}
+
+		RowStatistics ComputeRowAvx512(const RowSegment<float>& segment)
+		{
+			return ComputeRowSimd<Avx512FloatOps>(segment);
+		}
+
+		RowStatistics ContinuePointsAvx512(const ResumeSegment<double>& segment)
+		{
+			return ContinuePointsSimd<Avx512DoubleOps>(segment);
+		}
+
+		RowStatistics ContinuePointsAvx512(const ResumeSegment<float>& segment)
+		{
+			return ContinuePointsSimd<Avx512FloatOps>(segment);
+		}
+
+		// Blends one byte channel of `low` and `high` by `weight`, rounded like `GetTableColor`.
+		template<unsigned int Shift>
+		static inline __m512i BlendChannelAvx512(__m512i low, __m512i high, __m512 weight)
+		{
+			const __m512i byte_mask = _mm512_set1_epi32(0xFF);
+			const __m512 a = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(low, Shift), byte_mask));
+			const __m512 b = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(high, Shift), byte_mask));
+			const __m512 channel = _mm512_add_ps(_mm512_add_ps(a, _mm512_mul_ps(_mm512_sub_ps(b, a), weight)), _mm512_set1_ps(0.5f));
+			return _mm512_slli_epi32(_mm512_cvttps_epi32(channel), Shift);
+		}
+
+		ColorStatistics ColorizeRowAvx512(const ColorSegment& segment)
+		{
+			const int* table = reinterpret_cast<const int*>(segment.Table);
+			const __m512i max_iterations = _mm512_set1_epi32(static_cast<int>(segment.MaxIterations));
+			const __m512i interior = _mm512_set1_epi32(static_cast<int>(segment.Interior));
+
+			// Counts are summed on 64 bits, the even and the odd lanes apart.
+			const __m512i low_half = _mm512_set1_epi64(0xFFFFFFFF);
+			const __m512i one = _mm512_set1_epi32(1);
+			__m512i sum = _mm512_setzero_si512();
+			__m512i inside_lanes = _mm512_setzero_si512();
+
+			ColorStatistics statistics;
+			std::size_t i = 0;
+			for (; i + 16 <= segment.Count; i += 16)
+			{
+				const __m512i iterations = _mm512_loadu_si512(segment.Iterations + i);
+				const __m512i clamped = _mm512_min_epu32(iterations, max_iterations);
+				const __mmask16 inside = _mm512_cmpeq_epi32_mask(clamped, max_iterations);
+				sum = _mm512_add_epi64(sum, _mm512_add_epi64(_mm512_and_si512(iterations, low_half), _mm512_srli_epi64(iterations, 32)));
+				inside_lanes = _mm512_mask_add_epi32(inside_lanes, inside, inside_lanes, one);
+
+				__m512i color;
+				if (!segment.Smooth)
+				{
+					color = _mm512_i32gather_epi32(clamped, table, 4);
+				}
+				else
+				{
+					const __m512 position = _mm512_max_ps(_mm512_loadu_ps(segment.Smooth + i), _mm512_setzero_ps());
+					const __m512i index = _mm512_min_epu32(_mm512_cvttps_epi32(position), max_iterations);
+					const __m512 weight = _mm512_sub_ps(position, _mm512_cvtepi32_ps(index));
+					const __m512i low = _mm512_i32gather_epi32(index, table, 4);
+					const __m512i high = _mm512_i32gather_epi32(_mm512_add_epi32(index, _mm512_set1_epi32(1)), table, 4);
+					color = _mm512_or_si512(_mm512_or_si512(BlendChannelAvx512<0>(low, high, weight), BlendChannelAvx512<8>(low, high, weight)),
+						_mm512_or_si512(BlendChannelAvx512<16>(low, high, weight), BlendChannelAvx512<24>(low, high, weight)));
+				}
+				color = _mm512_mask_blend_epi32(inside, color, interior);
+				_mm512_storeu_si512(segment.Colors + i * 4, color);
+			}
+
+			alignas(64) std::uint64_t sums[8];
+			alignas(64) std::uint32_t inside_counts[16];
+			_mm512_store_si512(sums, sum);
+			_mm512_store_si512(inside_counts, inside_lanes);
+			statistics.Escaped = i;
+			for (const std::uint64_t lanes : sums)
+			{
+				statistics.Iterations += lanes;
+			}
+			for (const std::uint32_t count : inside_counts)
+			{
+				statistics.Escaped -= count;
+			}
+
+			for (; i < segment.Count; i++)
+			{
+				const std::uint32_t iterations = segment.Iterations[i];
+				const std::uint32_t color = GetTableColor(segment, iterations, segment.Smooth ? segment.Smooth[i] : 0.0f);
+				std::memcpy(segment.Colors + i * 4, &color, sizeof(color));
+				statistics.Iterations += iterations;
+				statistics.Escaped += iterations < segment.MaxIterations ? 1 : 0;
+			}
+			return statistics;
+		}
+	}
+}
+
+#endif
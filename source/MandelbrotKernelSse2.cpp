@@ -0,0 +1,70 @@
+#include "MandelbrotKernelSimd.hpp"
+
+#ifdef MANDELBROT_ENABLE_SIMD
+
+#include <emmintrin.h>
+
+namespace Mandelbrot
+{
+	namespace Kernel
+	{
+		namespace
+		{
+			struct Sse2DoubleOps
+			{
+				using Scalar = double;
+				using Vec = __m128d;
+				static constexpr std::size_t Lanes = 2;
+
+				static inline Vec Set1(Scalar s) { return _mm_set1_pd(s); }
+				static inline Vec Ramp() { return _mm_setr_pd(0.0, 1.0); }
+				static inline Vec Add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+				static inline Vec Sub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+				static inline Vec Mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+				static inline Vec Load(const Scalar* in) { return _mm_loadu_pd(in); }
+				static inline void Store(Scalar* out, Vec v) { _mm_storeu_pd(out, v); }
+				static inline unsigned int GreaterBits(Vec a, Vec b) { return static_cast<unsigned int>(_mm_movemask_pd(_mm_cmpgt_pd(a, b))); }
+				static inline unsigned int LessEqualBits(Vec a, Vec b) { return static_cast<unsigned int>(_mm_movemask_pd(_mm_cmple_pd(a, b))); }
+			};
+
+			struct Sse2FloatOps
+			{
+				using Scalar = float;
+				using Vec = __m128;
+				static constexpr std::size_t Lanes = 4;
+
+				static inline Vec Set1(Scalar s) { return _mm_set1_ps(s); }
+				static inline Vec Ramp() { return _mm_setr_ps(0.f, 1.f, 2.f, 3.f); }
+				static inline Vec Add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+				static inline Vec Sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+				static inline Vec Mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+				static inline Vec Load(const Scalar* in) { return _mm_loadu_ps(in); }
+				static inline void Store(Scalar* out, Vec v) { _mm_storeu_ps(out, v); }
+				static inline unsigned int GreaterBits(Vec a, Vec b) { return static_cast<unsigned int>(_mm_movemask_ps(_mm_cmpgt_ps(a, b))); }
+				static inline unsigned int LessEqualBits(Vec a, Vec b) { return static_cast<unsigned int>(_mm_movemask_ps(_mm_cmple_ps(a, b))); }
+			};
+		}
+
+		RowStatistics ComputeRowSse2(const RowSegment<double>& segment)
+		{
+			return ComputeRowSimd<Sse2DoubleOps>(segment);
+		}
+
+		RowStatistics ComputeRowSse2(const RowSegment<float>& segment)
+		{
+			return ComputeRowSimd<Sse2FloatOps>(segment);
+		}
+
+		RowStatistics ContinuePointsSse2(const ResumeSegment<double>& segment)
+		{
+			return ContinuePointsSimd<Sse2DoubleOps>(segment);
+		}
+
+		RowStatistics ContinuePointsSse2(const ResumeSegment<float>& segment)
+		{
+			return ContinuePointsSimd<Sse2FloatOps>(segment);
+		}
+	}
+}
+
+#endif
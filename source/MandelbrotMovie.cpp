@@ -0,0 +1,574 @@
+#include "MandelbrotMovie.hpp"
+
+#include "MandelbrotKernel.hpp"
+#include "MandelbrotPerturbation.hpp"
+#include "MandelbrotStats.hpp"
+#include "MandelbrotTrace.hpp"
+#include "MandelbrotUtils.hpp"
+#include "ThreadPool.hpp"
+#include "Logger.hpp"
+#include "Timer.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <numbers>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace Mandelbrot
+{
+	namespace Movie
+	{
+		// Like the frames: adjacent samples must be this many ulps apart for `double` to be used.
+		static constexpr double PrecisionSampleUlps = 1024.0;
+
+		// Perturbation deltas around the smallest sample spacing must stay normal numbers.
+		static constexpr long double MinEndZoom = 1e-280L;
+
+		// Rows are never split in fewer samples than this, however close to the center.
+		static constexpr std::size_t MinOctaveColumns = 64;
+
+		// Rows of the exponential map from the radius of `Index * RowsPerOctave` to half of it.
+		struct Octave
+		{
+			std::size_t Index = 0;
+			// Samples per row: fewer than the columns of the map once the octave is only seen by the center of the last frames.
+			std::size_t Columns = 0;
+			Precision OctavePrecision = Precision::Double;
+			std::vector<std::uint32_t> Iterations;
+			std::vector<float> Smooth;
+		};
+
+		struct MovieContext
+		{
+			const Settings* MovieSettings = nullptr;
+			std::size_t Workers = 1;
+			ThreadPool Pool;
+
+			// Samples around the center in every full row, and rows per halving of the radius.
+			std::size_t Columns = 0;
+			std::size_t RowsPerOctave = 0;
+			std::size_t Rows = 0;
+			std::size_t Octaves = 0;
+			// Log radius of row 0, and the step between two rows.
+			long double TopLogRadius = 0.0L;
+			long double RowStep = 0.0L;
+			// Radius of the corners of the last frame. Closer to the center, no pixel is smaller than the ones of that frame.
+			long double LastCornerRadius = 0.0L;
+
+			double CenterX = 0.0;
+			double CenterY = 0.0;
+			// Only computed once an octave needs perturbation.
+			std::unique_ptr<Perturbation::ReferenceOrbit> Orbit;
+
+			// Octaves the current frame covers, in order.
+			std::deque<Octave> Window;
+			std::size_t NextOctave = 0;
+			std::size_t ComputedSamples = 0;
+
+			// Per pixel of the frames: the column of a full row it falls on, and its log distance to the center in rows.
+			std::vector<std::uint32_t> PixelColumns;
+			std::vector<float> PixelRows;
+			float MinPixelRow = 0.0f;
+			float MaxPixelRow = 0.0f;
+
+			std::vector<std::uint32_t> ColorTable;
+
+			// Statistics of the frame being rendered, the octaves it computes included.
+			Stats::FrameStats FrameStats;
+		};
+
+		static long double GetRowRadius(const MovieContext& context, std::size_t row)
+		{
+			return std::exp(context.TopLogRadius - static_cast<long double>(row) * context.RowStep);
+		}
+
+		// Octaves inside the corners of the last frame only need to be as fine as its pixels.
+		static std::size_t GetOctaveColumns(const MovieContext& context, std::size_t first_row)
+		{
+			const long double ratio = GetRowRadius(context, first_row) / context.LastCornerRadius;
+			const std::size_t columns = static_cast<std::size_t>(std::ceil(context.Columns * ratio));
+			return std::clamp(columns, MinOctaveColumns, context.Columns);
+		}
+
+		// The largest coordinate of an octave is on its outer row, and its closest samples are on its inner row.
+		static Precision SelectOctavePrecision(const MovieContext& context, std::size_t first_row, std::size_t last_row, std::size_t columns)
+		{
+			const double outer = static_cast<double>(GetRowRadius(context, first_row));
+			const double spacing = static_cast<double>(GetRowRadius(context, last_row) * 2.0L * std::numbers::pi_v<long double> / columns);
+			const double max_coordinate = std::max({ std::fabs(context.CenterX) + outer, std::fabs(context.CenterY) + outer, 2.0 });
+			return spacing >= max_coordinate * std::numeric_limits<double>::epsilon() * PrecisionSampleUlps ? Precision::Double : Precision::Perturbation;
+		}
+
+		static void ComputeReferenceOrbit(MovieContext& context)
+		{
+			const Settings& settings = *context.MovieSettings;
+			const long double spacing = GetRowRadius(context, context.Rows - 1) * 2.0L * std::numbers::pi_v<long double> / GetOctaveColumns(context, context.Rows - 1);
+			const std::size_t fraction_limbs = HighPrecision::LimbsForResolution(spacing);
+
+			HighPrecision center_x = settings.CenterX;
+			HighPrecision center_y = settings.CenterY;
+			center_x.SetFractionLimbs(std::max(fraction_limbs, center_x.GetFractionLimbs()));
+			center_y.SetFractionLimbs(std::max(fraction_limbs, center_y.GetFractionLimbs()));
+
+			context.Orbit = std::make_unique<Perturbation::ReferenceOrbit>();
+			Perturbation::ComputeReferenceOrbit(center_x, center_y, settings.MaxIterations, *context.Orbit);
+			Logger::GetLogger()->info("Reference orbit: {} iterations at {} bits.", context.Orbit->Length, fraction_limbs * 32);
+		}
+
+		static void ComputeOctave(MovieContext& context)
+		{
+			const Settings& settings = *context.MovieSettings;
+
+			Octave octave;
+			octave.Index = context.NextOctave++;
+			const std::size_t first_row = octave.Index * context.RowsPerOctave;
+			const std::size_t rows = std::min(context.RowsPerOctave, context.Rows - first_row);
+			octave.Columns = GetOctaveColumns(context, first_row);
+			octave.OctavePrecision = SelectOctavePrecision(context, first_row, first_row + rows - 1, octave.Columns);
+			octave.Iterations.resize(rows * octave.Columns);
+			if (settings.Smooth)
+			{
+				octave.Smooth.resize(rows * octave.Columns);
+			}
+
+			// Direction of every column.
+			const long double two_pi = 2.0L * std::numbers::pi_v<long double>;
+			std::vector<double> cosines(octave.Columns);
+			std::vector<double> sines(octave.Columns);
+			for (std::size_t j = 0; j < octave.Columns; j++)
+			{
+				cosines[j] = static_cast<double>(std::cos(two_pi * j / octave.Columns));
+				sines[j] = static_cast<double>(std::sin(two_pi * j / octave.Columns));
+			}
+
+			Perturbation::BlaTable bla;
+			if (octave.OctavePrecision == Precision::Perturbation)
+			{
+				if (!context.Orbit)
+				{
+					ComputeReferenceOrbit(context);
+				}
+				Perturbation::BuildBlaTable(*context.Orbit, static_cast<double>(GetRowRadius(context, first_row)), bla);
+			}
+
+			Timer timer;
+			timer.start();
+			const Trace::Scope trace("octave", "phase", { "octave", octave.Index });
+
+			std::atomic<std::size_t> next_row = 0;
+			std::atomic<std::size_t> executed = 0;
+			std::atomic<std::size_t> interior = 0;
+			std::atomic<std::size_t> periodic = 0;
+			std::atomic<std::size_t> skipped = 0;
+			context.Pool.Run(context.Workers, [&](std::size_t worker)
+			{
+				const Trace::Scope worker_trace("octave", "worker", { "worker", worker });
+				const Stats::ScopedTimer busy(context.FrameStats.WorkerBusy[worker]);
+				thread_local std::vector<double> real;
+				thread_local std::vector<double> imag;
+				thread_local std::vector<Kernel::ResumePoint> points;
+				real.resize(octave.Columns);
+				imag.resize(octave.Columns);
+				points.resize(octave.Columns);
+
+				for (std::size_t row = next_row++; row < rows; row = next_row++)
+				{
+					const double radius = static_cast<double>(GetRowRadius(context, first_row + row));
+					std::uint32_t* iterations = octave.Iterations.data() + row * octave.Columns;
+					float* smooth = settings.Smooth ? octave.Smooth.data() + row * octave.Columns : nullptr;
+
+					if (octave.OctavePrecision == Precision::Double)
+					{
+						// The kernels start from z = c at iteration 0, like `GetPointIterations`.
+						for (std::size_t j = 0; j < octave.Columns; j++)
+						{
+							real[j] = context.CenterX + radius * cosines[j];
+							imag[j] = context.CenterY + radius * sines[j];
+							points[j] = { static_cast<std::uint32_t>(j), 0, real[j], imag[j] };
+						}
+
+						Kernel::ResumeSegment<double> segment;
+						segment.Cr = real.data();
+						segment.Ci = imag.data();
+						segment.Points = points.data();
+						segment.Count = octave.Columns;
+						segment.StartIteration = 0;
+						segment.MaxIterations = settings.MaxIterations;
+						segment.PeriodTolerance = Kernel::GetPeriodTolerance(radius * static_cast<double>(two_pi) / static_cast<double>(octave.Columns));
+						segment.Iterations = iterations;
+						segment.Smooth = smooth;
+						segment.Resume = nullptr;
+						const Kernel::RowStatistics statistics = Kernel::ContinuePoints(segment);
+						executed += statistics.Iterations;
+						interior += statistics.InteriorRejected;
+						periodic += statistics.PeriodicExits;
+					}
+					else
+					{
+						// Perturbation starts from dz = 0 on Z_0 = 0 instead.
+						for (std::size_t j = 0; j < octave.Columns; j++)
+						{
+							real[j] = radius * cosines[j];
+							imag[j] = radius * sines[j];
+							points[j] = { static_cast<std::uint32_t>(j), 0, 0.0, 0.0 };
+						}
+
+						Perturbation::DeltaResumeSegment segment;
+						segment.DeltaCr = real.data();
+						segment.DeltaCi = imag.data();
+						segment.Points = points.data();
+						segment.Count = octave.Columns;
+						segment.StartIteration = 0;
+						segment.MaxIterations = settings.MaxIterations;
+						segment.Iterations = iterations;
+						segment.Smooth = smooth;
+						segment.Resume = nullptr;
+						const Perturbation::RowStatistics statistics = Perturbation::ContinuePoints(*context.Orbit, &bla, segment);
+						executed += statistics.Iterations;
+						skipped += statistics.SkippedIterations;
+					}
+				}
+			});
+
+			timer.stop();
+			context.ComputedSamples += octave.Iterations.size();
+			context.FrameStats.ExecutedIterations += executed;
+			context.FrameStats.InteriorRejectedPixels += interior;
+			context.FrameStats.PeriodicPixels += periodic;
+			context.FrameStats.SkippedIterations += skipped;
+			Logger::GetLogger()->info("Octave {}/{}: {}x{} samples in {}, {} ms.", octave.Index + 1, context.Octaves, octave.Columns, rows, GetPrecisionName(octave.OctavePrecision), timer.elapsedMilliseconds());
+
+			context.Window.push_back(std::move(octave));
+		}
+
+		// Sizes the map so that its samples are never farther apart than the pixels of a frame,
+		// which are the farthest apart from the center in the corners.
+		static void PrepareMap(MovieContext& context)
+		{
+			const Settings& settings = *context.MovieSettings;
+			const long double half_diagonal = std::hypot(settings.Width / 2.0L, settings.Height / 2.0L);
+			const long double two_pi = 2.0L * std::numbers::pi_v<long double>;
+
+			context.Columns = static_cast<std::size_t>(std::ceil(two_pi * half_diagonal));
+			context.RowsPerOctave = static_cast<std::size_t>(std::ceil(std::numbers::ln2_v<long double> * context.Columns / two_pi));
+			// Rows are a whole number per octave, so they end up a bit closer than the columns.
+			context.RowStep = std::numbers::ln2_v<long double> / context.RowsPerOctave;
+
+			// From the corners of the first frame to half a pixel of the last one, see `PreparePixels`.
+			context.TopLogRadius = std::log(settings.StartZoom * half_diagonal);
+			const long double bottom_log_radius = std::log(settings.EndZoom * 0.5L);
+			context.Rows = static_cast<std::size_t>(std::ceil((context.TopLogRadius - bottom_log_radius) / context.RowStep)) + 1;
+			context.Octaves = (context.Rows + context.RowsPerOctave - 1) / context.RowsPerOctave;
+			context.LastCornerRadius = settings.EndZoom * half_diagonal;
+
+			context.CenterX = settings.CenterX.ToDouble();
+			context.CenterY = settings.CenterY.ToDouble();
+		}
+
+		// Where each pixel falls on the map does not depend on the zoom but for a shift of rows,
+		// so the logarithms and angles are only computed once for the whole movie.
+		static void PreparePixels(MovieContext& context)
+		{
+			const Settings& settings = *context.MovieSettings;
+			const double two_pi = 2.0 * std::numbers::pi;
+			context.PixelColumns.resize(settings.Width * settings.Height);
+			context.PixelRows.resize(settings.Width * settings.Height);
+
+			for (std::size_t y = 0; y < settings.Height; y++)
+			{
+				for (std::size_t x = 0; x < settings.Width; x++)
+				{
+					// Same position as in the frames, see `ScaleToPlane`.
+					const double px = static_cast<double>(x) - static_cast<double>(settings.Width) / 2.0;
+					const double py = static_cast<double>(y) - static_cast<double>(settings.Height) / 2.0;
+					// The pixel right on the center would need an infinitely deep map: it is taken half a pixel away.
+					const double distance = std::max(std::hypot(px, py), 0.5);
+					double angle = std::atan2(py, px);
+					if (angle < 0.0)
+					{
+						angle += two_pi;
+					}
+
+					const std::size_t index = y * settings.Width + x;
+					context.PixelColumns[index] = static_cast<std::uint32_t>(std::llround(angle / two_pi * static_cast<double>(context.Columns)) % static_cast<long long>(context.Columns));
+					context.PixelRows[index] = static_cast<float>(std::log(distance) / static_cast<double>(context.RowStep));
+				}
+			}
+			context.MinPixelRow = *std::min_element(context.PixelRows.begin(), context.PixelRows.end());
+			context.MaxPixelRow = *std::max_element(context.PixelRows.begin(), context.PixelRows.end());
+		}
+
+		// Row of the map at the distance of `pixel_row` from the center, in a frame whose center is at `center_row`.
+		static std::size_t GetSampleRow(const MovieContext& context, double center_row, float pixel_row)
+		{
+			const long long row = std::llround(center_row - static_cast<double>(pixel_row));
+			return static_cast<std::size_t>(std::clamp<long long>(row, 0, static_cast<long long>(context.Rows) - 1));
+		}
+
+		// Resamples, colours and converts the frame at `zoom` to Y'CbCr planes of `frame`.
+		static void RenderFrame(MovieContext& context, long double zoom, std::vector<std::uint8_t>& frame)
+		{
+			const Settings& settings = *context.MovieSettings;
+
+			// Row of the map on the radius of one pixel.
+			const double center_row = static_cast<double>((context.TopLogRadius - std::log(zoom)) / context.RowStep);
+
+			// Computes the octaves the frame reaches into, and drops the ones it zoomed past.
+			const std::size_t first_octave = GetSampleRow(context, center_row, context.MaxPixelRow) / context.RowsPerOctave;
+			const std::size_t last_octave = GetSampleRow(context, center_row, context.MinPixelRow) / context.RowsPerOctave;
+			while (!context.Window.empty() && context.Window.front().Index < first_octave)
+			{
+				context.Window.pop_front();
+			}
+			if (context.Window.empty())
+			{
+				context.NextOctave = std::max(context.NextOctave, first_octave);
+			}
+			while (context.NextOctave <= last_octave)
+			{
+				ComputeOctave(context);
+			}
+			const std::size_t window_first = context.Window.front().Index;
+			context.FrameStats.FramePrecision = context.Window.back().OctavePrecision;
+
+			const Trace::Scope trace("colorize", "phase");
+			const Stats::ScopedTimer phase(context.FrameStats.Phases[static_cast<std::size_t>(Stats::Phase::Colorize)]);
+			const std::size_t plane_size = settings.Width * settings.Height;
+			std::atomic<std::size_t> next_row = 0;
+			std::atomic<std::uint64_t> iteration_sum = 0;
+			std::atomic<std::size_t> escaped = 0;
+			context.Pool.Run(context.Workers, [&](std::size_t worker)
+			{
+				const Trace::Scope worker_trace("colorize", "worker", { "worker", worker });
+				const Stats::ScopedTimer busy(context.FrameStats.WorkerBusy[worker]);
+				thread_local std::vector<std::uint32_t> iterations;
+				thread_local std::vector<float> smooth;
+				thread_local std::vector<std::uint8_t> colors;
+				iterations.resize(settings.Width);
+				smooth.resize(settings.Smooth ? settings.Width : 0);
+				colors.resize(settings.Width * 4);
+
+				Kernel::ColorSegment segment;
+				segment.Table = context.ColorTable.data();
+				segment.MaxIterations = static_cast<std::uint32_t>(settings.MaxIterations);
+				segment.Interior = Palettes::InteriorColor;
+				segment.Count = settings.Width;
+				segment.Iterations = iterations.data();
+				segment.Smooth = settings.Smooth ? smooth.data() : nullptr;
+				segment.Colors = colors.data();
+
+				for (std::size_t y = next_row++; y < settings.Height; y = next_row++)
+				{
+					for (std::size_t x = 0; x < settings.Width; x++)
+					{
+						const std::size_t index = y * settings.Width + x;
+						const std::size_t row = GetSampleRow(context, center_row, context.PixelRows[index]);
+						const Octave& octave = context.Window[row / context.RowsPerOctave - window_first];
+						std::size_t column = context.PixelColumns[index];
+						if (octave.Columns != context.Columns)
+						{
+							column = (column * octave.Columns + context.Columns / 2) / context.Columns % octave.Columns;
+						}
+						const std::size_t sample = (row % context.RowsPerOctave) * octave.Columns + column;
+						iterations[x] = octave.Iterations[sample];
+						if (settings.Smooth)
+						{
+							smooth[x] = octave.Smooth[sample];
+						}
+					}
+					const Kernel::ColorStatistics statistics = Kernel::ColorizeRow(segment);
+					iteration_sum += statistics.Iterations;
+					escaped += statistics.Escaped;
+
+					// BT.601 studio range, what YUV4MPEG2 readers assume.
+					std::uint8_t* luma = frame.data() + y * settings.Width;
+					std::uint8_t* blue = luma + plane_size;
+					std::uint8_t* red = blue + plane_size;
+					for (std::size_t x = 0; x < settings.Width; x++)
+					{
+						const int r = colors[x * 4];
+						const int g = colors[x * 4 + 1];
+						const int b = colors[x * 4 + 2];
+						luma[x] = static_cast<std::uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+						blue[x] = static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+						red[x] = static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+					}
+				}
+			});
+			context.FrameStats.Iterations = iteration_sum;
+			context.FrameStats.EscapedPixels = escaped;
+			context.FrameStats.LimitPixels = plane_size - escaped;
+		}
+
+		static bool WriteStats(const Settings& settings, const std::string& json)
+		{
+			if (settings.StatsPath.empty())
+			{
+				return true;
+			}
+			if (!Stats::WriteJson(json, settings.StatsPath))
+			{
+				Logger::GetLogger()->error("Couldn't write the statistics to \"{}\".", settings.StatsPath);
+				return false;
+			}
+			Logger::GetLogger()->info("Statistics written to \"{}\".", settings.StatsPath);
+			return true;
+		}
+
+		// The workers are idle once the last frame is written, so the rings are read here rather than with
+		// `WriteTrace`, whose job runner only `Init` starts.
+		static bool SaveTrace(const Settings& settings)
+		{
+			if (settings.TracePath.empty())
+			{
+				return true;
+			}
+			if (!Stats::WriteJson(Trace::ToJson(), settings.TracePath))
+			{
+				Logger::GetLogger()->error("Couldn't write the trace to \"{}\".", settings.TracePath);
+				return false;
+			}
+			Logger::GetLogger()->info("Trace written to \"{}\".", settings.TracePath);
+			return true;
+		}
+
+		bool Render(const Settings& settings)
+		{
+			if (settings.Width == 0 || settings.Height == 0 || settings.FramesPerOctave == 0 || settings.FrameRate == 0)
+			{
+				Logger::GetLogger()->error("The frame size, the frames per octave and the frame rate must be positive.");
+				return false;
+			}
+			if (!(settings.EndZoom > 0.0L && settings.EndZoom <= settings.StartZoom))
+			{
+				Logger::GetLogger()->error("The end zoom must be positive, and at most the start zoom.");
+				return false;
+			}
+			if (settings.EndZoom < MinEndZoom)
+			{
+				Logger::GetLogger()->error("Zooms below {} are out of reach of perturbation.", MinEndZoom);
+				return false;
+			}
+
+			std::FILE* output = nullptr;
+			if (settings.OutputPath == "-")
+			{
+				output = stdout;
+#ifdef _WIN32
+				_setmode(_fileno(stdout), _O_BINARY);
+#endif
+			}
+			else
+			{
+				output = std::fopen(settings.OutputPath.c_str(), "wb");
+			}
+			if (!output)
+			{
+				Logger::GetLogger()->error("Couldn't open \"{}\".", settings.OutputPath);
+				return false;
+			}
+
+			UseTracing(!settings.TracePath.empty());
+
+			MovieContext context;
+			context.MovieSettings = &settings;
+			context.Workers = settings.Threads > 0 ? settings.Threads : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+			// The calling thread is worker 0 of every run.
+			context.Pool.Start(context.Workers - 1);
+			PrepareMap(context);
+			PreparePixels(context);
+
+			context.ColorTable.resize(settings.MaxIterations + 2);
+			for (std::size_t i = 0; i < context.ColorTable.size(); i++)
+			{
+				context.ColorTable[i] = Palettes::GetEntry(settings.ColorPalette, i);
+			}
+
+			const std::size_t last_frame = static_cast<std::size_t>(std::llround(settings.FramesPerOctave * std::log2(settings.StartZoom / settings.EndZoom)));
+			Logger::GetLogger()->info("Movie: {} frames of {}x{}, from a map of {} columns by {} rows per octave over {} octaves.",
+				last_frame + 1, settings.Width, settings.Height, context.Columns, context.RowsPerOctave, context.Octaves);
+
+			const std::string header = fmt::format("YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C444\n", settings.Width, settings.Height, settings.FrameRate);
+			std::fwrite(header.data(), 1, header.size(), output);
+
+			std::vector<std::uint8_t> frame(settings.Width * settings.Height * 3);
+			bool written = true;
+			std::string stats;
+
+			Timer timer;
+			timer.start();
+			for (std::size_t f = 0; f <= last_frame && written; f++)
+			{
+				Stats::FrameStats& frame_stats = context.FrameStats;
+				frame_stats = Stats::FrameStats();
+				frame_stats.Frame = f + 1;
+				frame_stats.Mode = "movie";
+				frame_stats.Complete = true;
+				frame_stats.Width = settings.Width;
+				frame_stats.Height = settings.Height;
+				frame_stats.MaxIterations = settings.MaxIterations;
+				frame_stats.WorkerBusy.assign(context.Workers, std::chrono::nanoseconds::zero());
+				const auto start = std::chrono::steady_clock::now();
+				{
+					const Trace::Scope trace("movie", "frame", { "frame", f + 1 });
+					const long double zoom = settings.StartZoom * std::exp2(-static_cast<long double>(f) / settings.FramesPerOctave);
+					RenderFrame(context, zoom, frame);
+
+					const Stats::ScopedTimer phase(frame_stats.Phases[static_cast<std::size_t>(Stats::Phase::Publish)]);
+					written = std::fwrite("FRAME\n", 1, 6, output) == 6 && std::fwrite(frame.data(), 1, frame.size(), output) == frame.size();
+				}
+
+				// Octaves are the compute phase, like the frames of the window.
+				frame_stats.Total = std::chrono::steady_clock::now() - start;
+				const std::chrono::nanoseconds others = frame_stats.GetPhase(Stats::Phase::Colorize) + frame_stats.GetPhase(Stats::Phase::Publish);
+				frame_stats.Phases[static_cast<std::size_t>(Stats::Phase::Compute)] = std::max(frame_stats.Total - others, std::chrono::nanoseconds::zero());
+				for (const std::chrono::nanoseconds busy : frame_stats.WorkerBusy)
+				{
+					frame_stats.WorkerIdle.push_back(std::max(frame_stats.Total - busy, std::chrono::nanoseconds::zero()));
+				}
+				if (!settings.StatsPath.empty())
+				{
+					stats += (stats.empty() ? "[\n" : ",\n") + Stats::ToJson(frame_stats);
+				}
+
+				if ((f + 1) % settings.FramesPerOctave == 0 || f == last_frame)
+				{
+					const double elapsed = timer.elapsedSeconds();
+					const double remaining = elapsed / static_cast<double>(f + 1) * static_cast<double>(last_frame - f);
+					Logger::GetLogger()->info("{}/{} frames, {:.0f} s elapsed, ETA {:.0f} s.", f + 1, last_frame + 1, elapsed, remaining);
+				}
+			}
+			written = std::fflush(output) == 0 && written;
+			if (output != stdout)
+			{
+				written = std::fclose(output) == 0 && written;
+			}
+			if (!written)
+			{
+				Logger::GetLogger()->error("Couldn't write to \"{}\".", settings.OutputPath);
+				return false;
+			}
+
+			const double frame_pixels = static_cast<double>(last_frame + 1) * static_cast<double>(settings.Width) * static_cast<double>(settings.Height);
+			Logger::GetLogger()->info("Movie done in {:.1f} s: {} samples computed for {:.0f} frame pixels ({:.1f}x fewer).",
+				timer.elapsedSeconds(), context.ComputedSamples, frame_pixels, frame_pixels / static_cast<double>(context.ComputedSamples));
+
+			return WriteStats(settings, stats.empty() ? "[]" : stats + "\n]") && SaveTrace(settings);
+		}
+	}
+}
@@ -0,0 +1,265 @@
+#include "MandelbrotPerturbation.hpp"
+#include "MandelbrotKernel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Mandelbrot
+{
+	namespace Perturbation
+	{
+		void ComputeReferenceOrbit(const HighPrecision& center_x, const HighPrecision& center_y, std::size_t max_iterations, ReferenceOrbit& orbit)
+		{
+			orbit.CenterX = center_x;
+			orbit.CenterY = center_y;
+			orbit.MaxIterations = max_iterations;
+
+			orbit.Real.clear();
+			orbit.Imag.clear();
+			orbit.Real.reserve(max_iterations + 1);
+			orbit.Imag.reserve(max_iterations + 1);
+
+			HighPrecision zr(0.0L, center_x.GetFractionLimbs());
+			HighPrecision zi(0.0L, center_y.GetFractionLimbs());
+
+			orbit.Real.push_back(0.0);
+			orbit.Imag.push_back(0.0);
+
+			std::size_t n = 0;
+			while (n < max_iterations)
+			{
+				const HighPrecision r2 = zr * zr;
+				const HighPrecision i2 = zi * zi;
+				const HighPrecision ri = zr * zi;
+
+				zr = r2 - i2 + center_x;
+				zi = ri + ri + center_y;
+				n++;
+
+				const double real = zr.ToDouble();
+				const double imag = zi.ToDouble();
+				orbit.Real.push_back(real);
+				orbit.Imag.push_back(imag);
+
+				// Past the escape radius the values would quickly overflow the fixed point range.
+				if (real * real + imag * imag > 4.0)
+				{
+					break;
+				}
+			}
+			orbit.Length = n;
+		}
+
+		// Relative error tolerated by a BLA step: the `double` rounding unit.
+		static constexpr double BlaEpsilon = 1.1102230246251565e-16;
+
+		void BuildBlaTable(const ReferenceOrbit& orbit, double max_delta_c, BlaTable& table)
+		{
+			table.MaxDeltaC = max_delta_c;
+			table.Levels.clear();
+
+			if (orbit.Length < 2)
+			{
+				return;
+			}
+
+			// Level 0: single steps m -> m + 1 for m in [1, Length).
+			// dz^2 is negligible next to 2 * Z_m * dz as long as |dz| < epsilon * |Z_m|.
+			std::vector<BlaStep> level;
+			level.reserve(orbit.Length - 1);
+			for (std::size_t m = 1; m < orbit.Length; m++)
+			{
+				const double zr = orbit.Real[m];
+				const double zi = orbit.Imag[m];
+
+				BlaStep step;
+				step.Ar = 2.0 * zr;
+				step.Ai = 2.0 * zi;
+				step.Br = 1.0;
+				step.Bi = 0.0;
+				step.Radius = BlaEpsilon * std::sqrt(zr * zr + zi * zi);
+				step.Length = 1;
+				level.push_back(step);
+			}
+			table.Levels.push_back(std::move(level));
+
+			// Each level merges pairs of adjacent steps of the previous one: x followed by y.
+			while (table.Levels.back().size() >= 2)
+			{
+				const std::vector<BlaStep>& previous = table.Levels.back();
+				std::vector<BlaStep> merged;
+				merged.reserve(previous.size() / 2);
+
+				for (std::size_t j = 0; j + 1 < previous.size(); j += 2)
+				{
+					const BlaStep& x = previous[j];
+					const BlaStep& y = previous[j + 1];
+
+					const double ax = std::sqrt(x.Ar * x.Ar + x.Ai * x.Ai);
+					const double bx = std::sqrt(x.Br * x.Br + x.Bi * x.Bi);
+
+					BlaStep step;
+					// A = Ay * Ax, B = Ay * Bx + By
+					step.Ar = y.Ar * x.Ar - y.Ai * x.Ai;
+					step.Ai = y.Ar * x.Ai + y.Ai * x.Ar;
+					step.Br = y.Ar * x.Br - y.Ai * x.Bi + y.Br;
+					step.Bi = y.Ar * x.Bi + y.Ai * x.Br + y.Bi;
+					// After x, |dz| may have grown up to |Ax| * r + |Bx| * |dc|; it must still fit in y.
+					step.Radius = std::min(x.Radius, std::max(0.0, (y.Radius - bx * max_delta_c) / ax));
+					step.Length = x.Length + y.Length;
+					merged.push_back(step);
+				}
+				table.Levels.push_back(std::move(merged));
+			}
+		}
+
+		// Returns the longest valid BLA step starting at orbit index `m`, or null.
+		// A merged step is never valid where the first step it contains is not, so levels
+		// are walked upward and the common case of "no step is valid" costs a single test.
+		static const BlaStep* FindBlaStep(const BlaTable& table, std::size_t m, double dz_norm2, std::size_t remaining)
+		{
+			if (m == 0)
+			{
+				return nullptr;
+			}
+
+			const BlaStep* found = nullptr;
+			for (std::size_t k = 0; k < table.Levels.size(); k++)
+			{
+				const std::size_t mask = (std::size_t(1) << k) - 1;
+				const std::size_t j = (m - 1) >> k;
+				if (((m - 1) & mask) != 0 || j >= table.Levels[k].size())
+				{
+					break;
+				}
+
+				const BlaStep& step = table.Levels[k][j];
+				if (step.Length > remaining || dz_norm2 >= step.Radius * step.Radius)
+				{
+					break;
+				}
+				found = &step;
+			}
+			return found;
+		}
+
+		// Iterates one pixel from the state (dz, m) reached after `first_iteration` iterations up to
+		// `max_iterations`, and stores the result at `index` of the outputs.
+		static void IterateDelta(const ReferenceOrbit& orbit, const BlaTable* bla, double dcr, double dci, double dzr, double dzi, std::size_t m,
+			std::size_t first_iteration, std::size_t max_iterations, std::size_t index, std::uint32_t* iterations, float* smooth,
+			std::vector<Kernel::ResumePoint>* resume, RowStatistics& statistics)
+		{
+			const double* ref_real = orbit.Real.data();
+			const double* ref_imag = orbit.Imag.data();
+
+			// `iter` counts the steps done so far. A pixel escaping on step n reports n - 1
+			// iterations, just like `GetPointIterations`.
+			std::size_t iter = first_iteration;
+			std::size_t skipped = 0;
+			std::size_t result = max_iterations;
+			double escape_norm2 = 0.0;
+			while (iter < max_iterations)
+			{
+				const BlaStep* step = bla ? FindBlaStep(*bla, m, dzr * dzr + dzi * dzi, max_iterations - iter) : nullptr;
+				if (step)
+				{
+					// dz = A * dz + B * dc
+					const double new_dzr = step->Ar * dzr - step->Ai * dzi + step->Br * dcr - step->Bi * dci;
+					const double new_dzi = step->Ar * dzi + step->Ai * dzr + step->Br * dci + step->Bi * dcr;
+					dzr = new_dzr;
+					dzi = new_dzi;
+					m += step->Length;
+					iter += step->Length;
+					skipped += step->Length;
+				}
+				else
+				{
+					// dz' = 2 * Z_m * dz + dz^2 + dc
+					const double zr_m = ref_real[m];
+					const double zi_m = ref_imag[m];
+					const double new_dzr = 2.0 * (zr_m * dzr - zi_m * dzi) + (dzr * dzr - dzi * dzi) + dcr;
+					const double new_dzi = 2.0 * (zr_m * dzi + zi_m * dzr) + 2.0 * dzr * dzi + dci;
+					dzr = new_dzr;
+					dzi = new_dzi;
+					m++;
+					iter++;
+				}
+
+				// Full value of the pixel orbit: z = Z_m + dz.
+				const double zr = ref_real[m] + dzr;
+				const double zi = ref_imag[m] + dzi;
+				const double z2 = zr * zr + zi * zi;
+				if (z2 > 4.0)
+				{
+					result = iter - 1;
+					escape_norm2 = z2;
+					break;
+				}
+
+				// Glitch: the pixel orbit got closer to 0 than to the reference, so `dz` would
+				// lose all its precision. The same happens once the reference orbit ends.
+				// Either way the pixel is rebased onto the start of the orbit (Z_0 = 0).
+				// A pixel saved for later is only rebased on a glitch: it may resume on a longer orbit.
+				const bool glitch = z2 < dzr * dzr + dzi * dzi;
+				if ((iter < max_iterations && (glitch || m == orbit.Length)) || (iter == max_iterations && resume && glitch))
+				{
+					dzr = zr;
+					dzi = zi;
+					m = 0;
+					statistics.Rebases++;
+				}
+			}
+			statistics.SkippedIterations += skipped;
+			statistics.Iterations += iter - first_iteration - skipped;
+			iterations[index] = static_cast<std::uint32_t>(result);
+			if (smooth)
+			{
+				smooth[index] = result < max_iterations ? Kernel::GetSmoothIterations(static_cast<std::uint32_t>(result), escape_norm2) : static_cast<float>(result);
+			}
+			if (resume && result == max_iterations)
+			{
+				resume->push_back({ static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(m), dzr, dzi });
+			}
+		}
+
+		RowStatistics ComputeRow(const ReferenceOrbit& orbit, const BlaTable* bla, const DeltaRowSegment& segment)
+		{
+			RowStatistics statistics;
+
+			for (std::size_t i = 0; i < segment.Count; i++)
+			{
+				const double along = (segment.FirstPixel + static_cast<double>(i)) * segment.Scale;
+				const double dcr = segment.Vertical ? segment.DeltaFixed : along;
+				const double dci = segment.Vertical ? along : segment.DeltaFixed;
+
+				IterateDelta(orbit, bla, dcr, dci, 0.0, 0.0, 0, 0, segment.MaxIterations, i, segment.Iterations, segment.Smooth, segment.Resume, statistics);
+			}
+
+			return statistics;
+		}
+
+		RowStatistics ContinuePoints(const ReferenceOrbit& orbit, const BlaTable* bla, const DeltaResumeSegment& segment)
+		{
+			RowStatistics statistics;
+
+			for (std::size_t i = 0; i < segment.Count; i++)
+			{
+				const Kernel::ResumePoint& point = segment.Points[i];
+				double dzr = point.Zr;
+				double dzi = point.Zi;
+				std::size_t m = point.Reference;
+				// Saved at the end of an orbit which did not get any longer: this is the rebase it skipped.
+				if (m == orbit.Length)
+				{
+					dzr += orbit.Real[m];
+					dzi += orbit.Imag[m];
+					m = 0;
+					statistics.Rebases++;
+				}
+				IterateDelta(orbit, bla, segment.DeltaCr[i], segment.DeltaCi[i], dzr, dzi, m, segment.StartIteration, segment.MaxIterations, i, segment.Iterations, segment.Smooth, segment.Resume, statistics);
+			}
+
+			return statistics;
+		}
+	}
+}
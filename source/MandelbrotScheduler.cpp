@@ -0,0 +1,141 @@
+#include "MandelbrotScheduler.hpp"
+#include "MandelbrotTrace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace Mandelbrot
+{
+	namespace Scheduler
+	{
+		// Each deque sits on its own cache lines: workers hammer their own lock, not their neighbour's.
+		struct alignas(CacheLineSize) WorkerQueue
+		{
+			std::mutex Mutex;
+			std::deque<std::size_t> Tiles;
+		};
+
+		std::vector<Tile> MakeTiles(std::size_t width, std::size_t height, std::size_t tile_width, std::size_t tile_height)
+		{
+			tile_width = std::max<std::size_t>(tile_width, 1);
+			tile_width = (tile_width + TileAlignment - 1) / TileAlignment * TileAlignment;
+			tile_height = std::max<std::size_t>(tile_height, 1);
+
+			std::vector<Tile> tiles;
+			tiles.reserve(((width + tile_width - 1) / tile_width) * ((height + tile_height - 1) / tile_height));
+
+			for (std::size_t y = 0; y < height; y += tile_height)
+			{
+				for (std::size_t x = 0; x < width; x += tile_width)
+				{
+					tiles.push_back({ x, y, std::min(x + tile_width, width), std::min(y + tile_height, height) });
+				}
+			}
+			return tiles;
+		}
+
+		static bool PopOwn(WorkerQueue& queue, std::size_t& tile)
+		{
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			if (queue.Tiles.empty())
+			{
+				return false;
+			}
+			tile = queue.Tiles.front();
+			queue.Tiles.pop_front();
+			return true;
+		}
+
+		static bool Steal(WorkerQueue& queue, std::size_t& tile)
+		{
+			std::lock_guard<std::mutex> lock(queue.Mutex);
+			if (queue.Tiles.empty())
+			{
+				return false;
+			}
+			tile = queue.Tiles.back();
+			queue.Tiles.pop_back();
+			return true;
+		}
+
+		static void ProcessTile(const Tile& tile, std::size_t worker, bool stolen, const TileFunction& process, std::chrono::nanoseconds& busy)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			process(tile, worker);
+			const auto end = std::chrono::steady_clock::now();
+			busy += end - start;
+			Trace::Record("tile", "tile", start, end, { { "x", tile.MinX }, { "y", tile.MinY }, { "worker", worker }, { "stolen", stolen } });
+		}
+
+		static void Work(const std::vector<Tile>& tiles, WorkerQueue* queues, std::size_t workers, std::size_t worker, const TileFunction& process, const std::atomic<bool>* cancel, std::atomic<std::size_t>& steals, std::chrono::nanoseconds& busy)
+		{
+			std::size_t tile;
+			while (true)
+			{
+				if (cancel && cancel->load(std::memory_order_relaxed))
+				{
+					return;
+				}
+
+				if (PopOwn(queues[worker], tile))
+				{
+					ProcessTile(tiles[tile], worker, false, process, busy);
+					continue;
+				}
+
+				// No tile is ever added during a run: once every deque is empty, the work is done.
+				bool stolen = false;
+				for (std::size_t i = 1; i < workers && !stolen; i++)
+				{
+					stolen = Steal(queues[(worker + i) % workers], tile);
+				}
+				if (!stolen)
+				{
+					return;
+				}
+
+				steals++;
+				ProcessTile(tiles[tile], worker, true, process, busy);
+			}
+		}
+
+		RunStatistics Run(ThreadPool& pool, const std::vector<Tile>& tiles, std::size_t workers, const TileFunction& process, const std::atomic<bool>* cancel)
+		{
+			workers = std::max<std::size_t>(std::min(workers, tiles.size()), 1);
+
+			// Every worker starts with a contiguous band of tiles: neighbours share cache lines
+			// of the plane data and of the reference orbit, and stolen tiles come from the far end.
+			std::unique_ptr<WorkerQueue[]> queues(new WorkerQueue[workers]);
+			for (std::size_t w = 0; w < workers; w++)
+			{
+				const std::size_t begin = tiles.size() * w / workers;
+				const std::size_t end = tiles.size() * (w + 1) / workers;
+				for (std::size_t t = begin; t < end; t++)
+				{
+					queues[w].Tiles.push_back(t);
+				}
+			}
+
+			std::atomic<std::size_t> steals = 0;
+			// Each worker only writes its own entry, once: the entries share cache lines.
+			RunStatistics statistics;
+			statistics.WorkerBusy.assign(workers, std::chrono::nanoseconds::zero());
+
+			pool.Run(workers, [&](std::size_t worker)
+			{
+				// Up to the last tile of the worker: the rest of the run is its wait for the others.
+				const auto start = std::chrono::steady_clock::now();
+				std::chrono::nanoseconds busy = std::chrono::nanoseconds::zero();
+				Work(tiles, queues.get(), workers, worker, process, cancel, steals, busy);
+				statistics.WorkerBusy[worker] = busy;
+				Trace::Record("worker", "worker", start, std::chrono::steady_clock::now(), { { "worker", worker }, { "busy_ns", static_cast<std::uint64_t>(busy.count()) } });
+			});
+
+			statistics.Steals = steals;
+			return statistics;
+		}
+	}
+}
@@ -0,0 +1,114 @@
+#include "MandelbrotStats.hpp"
+
+#include "MandelbrotUtils.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+namespace Mandelbrot
+{
+	namespace Stats
+	{
+		const char* GetPhaseName(Phase phase)
+		{
+			switch (phase)
+			{
+			case Phase::Compute:
+				return "compute";
+			case Phase::Colorize:
+				return "colorize";
+			case Phase::Publish:
+				return "publish";
+			case Phase::Upload:
+				return "upload";
+			case Phase::Draw:
+				return "draw";
+			}
+			return "unknown";
+		}
+
+		double FrameStats::GetEscapedFraction() const
+		{
+			const std::size_t pixels = EscapedPixels + LimitPixels;
+			return pixels > 0 ? static_cast<double>(EscapedPixels) / static_cast<double>(pixels) : 0.0;
+		}
+
+		static double ToMilliseconds(std::chrono::nanoseconds duration)
+		{
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+
+		std::string ToJson(const FrameStats& stats)
+		{
+			std::string json = fmt::format(
+				"{{\n  \"frame\": {}, \"mode\": \"{}\", \"complete\": {},\n"
+				"  \"width\": {}, \"height\": {}, \"max_iterations\": {}, \"precision\": \"{}\",\n"
+				"  \"total_ns\": {}, \"phases_ns\": {{",
+				stats.Frame, stats.Mode, stats.Complete ? "true" : "false",
+				stats.Width, stats.Height, stats.MaxIterations, GetPrecisionName(stats.FramePrecision),
+				stats.Total.count());
+			for (std::size_t p = 0; p < PhaseCount; p++)
+			{
+				json += fmt::format("{}\"{}\": {}", p > 0 ? ", " : "", GetPhaseName(static_cast<Phase>(p)), stats.Phases[p].count());
+			}
+
+			json += fmt::format(
+				"}},\n  \"iterations\": {}, \"escaped_pixels\": {}, \"limit_pixels\": {}, \"escaped_fraction\": {:.6f},\n"
+				"  \"interior_rejected_pixels\": {}, \"periodic_pixels\": {}, \"skipped_iterations\": {}, \"executed_iterations\": {},\n"
+				"  \"workers\": [",
+				stats.Iterations, stats.EscapedPixels, stats.LimitPixels, stats.GetEscapedFraction(),
+				stats.InteriorRejectedPixels, stats.PeriodicPixels, stats.SkippedIterations, stats.ExecutedIterations);
+			for (std::size_t w = 0; w < stats.WorkerBusy.size(); w++)
+			{
+				json += fmt::format("{}{{\"busy_ns\": {}, \"idle_ns\": {}}}", w > 0 ? ", " : "", stats.WorkerBusy[w].count(), stats.WorkerIdle[w].count());
+			}
+
+			json += "],\n  \"tiles\": [";
+			for (std::size_t t = 0; t < stats.Tiles.size(); t++)
+			{
+				const TileStats& tile = stats.Tiles[t];
+				json += fmt::format("{}\n    {{\"x\": {}, \"y\": {}, \"width\": {}, \"height\": {}, \"iterations\": {}, \"escaped\": {}}}",
+					t > 0 ? "," : "", tile.MinX, tile.MinY, tile.MaxX - tile.MinX, tile.MaxY - tile.MinY, tile.Iterations, tile.Escaped);
+			}
+			json += stats.Tiles.empty() ? "]\n}" : "\n  ]\n}";
+			return json;
+		}
+
+		std::string ToText(const FrameStats& stats)
+		{
+			double busy_min = 0.0;
+			double busy_max = 0.0;
+			double busy_sum = 0.0;
+			for (std::size_t w = 0; w < stats.WorkerBusy.size(); w++)
+			{
+				const double busy = stats.Total.count() > 0 ? static_cast<double>(stats.WorkerBusy[w].count()) / static_cast<double>(stats.Total.count()) : 0.0;
+				busy_min = w == 0 ? busy : std::min(busy_min, busy);
+				busy_max = w == 0 ? busy : std::max(busy_max, busy);
+				busy_sum += busy;
+			}
+			const double busy_mean = stats.WorkerBusy.empty() ? 0.0 : busy_sum / static_cast<double>(stats.WorkerBusy.size());
+
+			return fmt::format(
+				"Frame {} ({}, {}, {}x{}){}\n"
+				"Total {:.3f} ms: compute {:.3f}, colorize {:.3f}, publish {:.3f}\n"
+				"Upload {:.3f} ms, draw {:.3f} ms\n"
+				"Iterations {:.2f} M ({:.2f} M run), escaped {:.1f}%, limit {:.1f}%\n"
+				"Workers {} busy {:.1f}% (min {:.1f}%, max {:.1f}%)",
+				stats.Frame, stats.Mode, GetPrecisionName(stats.FramePrecision), stats.Width, stats.Height, stats.Complete ? "" : " cancelled",
+				ToMilliseconds(stats.Total), ToMilliseconds(stats.GetPhase(Phase::Compute)), ToMilliseconds(stats.GetPhase(Phase::Colorize)), ToMilliseconds(stats.GetPhase(Phase::Publish)),
+				ToMilliseconds(stats.GetPhase(Phase::Upload)), ToMilliseconds(stats.GetPhase(Phase::Draw)),
+				static_cast<double>(stats.Iterations) / 1e6, static_cast<double>(stats.ExecutedIterations) / 1e6, 100.0 * stats.GetEscapedFraction(), stats.EscapedPixels + stats.LimitPixels > 0 ? 100.0 - 100.0 * stats.GetEscapedFraction() : 0.0,
+				stats.WorkerBusy.size(), 100.0 * busy_mean, 100.0 * busy_min, 100.0 * busy_max);
+		}
+
+		bool WriteJson(const std::string& json, const std::string& path)
+		{
+			std::ofstream file(path, std::ios::trunc);
+			file << json << '\n';
+			return static_cast<bool>(file);
+		}
+	}
+}
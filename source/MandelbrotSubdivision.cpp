@@ -0,0 +1,248 @@
+#include "MandelbrotSubdivision.hpp"
+#include "MandelbrotTrace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace Mandelbrot
+{
+	namespace Subdivision
+	{
+		// Corners are inclusive and the border of a rectangle is always computed before it gets processed.
+		struct Rectangle
+		{
+			std::size_t MinX;
+			std::size_t MinY;
+			std::size_t MaxX;
+			std::size_t MaxY;
+		};
+
+		// Rectangles whose inside is at most this wide or tall are computed without further splits.
+		// Smaller ones save few pixels, and the short lines they need leave most SIMD lanes idle.
+		static constexpr std::size_t MinInteriorSize = 30;
+
+		// Smaller rectangles are processed by the thread which split them instead of being queued.
+		static constexpr std::size_t MinQueuedArea = 64 * 64;
+
+		struct RenderContext
+		{
+			std::size_t Width;
+			const LineFunction* ComputeLine;
+			std::uint32_t* Iterations;
+			const std::atomic<bool>* Cancel;
+
+			std::atomic<std::size_t> ComputedPixels = 0;
+			std::atomic<std::size_t> FilledPixels = 0;
+
+			std::mutex Mutex;
+			std::condition_variable Condition;
+			std::vector<Rectangle> Pending;
+			// Rectangles queued or being processed. The frame is done once it drops to zero.
+			std::size_t Active = 0;
+		};
+
+		static void ComputeRow(RenderContext& context, std::size_t x, std::size_t y, std::size_t count)
+		{
+			(*context.ComputeLine)(x, y, count, false, context.Iterations + y * context.Width + x);
+			context.ComputedPixels += count;
+		}
+
+		// Columns are computed as a whole as well, so the SIMD kernels still get full vectors.
+		static void ComputeColumn(RenderContext& context, std::size_t x, std::size_t min_y, std::size_t max_y)
+		{
+			thread_local std::vector<std::uint32_t> column;
+			column.resize(max_y - min_y);
+			(*context.ComputeLine)(x, min_y, column.size(), true, column.data());
+
+			for (std::size_t y = min_y; y < max_y; y++)
+			{
+				context.Iterations[y * context.Width + x] = column[y - min_y];
+			}
+			context.ComputedPixels += column.size();
+		}
+
+		static bool HasUniformBorder(const RenderContext& context, const Rectangle& rect)
+		{
+			const std::uint32_t* top = context.Iterations + rect.MinY * context.Width;
+			const std::uint32_t* bottom = context.Iterations + rect.MaxY * context.Width;
+			const std::uint32_t value = top[rect.MinX];
+
+			for (std::size_t x = rect.MinX; x <= rect.MaxX; x++)
+			{
+				if (top[x] != value || bottom[x] != value)
+				{
+					return false;
+				}
+			}
+			for (std::size_t y = rect.MinY + 1; y < rect.MaxY; y++)
+			{
+				const std::uint32_t* row = context.Iterations + y * context.Width;
+				if (row[rect.MinX] != value || row[rect.MaxX] != value)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		static void Push(RenderContext& context, const Rectangle& rect);
+
+		static void Process(RenderContext& context, const Rectangle& rect)
+		{
+			if (context.Cancel && context.Cancel->load(std::memory_order_relaxed))
+			{
+				return;
+			}
+			if (rect.MaxX - rect.MinX < 2 || rect.MaxY - rect.MinY < 2)
+			{
+				// No inside: the border is all there is.
+				return;
+			}
+
+			const std::size_t inner_width = rect.MaxX - rect.MinX - 1;
+			const std::size_t inner_height = rect.MaxY - rect.MinY - 1;
+
+			if (HasUniformBorder(context, rect))
+			{
+				const std::uint32_t value = context.Iterations[rect.MinY * context.Width + rect.MinX];
+				for (std::size_t y = rect.MinY + 1; y < rect.MaxY; y++)
+				{
+					std::uint32_t* row = context.Iterations + y * context.Width;
+					std::fill(row + rect.MinX + 1, row + rect.MaxX, value);
+				}
+				context.FilledPixels += inner_width * inner_height;
+				return;
+			}
+
+			if (inner_width <= MinInteriorSize || inner_height <= MinInteriorSize)
+			{
+				for (std::size_t y = rect.MinY + 1; y < rect.MaxY; y++)
+				{
+					ComputeRow(context, rect.MinX + 1, y, inner_width);
+				}
+				return;
+			}
+
+			// Splitting the longest side keeps the rectangles close to squares, whose borders are the cheapest.
+			Rectangle first = rect;
+			Rectangle second = rect;
+			if (inner_width >= inner_height)
+			{
+				const std::size_t split = rect.MinX + (rect.MaxX - rect.MinX) / 2;
+				ComputeColumn(context, split, rect.MinY + 1, rect.MaxY);
+				first.MaxX = split;
+				second.MinX = split;
+			}
+			else
+			{
+				const std::size_t split = rect.MinY + (rect.MaxY - rect.MinY) / 2;
+				ComputeRow(context, rect.MinX + 1, split, inner_width);
+				first.MaxY = split;
+				second.MinY = split;
+			}
+
+			// The two halves only share the split line, which is already computed, so they can
+			// be processed concurrently.
+			if ((rect.MaxX - rect.MinX) * (rect.MaxY - rect.MinY) / 2 >= MinQueuedArea)
+			{
+				Push(context, second);
+			}
+			else
+			{
+				Process(context, second);
+			}
+			Process(context, first);
+		}
+
+		static void Push(RenderContext& context, const Rectangle& rect)
+		{
+			{
+				std::lock_guard<std::mutex> lock(context.Mutex);
+				context.Pending.push_back(rect);
+				context.Active++;
+			}
+			context.Condition.notify_one();
+		}
+
+		static void Work(RenderContext& context, std::chrono::nanoseconds& busy)
+		{
+			std::unique_lock<std::mutex> lock(context.Mutex);
+			while (true)
+			{
+				context.Condition.wait(lock, [&context]() { return !context.Pending.empty() || context.Active == 0; });
+				if (context.Pending.empty())
+				{
+					return;
+				}
+
+				const Rectangle rect = context.Pending.back();
+				context.Pending.pop_back();
+
+				lock.unlock();
+				const auto start = std::chrono::steady_clock::now();
+				Process(context, rect);
+				busy += std::chrono::steady_clock::now() - start;
+				lock.lock();
+
+				if (--context.Active == 0)
+				{
+					context.Condition.notify_all();
+				}
+			}
+		}
+
+		Statistics Render(ThreadPool& pool, std::size_t width, std::size_t height, const LineFunction& compute_line, std::uint32_t* iterations, std::size_t threads, const std::atomic<bool>* cancel)
+		{
+			RenderContext context;
+			context.Width = width;
+			context.ComputeLine = &compute_line;
+			context.Iterations = iterations;
+			context.Cancel = cancel;
+
+			// Each worker only writes its own entry, once: the entries share cache lines. The border of the frame is computed by worker 0.
+			Statistics statistics;
+			statistics.WorkerBusy.assign(std::max<std::size_t>(threads, 1), std::chrono::nanoseconds::zero());
+
+			if (width > 0 && height > 0)
+			{
+				const auto start = std::chrono::steady_clock::now();
+				// Border of the whole frame.
+				ComputeRow(context, 0, 0, width);
+				if (height > 1)
+				{
+					ComputeRow(context, 0, height - 1, width);
+				}
+				if (height > 2)
+				{
+					ComputeColumn(context, 0, 1, height - 1);
+					if (width > 1)
+					{
+						ComputeColumn(context, width - 1, 1, height - 1);
+					}
+				}
+
+				context.Pending.push_back({ 0, 0, width - 1, height - 1 });
+				context.Active = 1;
+				statistics.WorkerBusy[0] += std::chrono::steady_clock::now() - start;
+
+				pool.Run(threads, [&context, &statistics](std::size_t worker)
+				{
+					// Rectangles are too many to trace one by one.
+					const auto run_start = std::chrono::steady_clock::now();
+					std::chrono::nanoseconds busy = std::chrono::nanoseconds::zero();
+					Work(context, busy);
+					statistics.WorkerBusy[worker] += busy;
+					Trace::Record("worker", "worker", run_start, std::chrono::steady_clock::now(), { { "worker", worker }, { "busy_ns", static_cast<std::uint64_t>(busy.count()) } });
+				});
+			}
+
+			statistics.ComputedPixels = context.ComputedPixels;
+			statistics.FilledPixels = context.FilledPixels;
+			return statistics;
+		}
+	}
+}
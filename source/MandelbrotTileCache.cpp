@@ -0,0 +1,737 @@
+#include "MandelbrotTileCache.hpp"
+
+#include "Logger.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Mandelbrot
+{
+	namespace TileCache
+	{
+		static_assert(sizeof(Key) == 40 && std::is_trivially_copyable_v<Key>, "`Key` is written to the segments as is.");
+
+		// Bookkeeping of an entry on top of its values: list node, index node and tile.
+		static constexpr std::size_t EntryOverhead = 160;
+
+		// Segments are `SegmentMagic`, then records: a header, the iterations, then the continuous iteration
+		// counts, in the byte order of the machine. Every part is a multiple of 4 bytes, so values are aligned.
+		struct RecordHeader
+		{
+			Key TileKey;
+			// 1 for tiles of a single value, `TilePixels` otherwise.
+			std::uint32_t Values;
+			std::uint32_t HasSmooth;
+		};
+
+		static_assert(sizeof(RecordHeader) == 48, "`RecordHeader` is written to the segments as is.");
+
+		static constexpr char SegmentMagic[8] = { 'M', 'D', 'B', 'P', 'A', 'C', 'K', '1' };
+
+		// Segments this process appends to are rolled over at this size, or a fourth of the disk budget.
+		static constexpr std::size_t MaxSegmentBytes = std::size_t(64) << 20;
+
+		// Shortest time between two listings of the directory, looking for the tiles other processes wrote.
+		static constexpr std::chrono::seconds RescanInterval(1);
+
+		// Segments of other processes not written to for this long are deleted: their process is gone.
+		static constexpr std::chrono::hours StaleSegmentAge(24);
+
+		// Names of the segments of this process start with it. Unique to the process, so processes sharing the
+		// directory never write to the same segment.
+		static const std::string& GetSegmentPrefix()
+		{
+			static const std::string prefix = fmt::format("{:016x}-", (std::uint64_t(std::random_device()()) << 32) | std::random_device()());
+			return prefix;
+		}
+
+		// Buffers of the tiles made in memory.
+		struct TileValues
+		{
+			std::vector<std::uint32_t> Iterations;
+			std::vector<float> Smooth;
+		};
+
+		// FNV-1a over the bytes of the key.
+		static std::uint64_t HashKey(const Key& key)
+		{
+			unsigned char bytes[sizeof(Key)];
+			std::memcpy(bytes, &key, sizeof(Key));
+
+			std::uint64_t hash = 14695981039346656037ull;
+			for (unsigned char byte : bytes)
+			{
+				hash = (hash ^ byte) * 1099511628211ull;
+			}
+			return hash;
+		}
+
+		std::size_t KeyHash::operator()(const Key& key) const
+		{
+			return HashKey(key);
+		}
+
+		static std::size_t GetValueBytes(std::size_t values, bool smooth)
+		{
+			return values * (sizeof(std::uint32_t) + (smooth ? sizeof(float) : 0));
+		}
+
+		static std::size_t GetTileBytes(const Tile& tile)
+		{
+			return GetValueBytes(tile.Values, tile.Smooth != nullptr) + EntryOverhead;
+		}
+
+		std::shared_ptr<const Tile> MakeTile(const std::uint32_t* iterations, const float* smooth)
+		{
+			auto values = std::make_shared<TileValues>();
+			const bool uniform = std::all_of(iterations, iterations + TilePixels, [iterations](std::uint32_t value) { return value == iterations[0]; })
+				&& (!smooth || std::all_of(smooth, smooth + TilePixels, [smooth](float value) { return value == smooth[0]; }));
+
+			const std::size_t count = uniform ? 1 : TilePixels;
+			values->Iterations.assign(iterations, iterations + count);
+			if (smooth)
+			{
+				values->Smooth.assign(smooth, smooth + count);
+			}
+
+			auto tile = std::make_shared<Tile>();
+			tile->Iterations = values->Iterations.data();
+			tile->Smooth = smooth ? values->Smooth.data() : nullptr;
+			tile->Values = count;
+			tile->Storage = std::move(values);
+			return tile;
+		}
+
+		void CopyTileRow(const Tile& tile, std::size_t x, std::size_t y, std::size_t count, std::uint32_t* iterations, float* smooth)
+		{
+			if (tile.Values == 1)
+			{
+				std::fill(iterations, iterations + count, tile.Iterations[0]);
+				if (smooth)
+				{
+					std::fill(smooth, smooth + count, tile.Smooth[0]);
+				}
+				return;
+			}
+
+			std::memcpy(iterations, tile.Iterations + y * TileSize + x, count * sizeof(std::uint32_t));
+			if (smooth)
+			{
+				std::memcpy(smooth, tile.Smooth + y * TileSize + x, count * sizeof(float));
+			}
+		}
+
+		// Bytes of a file from `begin` to its end, mapped read-only. Shared with every process mapping the file.
+		class MappedFile
+		{
+		private:
+			// The mapping starts at a multiple of the allocation granularity, up to `begin`.
+			void* m_View = nullptr;
+			std::size_t m_ViewSize = 0;
+			const unsigned char* m_Data = nullptr;
+			std::size_t m_Size = 0;
+
+		public:
+			MappedFile(const std::filesystem::path& path, std::size_t begin)
+			{
+				// The files are closed once mapped: the mapping keeps them open.
+#ifdef _WIN32
+				HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (file == INVALID_HANDLE_VALUE)
+				{
+					return;
+				}
+				SYSTEM_INFO system;
+				GetSystemInfo(&system);
+				const std::size_t aligned = begin - begin % system.dwAllocationGranularity;
+				LARGE_INTEGER size;
+				HANDLE mapping = GetFileSizeEx(file, &size) && static_cast<std::size_t>(size.QuadPart) > begin ? CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+				if (mapping)
+				{
+					m_ViewSize = static_cast<std::size_t>(size.QuadPart) - aligned;
+					m_View = MapViewOfFile(mapping, FILE_MAP_READ, static_cast<DWORD>(std::uint64_t(aligned) >> 32), static_cast<DWORD>(aligned & 0xFFFFFFFF), m_ViewSize);
+					CloseHandle(mapping);
+				}
+				CloseHandle(file);
+#else
+				const int file = open(path.c_str(), O_RDONLY);
+				if (file < 0)
+				{
+					return;
+				}
+				const std::size_t aligned = begin - begin % static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+				struct stat status;
+				if (fstat(file, &status) == 0 && static_cast<std::size_t>(status.st_size) > begin)
+				{
+					m_ViewSize = static_cast<std::size_t>(status.st_size) - aligned;
+					m_View = mmap(nullptr, m_ViewSize, PROT_READ, MAP_SHARED, file, static_cast<off_t>(aligned));
+					if (m_View == MAP_FAILED)
+					{
+						m_View = nullptr;
+					}
+				}
+				close(file);
+#endif
+				if (m_View)
+				{
+					m_Data = static_cast<const unsigned char*>(m_View) + (begin - aligned);
+					m_Size = m_ViewSize - (begin - aligned);
+				}
+			}
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			~MappedFile()
+			{
+				if (m_View)
+				{
+#ifdef _WIN32
+					UnmapViewOfFile(m_View);
+#else
+					munmap(m_View, m_ViewSize);
+#endif
+				}
+			}
+
+			// Byte `begin` of the file.
+			const unsigned char* GetData() const
+			{
+				return m_Data;
+			}
+
+			std::size_t GetSize() const
+			{
+				return m_Size;
+			}
+		};
+
+		// Reads the header of the record at `offset`, and checks the record lies within the mapping.
+		static bool ReadRecordHeader(const MappedFile& mapping, std::size_t offset, RecordHeader& header)
+		{
+			if (offset > mapping.GetSize() || mapping.GetSize() - offset < sizeof(RecordHeader))
+			{
+				return false;
+			}
+			std::memcpy(&header, mapping.GetData() + offset, sizeof(RecordHeader));
+			return (header.Values == 1 || header.Values == TilePixels) && header.HasSmooth <= 1
+				&& mapping.GetSize() - offset - sizeof(RecordHeader) >= GetValueBytes(header.Values, header.HasSmooth != 0);
+		}
+
+		// Tile of the record at `offset`, pointing into the mapping. Null when the record is not the one of `key`.
+		static std::shared_ptr<const Tile> ReadRecord(const Key& key, const std::shared_ptr<const MappedFile>& mapping, std::size_t offset)
+		{
+			RecordHeader header;
+			if (!ReadRecordHeader(*mapping, offset, header) || !(header.TileKey == key))
+			{
+				return nullptr;
+			}
+
+			const unsigned char* values = mapping->GetData() + offset + sizeof(RecordHeader);
+			auto tile = std::make_shared<Tile>();
+			tile->Iterations = reinterpret_cast<const std::uint32_t*>(values);
+			tile->Smooth = header.HasSmooth ? reinterpret_cast<const float*>(values + header.Values * sizeof(std::uint32_t)) : nullptr;
+			tile->Values = header.Values;
+			tile->Storage = mapping;
+			return tile;
+		}
+
+		std::shared_ptr<const Tile> Cache::Find(const Key& key, bool smooth)
+		{
+			std::shared_ptr<const MappedFile> mapping;
+			std::size_t offset = 0;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				const auto found = m_Index.find(key);
+				if (found != m_Index.end() && (!smooth || found->second->Data->Smooth))
+				{
+					m_Entries.splice(m_Entries.begin(), m_Entries, found->second);
+					m_Statistics.MemoryHits++;
+					return found->second->Data;
+				}
+
+				// Evicted, but not written yet: back to memory, to be written on its next eviction.
+				const auto pending = m_Pending.find(key);
+				if (pending != m_Pending.end() && (!smooth || pending->second->Smooth))
+				{
+					const std::shared_ptr<const Tile> tile = pending->second;
+					m_Pending.erase(pending);
+					m_Statistics.MemoryHits++;
+					Store(key, tile, false);
+					return tile;
+				}
+
+				const auto stored = m_DiskIndex.find(key);
+				if (stored == m_DiskIndex.end())
+				{
+					m_Statistics.Misses++;
+					m_MissesSinceScan++;
+					return nullptr;
+				}
+				mapping = stored->second.Mapping;
+				offset = stored->second.Offset;
+			}
+
+			// The record is read without the lock: other lookups don't wait for the disk to page it in.
+			std::shared_ptr<const Tile> tile = ReadRecord(key, mapping, offset);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (!tile || (smooth && !tile->Smooth))
+			{
+				m_Statistics.Misses++;
+				m_MissesSinceScan++;
+				return nullptr;
+			}
+			m_Statistics.DiskHits++;
+			Store(key, tile, true);
+			return tile;
+		}
+
+		void Cache::Insert(const Key& key, std::shared_ptr<const Tile> tile)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			const auto found = m_Index.find(key);
+			if (found != m_Index.end() && (!tile->Smooth || found->second->Data->Smooth))
+			{
+				m_Entries.splice(m_Entries.begin(), m_Entries, found->second);
+				return;
+			}
+			Store(key, tile, false);
+		}
+
+		void Cache::Store(const Key& key, const std::shared_ptr<const Tile>& tile, bool stored)
+		{
+			const auto found = m_Index.find(key);
+			if (found != m_Index.end())
+			{
+				m_Bytes -= GetTileBytes(*found->second->Data);
+				m_Entries.erase(found->second);
+			}
+			m_Entries.push_front({ key, tile, stored });
+			m_Index[key] = m_Entries.begin();
+			m_Bytes += GetTileBytes(*tile);
+			Evict();
+		}
+
+		void Cache::Evict()
+		{
+			while (m_Bytes > m_Budget && !m_Entries.empty())
+			{
+				Entry& last = m_Entries.back();
+				m_Bytes -= GetTileBytes(*last.Data);
+				if (!last.Stored && !m_Directory.empty())
+				{
+					m_Pending[last.TileKey] = std::move(last.Data);
+				}
+				m_Index.erase(last.TileKey);
+				m_Entries.pop_back();
+			}
+		}
+
+		void Cache::Flush()
+		{
+			std::lock_guard<std::mutex> disk_lock(m_DiskMutex);
+			std::vector<Record> pending;
+			std::filesystem::path directory;
+			std::size_t segment_bytes = 0;
+			bool rescan = false;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				const auto now = std::chrono::steady_clock::now();
+				rescan = !m_Directory.empty() && m_MissesSinceScan > 0 && now - m_LastScan >= RescanInterval;
+				if (m_Directory.empty() || (m_Pending.empty() && !rescan))
+				{
+					return;
+				}
+				if (rescan)
+				{
+					m_MissesSinceScan = 0;
+					m_LastScan = now;
+				}
+				// The tiles stay pending while they're written, so lookups still find them.
+				pending.reserve(m_Pending.size());
+				for (const auto& [key, tile] : m_Pending)
+				{
+					pending.push_back({ key, tile, 0 });
+				}
+				directory = m_Directory;
+				segment_bytes = std::min(MaxSegmentBytes, m_DiskBudget / 4);
+			}
+
+			// Other processes may have written the tiles missed since.
+			if (rescan)
+			{
+				ScanSegments(directory);
+			}
+
+			std::vector<Record> written;
+			for (Record& record : pending)
+			{
+				const Tile& tile = *record.Data;
+				const std::size_t bytes = sizeof(RecordHeader) + GetValueBytes(tile.Values, tile.Smooth != nullptr);
+				if (m_Writer.is_open() && m_WriterBytes > sizeof(SegmentMagic) && m_WriterBytes + bytes > segment_bytes)
+				{
+					PublishSegment(written);
+					written.clear();
+					m_Writer.close();
+				}
+				if (!m_Writer.is_open() && !OpenSegment(directory))
+				{
+					break;
+				}
+
+				RecordHeader header;
+				header.TileKey = record.TileKey;
+				header.Values = static_cast<std::uint32_t>(tile.Values);
+				header.HasSmooth = tile.Smooth ? 1 : 0;
+				m_Writer.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				m_Writer.write(reinterpret_cast<const char*>(tile.Iterations), static_cast<std::streamsize>(tile.Values * sizeof(std::uint32_t)));
+				if (tile.Smooth)
+				{
+					m_Writer.write(reinterpret_cast<const char*>(tile.Smooth), static_cast<std::streamsize>(tile.Values * sizeof(float)));
+				}
+				record.Offset = m_WriterBytes;
+				m_WriterBytes += bytes;
+				written.push_back(record);
+			}
+			PublishSegment(written);
+
+			// Tiles that couldn't be written are dropped too, rather than retried every frame.
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				for (const Record& record : pending)
+				{
+					const auto found = m_Pending.find(record.TileKey);
+					if (found != m_Pending.end() && found->second == record.Data)
+					{
+						m_Pending.erase(found);
+					}
+				}
+			}
+			TrimSegments();
+		}
+
+		bool Cache::OpenSegment(const std::filesystem::path& directory)
+		{
+			static std::atomic<std::uint64_t> segment_counter = 0;
+
+			const std::filesystem::path path = directory / fmt::format("{}{:08x}.pack", GetSegmentPrefix(), segment_counter++);
+			m_Writer.open(path, std::ios::binary | std::ios::trunc);
+			m_Writer.write(SegmentMagic, sizeof(SegmentMagic));
+			if (!m_Writer)
+			{
+				Logger::GetLogger()->warn("Couldn't create the tile segment \"{}\".", path.string());
+				m_Writer.close();
+				return false;
+			}
+
+			m_WriterId = m_NextSegmentId++;
+			m_WriterBytes = sizeof(SegmentMagic);
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Segments[m_WriterId] = { path, m_WriterBytes, true, {} };
+			return true;
+		}
+
+		void Cache::PublishSegment(const std::vector<Record>& written)
+		{
+			if (written.empty())
+			{
+				return;
+			}
+
+			const std::filesystem::path path = m_Segments.at(m_WriterId).Path;
+			m_Writer.flush();
+			if (!m_Writer)
+			{
+				Logger::GetLogger()->warn("Couldn't write to the tile segment \"{}\".", path.string());
+				m_Writer.close();
+				return;
+			}
+
+			// Only the records written since the last call are mapped: the ones before keep their own mappings.
+			const std::size_t begin = written.front().Offset;
+			auto mapping = std::make_shared<const MappedFile>(path, begin);
+			if (mapping->GetSize() < m_WriterBytes - begin)
+			{
+				Logger::GetLogger()->warn("Couldn't map the tile segment \"{}\".", path.string());
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Segments.at(m_WriterId).Size = m_WriterBytes;
+			for (const Record& record : written)
+			{
+				m_DiskIndex[record.TileKey] = { m_WriterId, mapping, record.Offset - begin };
+				// A tile back in memory meanwhile needn't be written again.
+				const auto found = m_Index.find(record.TileKey);
+				if (found != m_Index.end() && found->second->Data == record.Data)
+				{
+					found->second->Stored = true;
+				}
+			}
+		}
+
+		void Cache::ScanSegments(const std::filesystem::path& directory)
+		{
+			// Oldest first, so the records of newer segments override the ones of older segments.
+			std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+			std::error_code error;
+			for (const auto& file : std::filesystem::directory_iterator(directory, error))
+			{
+				if (file.path().extension() == ".pack" && file.is_regular_file(error))
+				{
+					files.emplace_back(file.last_write_time(error), file.path());
+				}
+			}
+			std::sort(files.begin(), files.end());
+
+			// Segments only change under `m_DiskMutex` as well, so they're read without `m_Mutex`.
+			std::map<std::filesystem::path, std::uint64_t> known;
+			for (const auto& [id, segment] : m_Segments)
+			{
+				known[segment.Path] = id;
+			}
+			const bool loading = known.empty();
+
+			std::map<std::uint64_t, Segment> scanned;
+			std::vector<std::pair<Key, Location>> records;
+			for (const auto& [modified, path] : files)
+			{
+				const auto found = known.find(path);
+				Segment segment;
+				std::uint64_t id = 0;
+				if (found != known.end())
+				{
+					id = found->second;
+					segment = m_Segments.at(id);
+					known.erase(found);
+					if (segment.Own || segment.Modified == modified)
+					{
+						continue;
+					}
+				}
+				else
+				{
+					segment = { path, 0, path.filename().string().starts_with(GetSegmentPrefix()), modified };
+				}
+
+				// Records appended since the segment was last indexed, up to the first partial one: the end of a segment still being written.
+				auto mapping = std::make_shared<const MappedFile>(path, segment.Size);
+				std::size_t offset = 0;
+				if (segment.Size == 0)
+				{
+					if (mapping->GetSize() < sizeof(SegmentMagic) || std::memcmp(mapping->GetData(), SegmentMagic, sizeof(SegmentMagic)) != 0)
+					{
+						continue;
+					}
+					offset = sizeof(SegmentMagic);
+					id = m_NextSegmentId++;
+				}
+
+				RecordHeader header;
+				while (ReadRecordHeader(*mapping, offset, header))
+				{
+					records.push_back({ header.TileKey, { id, mapping, offset } });
+					offset += sizeof(RecordHeader) + GetValueBytes(header.Values, header.HasSmooth != 0);
+				}
+				segment.Size += offset;
+				segment.Modified = modified;
+				scanned[id] = std::move(segment);
+			}
+
+			if (loading && !records.empty())
+			{
+				Logger::GetLogger()->info("Found {} tiles in {} segments of \"{}\".", records.size(), scanned.size(), directory.string());
+			}
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			// Segments known but not listed: the ones of other processes were deleted by them.
+			bool removed = false;
+			for (const auto& [path, id] : known)
+			{
+				if (!m_Segments.at(id).Own)
+				{
+					m_Segments.erase(id);
+					removed = true;
+				}
+			}
+			if (removed)
+			{
+				EraseLocations();
+			}
+
+			for (auto& [id, segment] : scanned)
+			{
+				m_Segments[id] = std::move(segment);
+			}
+			for (auto& [key, location] : records)
+			{
+				m_DiskIndex[key] = std::move(location);
+			}
+		}
+
+		void Cache::TrimSegments()
+		{
+			std::vector<std::filesystem::path> removed;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				std::size_t bytes = 0;
+				for (const auto& segment : m_Segments)
+				{
+					bytes += segment.second.Own ? segment.second.Size : 0;
+				}
+
+				const auto now = std::filesystem::file_time_type::clock::now();
+				for (auto segment = m_Segments.begin(); segment != m_Segments.end();)
+				{
+					const bool writing = m_Writer.is_open() && segment->first == m_WriterId;
+					const bool trimmed = segment->second.Own ? !writing && bytes > m_DiskBudget : now - segment->second.Modified > StaleSegmentAge;
+					if (!trimmed)
+					{
+						++segment;
+						continue;
+					}
+					bytes -= segment->second.Own ? segment->second.Size : 0;
+					removed.push_back(segment->second.Path);
+					segment = m_Segments.erase(segment);
+				}
+
+				if (removed.empty())
+				{
+					return;
+				}
+				EraseLocations();
+			}
+
+			// Tiles already read from a removed segment keep its mapping, and stay valid.
+			for (const std::filesystem::path& path : removed)
+			{
+				std::error_code error;
+				if (!std::filesystem::remove(path, error) && error)
+				{
+					Logger::GetLogger()->warn("Couldn't remove the tile segment \"{}\": {}.", path.string(), error.message());
+				}
+			}
+		}
+
+		void Cache::EraseLocations()
+		{
+			for (auto stored = m_DiskIndex.begin(); stored != m_DiskIndex.end();)
+			{
+				stored = m_Segments.count(stored->second.SegmentId) ? std::next(stored) : m_DiskIndex.erase(stored);
+			}
+		}
+
+		void Cache::SetBudget(std::size_t bytes)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Budget = bytes;
+			Evict();
+		}
+
+		std::size_t Cache::GetBudget() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Budget;
+		}
+
+		std::size_t Cache::GetBytes() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Bytes;
+		}
+
+		void Cache::SetDiskBudget(std::size_t bytes)
+		{
+			std::lock_guard<std::mutex> disk_lock(m_DiskMutex);
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_DiskBudget = bytes;
+			}
+			TrimSegments();
+		}
+
+		std::size_t Cache::GetDiskBudget() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_DiskBudget;
+		}
+
+		std::size_t Cache::GetDiskBytes() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			std::size_t bytes = 0;
+			for (const auto& segment : m_Segments)
+			{
+				bytes += segment.second.Own ? segment.second.Size : 0;
+			}
+			return bytes;
+		}
+
+		void Cache::SetDirectory(const std::string& path)
+		{
+			std::error_code error;
+			if (!path.empty() && !std::filesystem::create_directories(path, error) && error)
+			{
+				Logger::GetLogger()->warn("Couldn't create the tile directory \"{}\": {}. Tiles stay in memory.", path, error.message());
+				return;
+			}
+
+			std::lock_guard<std::mutex> disk_lock(m_DiskMutex);
+			m_Writer.close();
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Directory = path;
+				m_Pending.clear();
+				m_Segments.clear();
+				m_DiskIndex.clear();
+				m_MissesSinceScan = 0;
+				m_LastScan = std::chrono::steady_clock::now();
+				// The new directory has none of the tiles in memory.
+				for (Entry& entry : m_Entries)
+				{
+					entry.Stored = false;
+				}
+			}
+			if (!path.empty())
+			{
+				ScanSegments(path);
+				TrimSegments();
+			}
+		}
+
+		std::string Cache::GetDirectory() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Directory.string();
+		}
+
+		Statistics Cache::TakeStatistics()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			const Statistics statistics = m_Statistics;
+			m_Statistics = Statistics();
+			return statistics;
+		}
+	}
+}
@@ -0,0 +1,172 @@
+#include "MandelbrotTrace.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace Mandelbrot
+{
+	namespace Trace
+	{
+		// Written by its thread only. `Recorded` is published after the event it counts.
+		struct ThreadBuffer
+		{
+			std::vector<Event> Events = std::vector<Event>(BufferEvents);
+			std::atomic<std::uint64_t> Recorded = 0;
+			std::atomic<const char*> Name = nullptr;
+			// Thread id of the trace.
+			std::size_t Id = 0;
+			// Next ring of every ring, and of the free ones.
+			ThreadBuffer* Next = nullptr;
+			ThreadBuffer* NextFree = nullptr;
+		};
+
+		// Ring of the calling thread, handed back to the free rings when the thread exits.
+		struct ThreadSlot
+		{
+			ThreadBuffer* Buffer = nullptr;
+
+			~ThreadSlot();
+		};
+
+		struct TraceInternalData
+		{
+			static inline std::atomic<bool> Enabled = false;
+			static inline const std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+
+			// Guards the lists below. Rings are only as many as the threads which recorded at once, and never
+			// freed: threads may still exit, and hand theirs back, once the statics are destroyed.
+			static inline std::mutex Mutex;
+			static inline ThreadBuffer* FirstBuffer = nullptr;
+			static inline ThreadBuffer* LastBuffer = nullptr;
+			// Rings of exited threads, taken over by the next threads to record, their events kept.
+			static inline ThreadBuffer* FreeBuffers = nullptr;
+
+			static inline thread_local ThreadSlot Slot;
+			static inline thread_local const char* ThreadName = nullptr;
+		};
+
+		ThreadSlot::~ThreadSlot()
+		{
+			if (Buffer)
+			{
+				std::lock_guard<std::mutex> lock(TraceInternalData::Mutex);
+				Buffer->NextFree = TraceInternalData::FreeBuffers;
+				TraceInternalData::FreeBuffers = Buffer;
+			}
+		}
+
+		static ThreadBuffer& GetThreadBuffer()
+		{
+			ThreadSlot& slot = TraceInternalData::Slot;
+			if (!slot.Buffer)
+			{
+				// Threads come and go with every pool restart: a thread id of the trace is a track which
+				// threads that never ran at the same time take turns on.
+				std::lock_guard<std::mutex> lock(TraceInternalData::Mutex);
+				if (TraceInternalData::FreeBuffers)
+				{
+					slot.Buffer = TraceInternalData::FreeBuffers;
+					TraceInternalData::FreeBuffers = slot.Buffer->NextFree;
+				}
+				else
+				{
+					slot.Buffer = new ThreadBuffer();
+					ThreadBuffer*& last = TraceInternalData::LastBuffer;
+					slot.Buffer->Id = last ? last->Id + 1 : 1;
+					(last ? last->Next : TraceInternalData::FirstBuffer) = slot.Buffer;
+					last = slot.Buffer;
+				}
+				slot.Buffer->Name = TraceInternalData::ThreadName;
+			}
+			return *slot.Buffer;
+		}
+
+		void Enable(bool enabled)
+		{
+			TraceInternalData::Enabled = enabled;
+		}
+
+		bool IsEnabled()
+		{
+			return TraceInternalData::Enabled.load(std::memory_order_relaxed);
+		}
+
+		void SetThreadName(const char* name)
+		{
+			TraceInternalData::ThreadName = name;
+			if (TraceInternalData::Slot.Buffer)
+			{
+				TraceInternalData::Slot.Buffer->Name = name;
+			}
+		}
+
+		void Record(const char* name, const char* category, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, std::initializer_list<Argument> arguments)
+		{
+			if (!IsEnabled())
+			{
+				return;
+			}
+
+			ThreadBuffer& buffer = GetThreadBuffer();
+			const std::uint64_t recorded = buffer.Recorded.load(std::memory_order_relaxed);
+			Event& event = buffer.Events[recorded % BufferEvents];
+			event.Name = name;
+			event.Category = category;
+			event.Start = start;
+			event.Duration = end - start;
+			event.Arguments = {};
+			std::copy_n(arguments.begin(), std::min(arguments.size(), MaxArguments), event.Arguments.begin());
+			buffer.Recorded.store(recorded + 1, std::memory_order_release);
+		}
+
+		static double ToMicroseconds(std::chrono::nanoseconds duration)
+		{
+			return std::chrono::duration<double, std::micro>(duration).count();
+		}
+
+		std::string ToJson()
+		{
+			std::lock_guard<std::mutex> lock(TraceInternalData::Mutex);
+
+			std::string json = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n"
+				"{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"Mandelbrot\"}}";
+			std::uint64_t dropped = 0;
+			for (const ThreadBuffer* buffer = TraceInternalData::FirstBuffer; buffer; buffer = buffer->Next)
+			{
+				const char* name = buffer->Name.load();
+				json += fmt::format(",\n{{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": {}, \"args\": {{\"name\": \"{}\"}}}}",
+					buffer->Id, name ? name : fmt::format("thread {}", buffer->Id));
+
+				const std::uint64_t recorded = buffer->Recorded.load(std::memory_order_acquire);
+				const std::uint64_t first = recorded > BufferEvents ? recorded - BufferEvents : 0;
+				dropped += first;
+				for (std::uint64_t i = first; i < recorded; i++)
+				{
+					const Event& event = buffer->Events[i % BufferEvents];
+					json += fmt::format(",\n{{\"name\": \"{}\", \"cat\": \"{}\", \"ph\": \"X\", \"ts\": {:.3f}, \"dur\": {:.3f}, \"pid\": 1, \"tid\": {}, \"args\": {{",
+						event.Name, event.Category, ToMicroseconds(event.Start - TraceInternalData::Epoch), ToMicroseconds(event.Duration), buffer->Id);
+					for (std::size_t a = 0; a < MaxArguments && event.Arguments[a].Name; a++)
+					{
+						json += fmt::format("{}\"{}\": {}", a > 0 ? ", " : "", event.Arguments[a].Name, event.Arguments[a].Value);
+					}
+					json += "}}";
+				}
+			}
+			json += fmt::format("\n], \"otherData\": {{\"dropped_events\": {}}}}}", dropped);
+			return json;
+		}
+
+		void Clear()
+		{
+			std::lock_guard<std::mutex> lock(TraceInternalData::Mutex);
+			for (ThreadBuffer* buffer = TraceInternalData::FirstBuffer; buffer; buffer = buffer->Next)
+			{
+				buffer->Recorded = 0;
+			}
+		}
+	}
+}
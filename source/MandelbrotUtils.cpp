@@ -1,6 +1,15 @@
 #include "MandelbrotUtils.hpp"
+#include "MandelbrotKernel.hpp"
+#include "MandelbrotPerturbation.hpp"
+#include "MandelbrotScheduler.hpp"
+#include "MandelbrotSubdivision.hpp"
+#include "MandelbrotTileCache.hpp"
+#include "MandelbrotTrace.hpp"
+#include "ThreadPool.hpp"
+#include "RenderJob.hpp"
 #include "Config.hpp"
 #include "Logger.hpp"
+#include "Timer.hpp"
 
 #include <SFML/Graphics.hpp>
 
@@ -8,15 +17,55 @@
 #include <thread>
 #include <array>
 #include <functional>
+#include <algorithm>
 #include <mutex>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <future>
 
 namespace Mandelbrot
 {
 	struct MandelbrotPlaneData
 	{
 		long double Zoom;
-		long double OffsetX;
-		long double OffsetY;
+		HighPrecision OffsetX;
+		HighPrecision OffsetY;
+	};
+
+	// Colouring of a frame. Snapshotted with the plane data, so a frame never mixes two palettes.
+	struct MandelbrotColorData
+	{
+		Palette ColorPalette;
+		// Palette entries the colours are shifted by. See `SetColorCycle`.
+		std::size_t CycleOffset;
+		// Blends palette entries with the continuous iteration counts of `FrameSmooth`.
+		bool Smooth;
+		// Spreads the palette over the escape times of the frame. See `EqualizeColorTable`.
+		bool Equalized;
+		// Pixels with at least this many iterations are interior.
+		std::size_t MaxIterations;
+	};
+
+	// Render settings of a frame. Snapshotted with the plane data, so changing them never affects a frame being rendered.
+	struct MandelbrotRenderData
+	{
+		// Workers of `Pool` the frame runs on. See `SetMaxThreads`.
+		std::size_t Workers;
+		bool Subdivision;
+		bool Progressive;
+		bool PeriodicityDetection;
+		bool IncrementalPanning;
+		bool ZoomReprojection;
+		bool ResumableIterations;
+		bool TileCache;
+		bool DeepZoom;
+		bool LinearApproximation;
+		Precision MinimumPrecision;
 	};
 
 	struct MandelbrotProcessData
@@ -26,27 +75,52 @@ namespace Mandelbrot
 		std::size_t MinY;
 		std::size_t MaxY;
 		MandelbrotPlaneData Data;
+		Precision FramePrecision;
+		// Only set when `FramePrecision` is `Precision::Perturbation`.
+		std::shared_ptr<const Perturbation::ReferenceOrbit> Orbit;
+		// Only set when the linear approximation is in use as well.
+		std::shared_ptr<const Perturbation::BlaTable> Bla;
+		MandelbrotColorData Colors;
+		MandelbrotRenderData Render;
 	};
 
 	struct MandelbrotInternalData
 	{
-		static constexpr std::size_t MandelbrotArraySize = static_cast<std::size_t>(Config::WINDOW_WIDTH) * static_cast<std::size_t>(Config::WINDOW_HEIGHT);
+		// Size of the frames, see `SetResolution`. Only changed while no frame is being rendered.
+		static inline std::size_t Width = Config::WINDOW_WIDTH;
+		static inline std::size_t Height = Config::WINDOW_HEIGHT;
+		static inline std::size_t FrameSize = Width * Height;
 
+		// Only changed while no frame is being rendered, see `SetMaxThreads`.
 		static inline std::size_t ThreadCounter = std::thread::hardware_concurrency();
 
-		static inline std::size_t MaxIterations = 1000;
+		// Workers of every multi-threaded frame but the first, which is the thread rendering the frame.
+		// Started by `Init` with `ThreadCounter - 1` threads, resized by `SetMaxThreads`.
+		static inline ThreadPool Pool;
+		// Single thread running the render jobs in submission order. Declared after `Pool`,
+		// so it is stopped first: a running job may still need the workers.
+		static inline ThreadPool JobRunner;
+		// Last submitted job. Submitting a new one cancels it.
+		static inline RenderJob ActiveJob;
+		// Incremented by every change of the plane state. Render jobs are tagged with it.
+		static inline std::atomic<std::uint64_t> PlaneGeneration = 0;
+
+		// Frames only read the value snapshotted when they are submitted, see `GetColorData`.
+		static inline std::atomic<std::size_t> MaxIterations = 1000;
 		static inline std::size_t DefaultMaxIterations = MaxIterations;
 
+		// OpenGL resources are created by the first draw: they need a context, which headless renders never have.
 		struct MandelbrotVertexBuffer
 		{
-			sf::Vertex MandelbrotVertices[MandelbrotInternalData::MandelbrotArraySize];
-			sf::VertexBuffer MandelbrotBuffer = sf::VertexBuffer(sf::PrimitiveType::Points, sf::VertexBuffer::Usage::Stream);
+			// Only allocated while the vertex buffer is in use, by `PublishFrame`.
+			std::vector<sf::Vertex> MandelbrotVertices;
+			std::unique_ptr<sf::VertexBuffer> MandelbrotBuffer;
 		};
 
 		struct MandelbrotSprite
 		{
 			sf::Sprite MdSprite;
-			sf::Texture MdTexture;
+			std::unique_ptr<sf::Texture> MdTexture;
 			sf::Image MdImage;
 		};
 
@@ -57,13 +131,15 @@ namespace Mandelbrot
 		// Pointer to the draw function.
 		static inline std::function<void(sf::RenderWindow&)> DrawFncPtr;
 
-		// Pointers to Process Single-Threaded and Multi-Threaded functions.
-		static inline std::function<void(const MandelbrotProcessData&)> ProcessFncPtrSt;
-		static inline std::function<void(const MandelbrotProcessData&)> ProcessFncPtrMt;
-
 		// If true, the generation process and the draw function will use the VertexBuffer.
-		// Otherwise, a sprite is used.
-		static inline bool UsingVertexBuffer = sf::VertexBuffer::isAvailable();
+		// Otherwise, a sprite is used. Only `UseVertexBuffer` checks whether it is available,
+		// as the check itself creates an OpenGL context.
+		static inline bool UsingVertexBuffer = false;
+
+		// Colours of the frame being rendered. See `PublishFrame`.
+		static inline std::vector<sf::Color> FrameColors;
+		// Set once a frame is published, until the draw function uploads it.
+		static inline bool FrameDirty = false;
 
 		// Data of the plane. See `MandelbrotData`.
 		static inline MandelbrotPlaneData PlaneData = MandelbrotPlaneData();
@@ -72,447 +148,2734 @@ namespace Mandelbrot
 
 		static inline bool StateChanged = false;
 
-		static inline std::unordered_map<std::size_t, sf::Color> MandelbrotSetColors = {};
-
-		// Mutex used on Multi-threaded functions
+		// Precision used by the last processed frame. See `SelectPrecision`. Written under `Mutex`.
+		static inline Precision FramePrecision = Precision::Double;
+
+		static inline bool UsingDeepZoom = true;
+
+		// Reference orbit of the last perturbation frame. It is reused as long as
+		// the offset doesn't change and the max iterations don't grow.
+		static inline std::shared_ptr<const Perturbation::ReferenceOrbit> ReferenceOrbit;
+
+		static inline bool UsingLinearApproximation = true;
+
+		// BLA table of `ReferenceBlaOrbit`. It also depends on the zoom.
+		static inline std::shared_ptr<const Perturbation::BlaTable> ReferenceBla;
+		static inline std::shared_ptr<const Perturbation::ReferenceOrbit> ReferenceBlaOrbit;
+
+		// Number of pixels rebased onto the reference orbit during the current frame.
+		static inline std::atomic<std::size_t> FrameRebases = 0;
+		// Number of iterations skipped by the linear approximation during the current frame.
+		static inline std::atomic<std::size_t> FrameSkippedIterations = 0;
+		// Guarded by `Mutex`, as are the other counts of the last frame.
+		static inline std::size_t LastSkippedIterations = 0;
+		// Number of pixels found inside the main cardioid or the period-2 bulb during the current frame.
+		static inline std::atomic<std::size_t> FrameInteriorRejected = 0;
+		static inline std::size_t LastInteriorRejected = 0;
+
+		// Ends the iteration of interior pixels once their orbit is found periodic.
+		static inline bool UsingPeriodicityDetection = true;
+		// Number of pixels found periodic during the current frame.
+		static inline std::atomic<std::size_t> FramePeriodicExits = 0;
+		static inline std::size_t LastPeriodicExits = 0;
+		// Iterations the kernels actually ran during the current frame.
+		static inline std::atomic<std::uint64_t> FrameExecutedIterations = 0;
+
+		// Time each worker spent on the current frame, see `AddWorkerBusy`, and the share of the last frame each one was busy for,
+		// guarded by `Mutex`.
+		static inline std::vector<std::chrono::nanoseconds> FrameWorkerBusy;
+		static inline std::chrono::steady_clock::time_point FrameStart;
+		static inline std::vector<double> LastWorkerUtilization;
+
+		// Time the current frame spent in each phase. Compute is what the other phases leave of the frame, see `EndFrame`.
+		static inline std::array<std::chrono::nanoseconds, Stats::PhaseCount> FramePhases = {};
+		// Render mode of the current frame, see `RenderFrame`.
+		static inline const char* FrameMode = "none";
+		// Iterations of each tile of `FrameTiles`, counted by the colour kernels as the tiles are coloured. See `SetTileStatistics`.
+		static inline std::vector<Stats::TileStats> FrameTileStats;
+		static inline std::uint64_t FrameCounter = 0;
+		// Statistics of the last frame, and the last upload and draw of the drawing thread. Guarded by `Mutex`.
+		static inline Stats::FrameStats LastFrameStats;
+		static inline std::chrono::nanoseconds LastUpload = std::chrono::nanoseconds::zero();
+		static inline std::chrono::nanoseconds LastDraw = std::chrono::nanoseconds::zero();
+
+		// Frames are computed with at least this precision. See `SetMinimumPrecision`.
+		static inline Precision MinimumPrecision = Precision::Float;
+
+		// Renders frames with Mariani-Silver subdivision. See `MandelbrotSubdivision.hpp`.
+		static inline bool UsingSubdivision = false;
+		// Iterations of the whole frame being rendered. Kept once it is complete, see `RetainedFrameValid`.
+		// This is what gets coloured: `FrameColors` is always derived from it, never computed directly.
+		static inline std::vector<std::uint32_t> FrameIterations;
+		// Continuous iteration counts of the frame, only computed for frames with smooth colouring.
+		static inline std::vector<float> FrameSmooth;
+		// Guarded by `Mutex`.
+		static inline Subdivision::Statistics LastSubdivisionStatistics;
+
+		// Set once `FrameIterations` and `FrameColors` hold a complete frame of `RetainedPlaneData`.
+		// Only the render job thread touches them.
+		static inline bool RetainedFrameValid = false;
+		static inline MandelbrotPlaneData RetainedPlaneData = MandelbrotPlaneData();
+		static inline Precision RetainedPrecision = Precision::Double;
+		static inline std::size_t RetainedMaxIterations = 0;
+		// Whether `FrameSmooth` belongs to the retained frame as well.
+		static inline bool RetainedSmooth = false;
+
+		// Pans by whole pixels shift the retained frame instead of computing a new one. See `ProcessPan`.
+		static inline bool UsingIncrementalPanning = true;
+
+		// Zooms start from the retained frame resampled to the new view, and zooms by powers of two
+		// reuse its pixels. See `PreviewReprojection` and `ProcessZoom`.
+		static inline bool UsingZoomReprojection = true;
+		// The retained frame, while a new one is reprojected from it.
+		static inline std::vector<std::uint32_t> ScratchIterations;
+		static inline std::vector<float> ScratchSmooth;
+		static inline std::vector<sf::Color> ScratchColors;
+
+		// Raising the max iterations continues the pixels which reached the previous limit instead of
+		// computing the frame again. See `ProcessResume`.
+		static inline bool UsingResumableIterations = true;
+		// Pixels of the retained frame which reached its limit without being found periodic, with their orbits.
+		static inline std::vector<Kernel::ResumePoint> ResumePoints;
+		// Set when `ResumePoints` holds every such pixel of the retained frame.
+		static inline bool ResumeValid = false;
+		// Points saved by each worker during the current frame, until `MergeResumePoints`.
+		static inline std::vector<std::vector<Kernel::ResumePoint>> WorkerResumePoints;
+		static inline bool CollectingResumePoints = false;
+		// Points continued at once by a worker of `ProcessResume`.
+		static constexpr std::size_t ResumeChunkSize = 1024;
+
+		// Finished tiles are kept by zoom and grid position, and views visited again are assembled from them. See `ProcessCached`.
+		static inline bool UsingTileCache = true;
+		static inline TileCache::Cache Tiles;
+
+		// Colouring of the next frames. See `MandelbrotColorData`.
+		static inline Palette ColorPalette = Palette::Classic;
+		static inline std::size_t ColorCycle = 0;
+		static inline bool UsingSmoothColoring = false;
+		static inline bool UsingHistogramColoring = false;
+		// Escaping pixels of the frame per iteration count, counted by each worker then merged into `FrameHistogram`.
+		static inline std::vector<std::vector<std::uint32_t>> WorkerHistograms;
+		static inline std::vector<std::uint32_t> FrameHistogram;
+
+		// Renders multi-threaded frames coarse to fine. See `ProcessProgressive`.
+		static inline bool UsingProgressiveRendering = true;
+		// Pixels between two samples of the first progressive pass. Must be a power of two.
+		static constexpr std::size_t ProgressiveFirstStep = 16;
+
+		// Tiles of the screen handed out by `ProcessMt`. See `MandelbrotScheduler.hpp`.
+		static inline std::vector<Scheduler::Tile> FrameTiles = Scheduler::MakeTiles(Width, Height);
+
+		// Every progressive block must start inside the tile it belongs to.
+		static_assert(Scheduler::TileAlignment % ProgressiveFirstStep == 0 && Scheduler::DefaultTileHeight % ProgressiveFirstStep == 0);
+
+		// Colour of every iteration count of the frame being rendered, see `Kernel::ColorSegment`.
+		// Rebuilt by `BeginFrame` whenever the palette, the cycle or the max iterations change.
+		static inline std::vector<std::uint32_t> ColorTable;
+		static inline Palette ColorTablePalette = Palette::Classic;
+		static inline std::size_t ColorTableCycle = 0;
+		// Set when `ColorTable` was filled by `EqualizeColorTable` instead of `PrepareColorTable`.
+		static inline bool ColorTableEqualized = false;
+
+		// Guards the published frame and `ActiveJob`. Held by `PublishFrame`, the draw functions and `SubmitRender`.
 		static inline std::mutex Mutex = std::mutex();
 	};
 
 	void DrawVertexBuffer(sf::RenderWindow& renderer);
 	void DrawSprite(sf::RenderWindow& renderer);
 
-	void ProcessStUsingSprite(const MandelbrotProcessData& data);
-	void ProcessStUsingVertexBuffer(const MandelbrotProcessData& data);
+	// Points reaching the limit are appended to `resume`, unless it is null.
+	void ProcessRows(const MandelbrotProcessData& data, std::vector<Kernel::ResumePoint>* resume = nullptr);
+
+	// Colours of the next frames, as set by the input thread.
+	MandelbrotColorData GetColorData();
+	// Render settings of the next frames, as set by the input thread.
+	MandelbrotRenderData GetRenderData();
+	// Cancels the render job in progress, if any, and waits until it is done.
+	void CancelActiveJob();
+	// Fills `ColorTable` for `colors`, unless it already matches.
+	void PrepareColorTable(const MandelbrotColorData& colors);
+	// Counts the escaping pixels of the frame per iteration count into `FrameHistogram`, on `workers` workers.
+	void ComputeHistogram(const MandelbrotProcessData& frame, std::size_t workers, const RenderJob& job);
+	// Fills `ColorTable` from `FrameHistogram`: every iteration count takes the colour of its rank among the escaping pixels.
+	void EqualizeColorTable(const MandelbrotColorData& colors);
+	// Lookup of `ColorTable` for `colors`, without pixels yet.
+	Kernel::ColorSegment GetColorSegment(const MandelbrotColorData& colors);
+	// Colour of a pixel with `iterations` iterations, or `smooth` continuous ones with smooth colouring.
+	sf::Color GetPixelColor(const MandelbrotColorData& colors, std::uint32_t iterations, float smooth);
+	// Colours `[MinY, MaxY)` x `[MinX, MaxX)` of the frame from its iterations, and returns their counts.
+	Kernel::ColorStatistics ColorizeRows(const MandelbrotProcessData& data);
+	// Colours the whole frame tile by tile on `workers` workers, equalizing the colours first if needed. The frame is not published.
+	void ColorizeFrame(const MandelbrotProcessData& frame, std::size_t workers, const RenderJob& job);
+	// Keeps the counts of `tile`, one of `FrameTiles`, as coloured by `ColorizeRows`.
+	void SetTileStatistics(const Scheduler::Tile& tile, const Kernel::ColorStatistics& statistics);
+
+	// Renders a frame of `job` with the selected render mode. Stops early once the job is cancelled.
+	void RenderFrame(const MandelbrotProcessData& frame, const RenderJob& job);
+
+	// Whether `frame` only differs from the retained frame by its colours or a lower max iterations.
+	bool CanRecolor(const MandelbrotProcessData& frame);
+	// Colours the retained frame again, without computing any pixel. Iterations above the
+	// max iterations of `frame` are clamped to it first: those pixels don't escape anymore.
+	void ProcessRecolor(const MandelbrotProcessData& frame, const RenderJob& job);
+
+	// Whether `frame` only differs from the retained frame by a higher max iterations, and all the
+	// pixels which reached the previous limit have been saved.
+	bool CanResume(const MandelbrotProcessData& frame);
+	// Continues the saved pixels of the retained frame up to the max iterations of `frame`.
+	// Every other pixel either escaped or is known to be interior, so it keeps its count.
+	void ProcessResume(const MandelbrotProcessData& frame, const RenderJob& job);
+
+	// Starts collecting the pixels of `frame` which reach the limit, when `enabled`.
+	void BeginResumePoints(const MandelbrotProcessData& frame, bool enabled);
+	// List the kernels of `worker` append to, or null when the frame is not collecting.
+	std::vector<Kernel::ResumePoint>* GetWorkerResumePoints(std::size_t worker);
+	// Moves the points of every worker to `ResumePoints`.
+	void MergeResumePoints();
+
+	// Runs `process` over `tiles` on `workers` workers of the pool until `job` is cancelled, and adds the time they spent to the frame.
+	Scheduler::RunStatistics RunTiles(const std::vector<Scheduler::Tile>& tiles, std::size_t workers, const Scheduler::TileFunction& process, const RenderJob& job);
+	// Adds the time each worker spent on a part of the frame to `FrameWorkerBusy`.
+	void AddWorkerBusy(const std::vector<std::chrono::nanoseconds>& busy);
+
+	// Computes the whole frame tile by tile.
+	void ProcessTiled(const MandelbrotProcessData& frame, const RenderJob& job);
+
+	// Whole number of pixels the retained frame must be moved by to line up with `frame`.
+	// False when the retained frame can't be reused: the zoom, the precision or the max
+	// iterations changed, it lacks the smooth values `frame` needs, or none of its pixels would stay on screen.
+	bool GetPixelShift(const MandelbrotProcessData& frame, std::size_t max_iterations, long long& shift_x, long long& shift_y);
+	// Moves the retained frame by `shift_x` x `shift_y` pixels and only computes the strips it exposes.
+	void ProcessPan(const MandelbrotProcessData& frame, long long shift_x, long long shift_y, const RenderJob& job);
+
+	// Resamples the retained frame into the view of `frame` and publishes it right away. The retained
+	// frame is moved to the scratch buffers, where `ProcessZoom` can still read it.
+	void PreviewReprojection(const MandelbrotProcessData& frame, const RenderJob& job);
+	// Number of zoom doublings from the retained frame to `frame`: negative when zooming in.
+	// False unless the zoom changed by a power of two around the same offset, with the same
+	// precision and max iterations, which is when pixels of both frames fall on the same coordinates.
+	bool GetZoomSteps(const MandelbrotProcessData& frame, std::size_t max_iterations, int& steps);
+	// Copies the pixels `frame` shares with the scratch frame and only computes the others.
+	void ProcessZoom(const MandelbrotProcessData& frame, int steps, const RenderJob& job);
+
+	// Computes the whole frame with Mariani-Silver subdivision on `threads` threads, then colours it.
+	void ProcessSubdivided(const MandelbrotProcessData& frame, std::size_t threads, const RenderJob& job);
+
+	// Computes the frame in passes of decreasing sample spacing, each one shown as soon as it is done.
+	void ProcessProgressive(const MandelbrotProcessData& frame, const RenderJob& job);
+
+	// Cells of the tile cache grid covering a frame. See `MandelbrotTileCache.hpp`.
+	struct TileLayout
+	{
+		// Key of the top left cell, the others only differ by their tile coordinates.
+		TileCache::Key FirstKey;
+		// Grid pixel of the frame pixel (0, 0).
+		long long OriginX = 0;
+		long long OriginY = 0;
+		std::size_t Columns = 0;
+		std::size_t Rows = 0;
+		// Tile of every cell, row by row. Null when the cache lacks it, see `FindCachedTiles`.
+		std::vector<std::shared_ptr<const TileCache::Tile>> Cached;
+		std::size_t Hits = 0;
+		std::size_t DiskHits = 0;
+	};
 
-	void ProcessMtUsingVertexBuffer(const MandelbrotProcessData& data);
-	void ProcessMtUsingSprite(const MandelbrotProcessData& data);
+	// Places `frame` on the grid of its zoom. False when the offset is too far from the origin, in pixels,
+	// for `long double` to place them on the grid, as at deep zoom: the cache is not used then.
+	bool GetTileLayout(const MandelbrotProcessData& frame, std::size_t max_iterations, TileLayout& layout);
+	// Looks every cell of `layout` up in the cache.
+	void FindCachedTiles(const MandelbrotProcessData& frame, TileLayout& layout);
+	// Copies the cached cells of `layout` to the frame and computes the others, whole so that they are cached as well.
+	void ProcessCached(const MandelbrotProcessData& frame, const TileLayout& layout, const RenderJob& job);
+	// Caches the cells of `layout` lying entirely inside the finished frame, then writes the new tiles to disk.
+	void StoreFrameTiles(const MandelbrotProcessData& frame, const TileLayout& layout);
+
+	// Colours a pixel of the frame being rendered.
+	void SetPixelColor(std::size_t x, std::size_t y, const sf::Color& color);
+	// Copies the colours of the frame being rendered to the storage of the draw function,
+	// unless `job` has been cancelled. A handle without job always publishes.
+	bool PublishFrame(const RenderJob& job);
 
 	// Returns the true x-y coordinates of the Set.
 	sf::Vector2ld ScaleToPlane(const sf::Vector2ld& coords, const MandelbrotPlaneData& data);
 
+	// Returns the cheapest precision which still resolves adjacent pixels of the plane.
+	Precision SelectPrecision(const MandelbrotPlaneData& data, const MandelbrotRenderData& render);
+
+	// Picks the precision of a new frame from its plane data snapshot, computing the
+	// reference orbit if needed. Logs the precision and warns when it is exhausted.
+	void BeginFrame(MandelbrotProcessData& frame);
+	// Records the statistics of the frame, see `GetLastFrameStats`.
+	void EndFrame(const MandelbrotProcessData& frame, const RenderJob& job);
+
+	// Computes the iterations of `count` pixels starting at (x, y), going right, or down when
+	// `vertical` is set. Pixels are `stride` apart, which must be a power of two.
+	// Continuous iteration counts are stored in `smooth` as well, unless it is null.
+	// Pixels reaching the limit are appended to `resume` with their frame index, unless it is null.
+	void ComputeLineIterations(std::size_t x, std::size_t y, std::size_t count, bool vertical, std::size_t stride, const MandelbrotProcessData& frame, std::uint32_t* iterations, float* smooth = nullptr, std::vector<Kernel::ResumePoint>* resume = nullptr);
+	// Same as `ComputeLineIterations`, for pixels which may lie outside of the frame. Saved points are numbered along the line.
+	void ComputeLinePixels(long long x, long long y, std::size_t count, bool vertical, std::size_t stride, const MandelbrotProcessData& frame, std::uint32_t* iterations, float* smooth, std::vector<Kernel::ResumePoint>* resume);
+	// Computes the iterations of `count` consecutive pixels of row `y`, starting from column `x`.
+	void ComputeRowIterations(std::size_t x, std::size_t y, std::size_t count, const MandelbrotProcessData& frame, std::uint32_t* iterations, float* smooth = nullptr, std::vector<Kernel::ResumePoint>* resume = nullptr);
+	// Continues `count` saved points from `start_iteration` up to the max iterations of `frame`
+	// and stores their results in the frame. Points reaching the new limit are appended to `resume`.
+	void ContinueResumePoints(const MandelbrotProcessData& frame, const Kernel::ResumePoint* points, std::size_t count, std::size_t start_iteration, std::vector<Kernel::ResumePoint>* resume);
+
 	// Initializes the Mandelbrot set
 	void Init()
 	{
-		// Initializing Vertices screen coordinates
-		for (std::size_t y = 0; y < Config::WINDOW_HEIGHT; y++)
-		{
-			for (std::size_t x = 0; x < Config::WINDOW_WIDTH; x++)
-			{
-				std::size_t j = (y * Config::WINDOW_WIDTH) + x;
-				MandelbrotInternalData::MdVertexBuffer.MandelbrotVertices[j].position = { static_cast<float>(x), static_cast<float>(y) };
-			}
-		}
-
-		MandelbrotInternalData::MdSprite.MdImage.create(Config::WINDOW_WIDTH, Config::WINDOW_HEIGHT);
-
+		// Frame buffers are allocated by the first frame, with the resolution it is rendered at.
 		// Initializing function pointers
 		if (MandelbrotInternalData::UsingVertexBuffer)
 		{
-			MandelbrotInternalData::ProcessFncPtrSt = std::bind(Mandelbrot::ProcessStUsingVertexBuffer, std::placeholders::_1);
-			MandelbrotInternalData::ProcessFncPtrMt = std::bind(Mandelbrot::ProcessMtUsingVertexBuffer, std::placeholders::_1);
 			MandelbrotInternalData::DrawFncPtr = std::bind(Mandelbrot::DrawVertexBuffer, std::placeholders::_1);
 		}
 		else
 		{
-			MandelbrotInternalData::ProcessFncPtrSt = std::bind(Mandelbrot::ProcessStUsingSprite, std::placeholders::_1);
-			MandelbrotInternalData::ProcessFncPtrMt = std::bind(Mandelbrot::ProcessMtUsingSprite, std::placeholders::_1);
 			MandelbrotInternalData::DrawFncPtr = std::bind(Mandelbrot::DrawSprite, std::placeholders::_1);
 		}
 
-		MandelbrotInternalData::MdVertexBuffer.MandelbrotBuffer.create(MandelbrotInternalData::MandelbrotArraySize);
-		MandelbrotInternalData::MdVertexBuffer.MandelbrotBuffer.update(MandelbrotInternalData::MdVertexBuffer.MandelbrotVertices);
+		MandelbrotInternalData::Pool.Start(std::max<std::size_t>(MandelbrotInternalData::ThreadCounter, 1) - 1);
+		MandelbrotInternalData::JobRunner.Start(1);
 
 		Logger::GetLogger()->info("Mandelbrot Set Data Initialized.");
 		Logger::GetLogger()->info("\t=> Available Threads: {}", MandelbrotInternalData::ThreadCounter);
+		Logger::GetLogger()->info("\t=> Instruction Set: {}", Kernel::GetInstructionSetName(Kernel::GetInstructionSet()));
+	}
+
+	// Computes the iterations of the rows `[MinY, MaxY)` of the frame, from column `MinX` to `MaxX`.
+	void ProcessRows(const MandelbrotProcessData& data, std::vector<Kernel::ResumePoint>* resume)
+	{
+		const std::size_t row_width = data.MaxX - data.MinX;
 
-		for (std::size_t iter = 0; iter < 128; iter++)
+		for (std::size_t y = data.MinY; y < data.MaxY; y++)
 		{
-			MandelbrotInternalData::MandelbrotSetColors[iter] = GetPointColor(iter);
+			const std::size_t j = y * MandelbrotInternalData::Width + data.MinX;
+			float* smooth = data.Colors.Smooth ? MandelbrotInternalData::FrameSmooth.data() + j : nullptr;
+			ComputeRowIterations(data.MinX, y, row_width, data, MandelbrotInternalData::FrameIterations.data() + j, smooth, resume);
 		}
-		MandelbrotInternalData::MandelbrotSetColors[MandelbrotInternalData::MaxIterations] = sf::Color::Black;
 	}
 
-	void ProcessStUsingSprite(const MandelbrotProcessData& data)
+	MandelbrotColorData GetColorData()
 	{
-		for (std::size_t y = 0; y < Config::WINDOW_HEIGHT; y++)
-		{
-			for (std::size_t x = 0; x < Config::WINDOW_WIDTH; x++)
-			{
-				std::size_t j = (y * Config::WINDOW_WIDTH) + x;
-
-				// Scaling x and y coordinates to real/imaginary coords.
-				sf::Vector2ld plane_coords = ScaleToPlane(
-					{ static_cast<long double>(x), static_cast<long double>(y) },
-					MandelbrotInternalData::PlaneData
-				);
-				MandelbrotInternalData::MdSprite.MdImage.setPixel(
-					static_cast<unsigned int>(x),
-					static_cast<unsigned int>(y),
-					GetPointColor(GetPointIterations(plane_coords))
-				);
-			}
-		}
+		MandelbrotColorData colors;
+		colors.ColorPalette = MandelbrotInternalData::ColorPalette;
+		colors.CycleOffset = MandelbrotInternalData::ColorCycle;
+		colors.Smooth = MandelbrotInternalData::UsingSmoothColoring;
+		colors.Equalized = MandelbrotInternalData::UsingHistogramColoring;
+		colors.MaxIterations = MandelbrotInternalData::MaxIterations;
+		return colors;
+	}
 
-		MandelbrotInternalData::MdSprite.MdTexture.loadFromImage(MandelbrotInternalData::MdSprite.MdImage);
-		MandelbrotInternalData::MdSprite.MdSprite.setTexture(MandelbrotInternalData::MdSprite.MdTexture);
+	MandelbrotRenderData GetRenderData()
+	{
+		MandelbrotRenderData render;
+		render.Workers = std::max<std::size_t>(MandelbrotInternalData::ThreadCounter, 1);
+		// Rectangles are filled from their border, which has no continuous counts.
+		render.Subdivision = MandelbrotInternalData::UsingSubdivision && !MandelbrotInternalData::UsingSmoothColoring;
+		render.Progressive = MandelbrotInternalData::UsingProgressiveRendering;
+		render.PeriodicityDetection = MandelbrotInternalData::UsingPeriodicityDetection;
+		render.IncrementalPanning = MandelbrotInternalData::UsingIncrementalPanning;
+		render.ZoomReprojection = MandelbrotInternalData::UsingZoomReprojection;
+		render.ResumableIterations = MandelbrotInternalData::UsingResumableIterations;
+		render.TileCache = MandelbrotInternalData::UsingTileCache;
+		render.DeepZoom = MandelbrotInternalData::UsingDeepZoom;
+		render.LinearApproximation = MandelbrotInternalData::UsingLinearApproximation;
+		render.MinimumPrecision = MandelbrotInternalData::MinimumPrecision;
+		return render;
 	}
 
-	void ProcessStUsingVertexBuffer(const MandelbrotProcessData& data)
+	void CancelActiveJob()
 	{
-		for (std::size_t y = 0; y < Config::WINDOW_HEIGHT; y++)
+		RenderJob active;
 		{
-			for (std::size_t x = 0; x < Config::WINDOW_WIDTH; x++)
-			{
-				std::size_t j = (y * Config::WINDOW_WIDTH) + x;
-
-				// Scaling x and y coordinates to real/imaginary coords.
-				sf::Vector2ld plane_coords = ScaleToPlane(
-					{ static_cast<long double>(x), static_cast<long double>(y) },
-					MandelbrotInternalData::PlaneData
-				);
-
-				MandelbrotInternalData::MdVertexBuffer.MandelbrotVertices[j].color = MandelbrotInternalData::MandelbrotSetColors.at(GetPointIterations(plane_coords));
-			}
+			std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+			MandelbrotInternalData::ActiveJob.Cancel();
+			active = MandelbrotInternalData::ActiveJob;
 		}
-		MandelbrotInternalData::MdVertexBuffer.MandelbrotBuffer.update(MandelbrotInternalData::MdVertexBuffer.MandelbrotVertices);
+		active.Wait();
 	}
 
-	// Process Mandelbrot points in Single-threaded Mode
-	void ProcessSt()
+	void PrepareColorTable(const MandelbrotColorData& colors)
 	{
-		// No need to initialize `data` correctly as it won't be used by the process function.
-		MandelbrotProcessData data{ 0 };
-		MandelbrotInternalData::ProcessFncPtrSt(data);
+		auto& table = MandelbrotInternalData::ColorTable;
+		if (table.size() == colors.MaxIterations + 2
+			&& MandelbrotInternalData::ColorTablePalette == colors.ColorPalette
+			&& MandelbrotInternalData::ColorTableCycle == colors.CycleOffset
+			&& MandelbrotInternalData::ColorTableEqualized == colors.Equalized)
+		{
+			return;
+		}
+		// Equalized tables need the histogram of the whole frame, so `ColorizeFrame` fills them.
+		// Until then, progressive passes keep the previous one.
+		if (colors.Equalized && MandelbrotInternalData::ColorTableEqualized && table.size() == colors.MaxIterations + 2)
+		{
+			return;
+		}
+
+		table.resize(colors.MaxIterations + 2);
+		for (std::size_t i = 0; i < table.size(); i++)
+		{
+			table[i] = Palettes::GetEntry(colors.ColorPalette, i + colors.CycleOffset);
+		}
+		MandelbrotInternalData::ColorTablePalette = colors.ColorPalette;
+		MandelbrotInternalData::ColorTableCycle = colors.CycleOffset;
+		MandelbrotInternalData::ColorTableEqualized = false;
 	}
 
-	void ProcessMtUsingVertexBuffer(const MandelbrotProcessData& data)
+	void ComputeHistogram(const MandelbrotProcessData& frame, std::size_t workers, const RenderJob& job)
 	{
-		std::size_t min_off = (data.MinY * Config::WINDOW_WIDTH) + data.MinX;
-		std::size_t max_off = (data.MaxY * Config::WINDOW_WIDTH) + data.MaxX;
-		std::size_t vert_sz = max_off - min_off;
-
-		std::vector<sf::Vertex> vert_buffer;
-		vert_buffer.resize(vert_sz);
-
-		std::size_t off = 0;
+		// Interior pixels all land in the last bin, which keeps the counting loop free of branches.
+		const std::uint32_t max_iterations = static_cast<std::uint32_t>(frame.Colors.MaxIterations);
+		const std::size_t bins = frame.Colors.MaxIterations + 1;
+
+		workers = std::max<std::size_t>(std::min(workers, MandelbrotInternalData::FrameTiles.size()), 1);
+		auto& histograms = MandelbrotInternalData::WorkerHistograms;
+		histograms.resize(std::max(histograms.size(), workers));
+		for (std::size_t w = 0; w < workers; w++)
+		{
+			histograms[w].assign(bins, 0);
+		}
 
-		for (std::size_t y = data.MinY; y < data.MaxY; y++)
+		const Scheduler::TileFunction count_tile = [max_iterations](const Scheduler::Tile& tile, std::size_t worker)
 		{
-			for (std::size_t x = data.MinX; x < data.MaxX; x++)
+			std::uint32_t* histogram = MandelbrotInternalData::WorkerHistograms[worker].data();
+			for (std::size_t y = tile.MinY; y < tile.MaxY; y++)
 			{
-				sf::Vector2ld plane_coords = ScaleToPlane(
-					{ static_cast<long double>(x), static_cast<long double>(y) },
-					data.Data
-				);
-
-				vert_buffer[off].color = GetPointColor(GetPointIterations(plane_coords));
-				vert_buffer[off].position = { static_cast<float>(x), static_cast<float>(y) };
-				off++;
+				const std::uint32_t* row = MandelbrotInternalData::FrameIterations.data() + y * MandelbrotInternalData::Width;
+				for (std::size_t x = tile.MinX; x < tile.MaxX; x++)
+				{
+					histogram[std::min(row[x], max_iterations)]++;
+				}
 			}
-		}
-		MandelbrotInternalData::MdVertexBuffer.MandelbrotBuffer.update(vert_buffer.data(), vert_sz, static_cast<unsigned int>(min_off));
-	}
+		};
+		RunTiles(MandelbrotInternalData::FrameTiles, workers, count_tile, job);
 
-	void ProcessMtUsingSprite(const MandelbrotProcessData& data)
-	{
-		for (std::size_t y = data.MinY; y < data.MaxY; y++)
+		// Every worker sums its own range of bins over all the histograms.
+		MandelbrotInternalData::FrameHistogram.resize(bins);
+		MandelbrotInternalData::Pool.Run(workers, [workers, bins](std::size_t worker)
 		{
-			for (std::size_t x = data.MinX; x < data.MaxX; x++)
+			const Trace::Scope trace("histogram", "worker", { "worker", worker });
+			const Stats::ScopedTimer busy(MandelbrotInternalData::FrameWorkerBusy[worker]);
+			const std::size_t begin = bins * worker / workers;
+			const std::size_t end = bins * (worker + 1) / workers;
+			std::uint32_t* merged = MandelbrotInternalData::FrameHistogram.data();
+			std::fill(merged + begin, merged + end, 0);
+			for (std::size_t w = 0; w < workers; w++)
 			{
-				std::size_t j = (y * Config::WINDOW_WIDTH) + x;
-
-				// Scaling x and y coordinates to real/imaginary coords.
-				sf::Vector2ld plane_coords = ScaleToPlane(
-					{ static_cast<long double>(x), static_cast<long double>(y) },
-					data.Data
-				);
-				// Should we use `std::lock_guard<std::mutex> mutex`?
-				//std::lock_guard<std::mutex> mutex(MandelbrotInternalData::Mutex);
-				MandelbrotInternalData::MdSprite.MdImage.setPixel(
-					static_cast<unsigned int>(x),
-					static_cast<unsigned int>(y),
-					GetPointColor(GetPointIterations(plane_coords))
-				);
+				const std::uint32_t* histogram = MandelbrotInternalData::WorkerHistograms[w].data();
+				for (std::size_t b = begin; b < end; b++)
+				{
+					merged[b] += histogram[b];
+				}
 			}
-		}
+		});
 	}
 
-	// Process Mandelbrot points in Multi-threaded Mode
-	void ProcessMt()
+	void EqualizeColorTable(const MandelbrotColorData& colors)
 	{
-		const std::size_t work_on_x_axis = (Config::WINDOW_WIDTH / MandelbrotInternalData::ThreadCounter);
-		const std::size_t work_on_y_axis = (Config::WINDOW_HEIGHT / MandelbrotInternalData::ThreadCounter);
+		const auto& histogram = MandelbrotInternalData::FrameHistogram;
+		const std::size_t max_iterations = colors.MaxIterations;
 
-		std::size_t min_x = 0;
-		std::size_t max_x = work_on_x_axis;
-		std::size_t min_y = 0;
-		std::size_t max_y = work_on_y_axis;
+		std::uint64_t escaped = 0;
+		for (std::size_t i = 0; i < max_iterations; i++)
+		{
+			escaped += histogram[i];
+		}
 
-		std::vector<std::thread> threads;
-		int tid = 0;
+		// The escaping pixels are spread evenly over the first gradient of the palette.
+		const double last = static_cast<double>(Palettes::GetGradientLength(colors.ColorPalette) - 1);
+		const double scale = escaped > 0 ? last / static_cast<double>(escaped) : 0.0;
 
-		for (int i = 0; i < MandelbrotInternalData::ThreadCounter; i++)
+		auto& table = MandelbrotInternalData::ColorTable;
+		table.resize(max_iterations + 2);
+		std::uint64_t rank = 0;
+		for (std::size_t i = 0; i < max_iterations; i++)
 		{
-			for (int j = 0; j < MandelbrotInternalData::ThreadCounter; j++)
-			{
-				MandelbrotProcessData data;
-				data.Data = MandelbrotInternalData::PlaneData;
-				data.MinX = min_x;
-				data.MaxX = max_x;
-				data.MinY = min_y;
-				data.MaxY = max_y;
+			rank += histogram[i];
+			table[i] = Palettes::GetBlendedEntry(colors.ColorPalette, static_cast<double>(rank) * scale + static_cast<double>(colors.CycleOffset));
+		}
+		// Only blended into by smooth colouring, from the last escaping count.
+		table[max_iterations] = Palettes::GetBlendedEntry(colors.ColorPalette, last + static_cast<double>(colors.CycleOffset));
+		table[max_iterations + 1] = table[max_iterations];
 
-				//Logger::GetLogger()->trace("TID=[{}] - min_x={} - max_x={} - min_y={} - max_y={}", tid, data.MinX, data.MaxX, data.MinY, data.MaxY);
+		MandelbrotInternalData::ColorTablePalette = colors.ColorPalette;
+		MandelbrotInternalData::ColorTableCycle = colors.CycleOffset;
+		MandelbrotInternalData::ColorTableEqualized = true;
+	}
 
-				// Pushing the new thread to the vector
-				threads.push_back(std::thread(MandelbrotInternalData::ProcessFncPtrMt, data));
-				// Updating the workload of the next thread.
-				min_x = max_x;
-				max_x += work_on_x_axis;
-				tid++;
-			}
-			// Updating the Y workload for the next row of threads.
-			min_y = max_y;
-			max_y += work_on_y_axis;
-			// Resetting the X workload for the next row of threads.
-			min_x = 0;
-			max_x = work_on_x_axis;
-		}
+	Kernel::ColorSegment GetColorSegment(const MandelbrotColorData& colors)
+	{
+		Kernel::ColorSegment segment;
+		segment.Table = MandelbrotInternalData::ColorTable.data();
+		segment.MaxIterations = static_cast<std::uint32_t>(colors.MaxIterations);
+		segment.Interior = Palettes::InteriorColor;
+		segment.Count = 0;
+		segment.Iterations = nullptr;
+		segment.Smooth = nullptr;
+		segment.Colors = nullptr;
+		return segment;
+	}
+
+	sf::Color GetPixelColor(const MandelbrotColorData& colors, std::uint32_t iterations, float smooth)
+	{
+		Kernel::ColorSegment segment = GetColorSegment(colors);
+		// Only tells `GetTableColor` to blend.
+		segment.Smooth = colors.Smooth ? &smooth : nullptr;
+		const std::uint32_t color = Kernel::GetTableColor(segment, iterations, smooth);
+		return { static_cast<sf::Uint8>(color), static_cast<sf::Uint8>(color >> 8), static_cast<sf::Uint8>(color >> 16), static_cast<sf::Uint8>(color >> 24) };
+	}
+
+	Kernel::ColorStatistics ColorizeRows(const MandelbrotProcessData& data)
+	{
+		Kernel::ColorSegment segment = GetColorSegment(data.Colors);
+		segment.Count = data.MaxX - data.MinX;
 
-		for (auto& t : threads)
+		Kernel::ColorStatistics statistics;
+		for (std::size_t y = data.MinY; y < data.MaxY; y++)
 		{
-			t.join();
+			const std::size_t j = y * MandelbrotInternalData::Width + data.MinX;
+			segment.Iterations = MandelbrotInternalData::FrameIterations.data() + j;
+			segment.Smooth = data.Colors.Smooth ? MandelbrotInternalData::FrameSmooth.data() + j : nullptr;
+			segment.Colors = reinterpret_cast<std::uint8_t*>(MandelbrotInternalData::FrameColors.data() + j);
+			const Kernel::ColorStatistics row = Kernel::ColorizeRow(segment);
+			statistics.Iterations += row.Iterations;
+			statistics.Escaped += row.Escaped;
 		}
+		return statistics;
 	}
 
-	// Returns the true x-y coordinates of the Set.
-	sf::Vector2ld ScaleToPlane(const sf::Vector2ld& coords)
+	void ColorizeFrame(const MandelbrotProcessData& frame, std::size_t workers, const RenderJob& job)
 	{
-		sf::Vector2ld plane_coords;
-		plane_coords.x = (coords.x - Mandelbrot::Config::WINDOW_WIDTH / 2.0) * GetZoom() + GetOffset().x;
-		plane_coords.y = (coords.y - Mandelbrot::Config::WINDOW_HEIGHT / 2.0) * GetZoom() + GetOffset().y;
-		return plane_coords;
+		const Trace::Scope trace("colorize", "phase");
+		const Stats::ScopedTimer phase(MandelbrotInternalData::FramePhases[static_cast<std::size_t>(Stats::Phase::Colorize)]);
+		if (frame.Colors.Equalized)
+		{
+			Timer timer;
+			timer.start();
+			ComputeHistogram(frame, workers, job);
+			EqualizeColorTable(frame.Colors);
+			Logger::GetLogger()->trace("Histogram: {} ms.", timer.elapsedMilliseconds());
+		}
+
+		const Scheduler::TileFunction colorize_tile = [&frame](const Scheduler::Tile& tile, std::size_t)
+		{
+			MandelbrotProcessData data = frame;
+			data.MinX = tile.MinX;
+			data.MaxX = tile.MaxX;
+			data.MinY = tile.MinY;
+			data.MaxY = tile.MaxY;
+			SetTileStatistics(tile, ColorizeRows(data));
+		};
+		RunTiles(MandelbrotInternalData::FrameTiles, workers, colorize_tile, job);
 	}
 
-	sf::Vector2ld ScaleToPlane(const sf::Vector2ld& coords, const MandelbrotPlaneData& data)
+	void SetTileStatistics(const Scheduler::Tile& tile, const Kernel::ColorStatistics& statistics)
 	{
-		sf::Vector2ld plane_coords;
-		plane_coords.x = (coords.x - Mandelbrot::Config::WINDOW_WIDTH / 2.0) * data.Zoom + data.OffsetX;
-		plane_coords.y = (coords.y - Mandelbrot::Config::WINDOW_HEIGHT / 2.0) * data.Zoom + data.OffsetY;
-		return plane_coords;
+		// The scheduler hands out references into the tile list.
+		Stats::TileStats& stats = MandelbrotInternalData::FrameTileStats[static_cast<std::size_t>(&tile - MandelbrotInternalData::FrameTiles.data())];
+		stats.Iterations = statistics.Iterations;
+		stats.Escaped = statistics.Escaped;
 	}
 
-	std::size_t GetPointIterations(const sf::Vector2ld& plane_coords)
+	// Process Mandelbrot points in Single-threaded Mode
+	void ProcessSt()
 	{
-		long double zReal = plane_coords.x;
-		long double zImag = plane_coords.y;
+		// The frame buffers are shared with the render jobs, which must be done with them first.
+		CancelActiveJob();
 
-#pragma omp parallel for
-		for (std::size_t iter = 0; iter < MandelbrotInternalData::MaxIterations; iter++) {
-			long double r2 = zReal * zReal;
-			long double i2 = zImag * zImag;
-			if (r2 + i2 > 4.0)
+		// Only the frame data set by `BeginFrame` is used by the single-threaded functions.
+		MandelbrotProcessData data{ 0 };
+		data.Data = MandelbrotInternalData::PlaneData;
+		data.Colors = GetColorData();
+		data.Render = GetRenderData();
+		data.Render.Workers = 1;
+		BeginFrame(data);
+		MandelbrotInternalData::RetainedFrameValid = false;
+		MandelbrotInternalData::ResumeValid = false;
+		if (data.Render.Subdivision)
+		{
+			MandelbrotInternalData::FrameMode = "subdivision";
+			ProcessSubdivided(data, 1, RenderJob());
+		}
+		else
+		{
+			MandelbrotInternalData::FrameMode = "single";
+			data.MaxX = MandelbrotInternalData::Width;
+			data.MaxY = MandelbrotInternalData::Height;
 			{
-				return iter;
+				const Stats::ScopedTimer busy(MandelbrotInternalData::FrameWorkerBusy[0]);
+				ProcessRows(data);
 			}
-			zImag = 2.0 * zReal * zImag + plane_coords.y;
-			zReal = r2 - i2 + plane_coords.x;
+			ColorizeFrame(data, 1, RenderJob());
+			PublishFrame(RenderJob());
 		}
-		return MandelbrotInternalData::MaxIterations;
+		EndFrame(data, RenderJob());
 	}
 
-	void SetMaxIterations(std::size_t iter)
+	// Process Mandelbrot points in Multi-threaded Mode
+	void ProcessMt()
 	{
-		MandelbrotInternalData::MaxIterations = iter;
-		MandelbrotInternalData::MandelbrotSetColors[MandelbrotInternalData::MaxIterations] = sf::Color::Black;
+		SubmitRender().Wait();
 	}
 
-	std::size_t GetMaxIterations()
+	RenderJob SubmitRender()
 	{
-		return MandelbrotInternalData::MaxIterations;
-	}
+		// The plane, the colours and the settings are only changed by the thread submitting jobs, so they are snapshotted here.
+		MandelbrotProcessData frame{ 0 };
+		frame.Data = MandelbrotInternalData::PlaneData;
+		frame.Colors = GetColorData();
+		frame.Render = GetRenderData();
 
-	void SetDefaultMaxIterations(std::size_t iter)
-	{
-		if (iter > 0)
+		RenderJob job(MandelbrotInternalData::PlaneGeneration);
 		{
-			MandelbrotInternalData::DefaultMaxIterations = iter;
+			// Under the publication lock: once this returns, the cancelled job can't publish anymore.
+			std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+			MandelbrotInternalData::ActiveJob.Cancel();
+			MandelbrotInternalData::ActiveJob = job;
 		}
-	}
 
-	std::size_t GetDefaultMaxIterations()
-	{
-		return MandelbrotInternalData::DefaultMaxIterations;
+		MandelbrotInternalData::JobRunner.Submit([frame, job]() mutable
+		{
+			Trace::SetThreadName("render");
+			if (job.IsCancelled())
+			{
+				Logger::GetLogger()->trace("Render job {} dropped before starting.", job.GetGeneration());
+			}
+			else
+			{
+				BeginFrame(frame);
+				RenderFrame(frame, job);
+				EndFrame(frame, job);
+
+				if (job.IsCancelled())
+				{
+					Logger::GetLogger()->trace("Render job {} cancelled.", job.GetGeneration());
+				}
+			}
+			job.Finish();
+		});
+		return job;
 	}
 
-	sf::Color GetPointColor(std::size_t iterations)
+	void RenderFrame(const MandelbrotProcessData& frame, const RenderJob& job)
 	{
-		uint8_t r, g, b;
+		const std::size_t max_iterations = frame.Colors.MaxIterations;
 
-		if (iterations == MandelbrotInternalData::MaxIterations)
+		// Nothing to compute: the retained frame only gets new colours.
+		if (CanRecolor(frame))
 		{
-			return { 0, 0, 0 };
+			// Clamped iterations no longer hold for the previous limit, even in a cancelled frame.
+			const bool clamping = MandelbrotInternalData::RetainedMaxIterations > max_iterations;
+			MandelbrotInternalData::FrameMode = "recolor";
+			ProcessRecolor(frame, job);
+			if (clamping)
+			{
+				MandelbrotInternalData::RetainedFrameValid = !job.IsCancelled();
+				MandelbrotInternalData::RetainedMaxIterations = max_iterations;
+				MandelbrotInternalData::ResumeValid = false;
+			}
+			return;
 		}
-		else if (iterations == 0)
+
+		// Only the pixels stopped by the previous limit are computed.
+		if (CanResume(frame))
+		{
+			// The buffers are updated in place: a cancelled frame leaves them mixed.
+			MandelbrotInternalData::RetainedFrameValid = false;
+			MandelbrotInternalData::ResumeValid = false;
+			MandelbrotInternalData::FrameMode = "resume";
+			ProcessResume(frame, job);
+			if (!job.IsCancelled())
+			{
+				MandelbrotInternalData::RetainedFrameValid = true;
+				MandelbrotInternalData::RetainedMaxIterations = max_iterations;
+				MandelbrotInternalData::ResumeValid = true;
+			}
+			return;
+		}
+
+		long long shift_x = 0;
+		long long shift_y = 0;
+		const bool panning = frame.Render.IncrementalPanning && GetPixelShift(frame, max_iterations, shift_x, shift_y);
+
+		// Views on the grid of the tile cache are assembled from the tiles it has, and leave it theirs.
+		// Subdivided frames fill pixels without computing them, so they are kept out of it.
+		TileLayout layout;
+		const bool caching = frame.Render.TileCache && !frame.Render.Subdivision && GetTileLayout(frame, max_iterations, layout);
+		if (caching && !panning)
+		{
+			FindCachedTiles(frame, layout);
+		}
+		const bool assembling = caching && !panning && layout.Hits > 0;
+
+		// Any other change of view starts from the retained frame resampled to it, so the screen never goes blank.
+		// Views the cache has whole are shown right away instead.
+		const bool reprojecting = !panning
+			&& !(assembling && layout.Hits == layout.Cached.size())
+			&& frame.Render.ZoomReprojection
+			&& MandelbrotInternalData::RetainedFrameValid;
+		int zoom_steps = 0;
+		const bool zooming = reprojecting && !assembling && GetZoomSteps(frame, max_iterations, zoom_steps);
+		if (reprojecting)
+		{
+			PreviewReprojection(frame, job);
+		}
+
+		// Pixels reaching the limit are saved by the modes which iterate every pixel they don't keep.
+		// Subdivision fills pixels without iterating them, and `long double` orbits don't fit a `ResumePoint`.
+		const bool resumable = frame.Render.ResumableIterations
+			&& !zooming
+			&& !assembling
+			&& (panning ? MandelbrotInternalData::ResumeValid : !frame.Render.Subdivision)
+			&& (frame.FramePrecision == Precision::Float || frame.FramePrecision == Precision::Double || frame.FramePrecision == Precision::Perturbation);
+
+		// The buffers are overwritten from here on, whatever the mode.
+		MandelbrotInternalData::RetainedFrameValid = false;
+		MandelbrotInternalData::ResumeValid = false;
+		BeginResumePoints(frame, resumable);
+		if (!panning)
+		{
+			MandelbrotInternalData::ResumePoints.clear();
+		}
+
+		if (panning)
+		{
+			MandelbrotInternalData::FrameMode = "pan";
+			ProcessPan(frame, shift_x, shift_y, job);
+		}
+		else if (assembling)
 		{
-			return { 255, 0, 0 };
+			MandelbrotInternalData::FrameMode = "cached";
+			ProcessCached(frame, layout, job);
 		}
-		// colour gradient:      Red -> Blue -> Green -> Red -> Black
-		// corresponding values:  0  ->  16  ->  32   -> 64  ->  127 (or -1)
-		if (iterations < 16)
+		else if (zooming)
 		{
-			r = 16 * (16 - (uint8_t)iterations);
-			g = 0;
-			b = 16 * (uint8_t)iterations - 1;
+			MandelbrotInternalData::FrameMode = "zoom";
+			ProcessZoom(frame, zoom_steps, job);
 		}
-		else if ((uint8_t)iterations < 32)
+		else if (frame.Render.Subdivision)
 		{
-			r = 0;
-			g = 16 * ((uint8_t)iterations - 16);
-			b = 16 * (32 - (uint8_t)iterations) - 1;
+			MandelbrotInternalData::FrameMode = "subdivision";
+			ProcessSubdivided(frame, frame.Render.Workers, job);
 		}
-		else if ((uint8_t)iterations < 64)
+		else if (frame.Render.Progressive)
 		{
-			r = 8 * ((uint8_t)iterations - 32);
-			g = 8 * (64 - (uint8_t)iterations) - 1;
-			b = 0;
+			MandelbrotInternalData::FrameMode = "progressive";
+			ProcessProgressive(frame, job);
 		}
 		else
-		{ // range is 64 - 127
-			r = 255 - ((uint8_t)iterations - 64) * 4;
-			g = 0;
-			b = 0;
+		{
+			MandelbrotInternalData::FrameMode = "tiled";
+			ProcessTiled(frame, job);
 		}
 
-		return sf::Color{ r, g, b, 255 };
+		// A cancelled frame is incomplete.
+		if (!job.IsCancelled())
+		{
+			MandelbrotInternalData::RetainedFrameValid = true;
+			MandelbrotInternalData::RetainedPlaneData = frame.Data;
+			MandelbrotInternalData::RetainedPrecision = frame.FramePrecision;
+			MandelbrotInternalData::RetainedMaxIterations = max_iterations;
+			MandelbrotInternalData::RetainedSmooth = frame.Colors.Smooth;
+			MandelbrotInternalData::ResumeValid = resumable;
+
+			// The tiles computed while assembling are already cached.
+			if (caching && !assembling)
+			{
+				StoreFrameTiles(frame, layout);
+			}
+		}
 	}
 
-	void SetMaxThreads(std::size_t threads)
+	bool CanRecolor(const MandelbrotProcessData& frame)
 	{
-		MandelbrotInternalData::ThreadCounter = threads;
+		const MandelbrotPlaneData& retained = MandelbrotInternalData::RetainedPlaneData;
+		return MandelbrotInternalData::RetainedFrameValid
+			&& MandelbrotInternalData::RetainedPrecision == frame.FramePrecision
+			&& MandelbrotInternalData::RetainedMaxIterations >= frame.Colors.MaxIterations
+			&& (MandelbrotInternalData::RetainedSmooth || !frame.Colors.Smooth)
+			&& retained.Zoom == frame.Data.Zoom
+			&& retained.OffsetX == frame.Data.OffsetX
+			&& retained.OffsetY == frame.Data.OffsetY;
 	}
 
-	std::size_t GetMaxThreads()
+	void ProcessRecolor(const MandelbrotProcessData& frame, const RenderJob& job)
 	{
-		return MandelbrotInternalData::ThreadCounter;
-	}
+		Timer timer;
+		timer.start();
 
-	void UseVertexBuffer(bool enable)
-	{
-		MandelbrotInternalData::UsingVertexBuffer = enable;
+		// A pixel escaping after the new limit would now reach it, and interior ones are at the old limit.
+		const std::uint32_t max_iterations = static_cast<std::uint32_t>(frame.Colors.MaxIterations);
+		const bool clamping = MandelbrotInternalData::RetainedMaxIterations > max_iterations;
 
-		// Use VertexBuffer
-		if (sf::VertexBuffer::isAvailable() && enable)
+		// Equalized colours depend on the clamped counts of the whole frame, so they are a second pass.
+		const bool equalized = frame.Colors.Equalized;
+
+		const Scheduler::TileFunction process_tile = [&frame, max_iterations, clamping, equalized](const Scheduler::Tile& tile, std::size_t)
 		{
-			MandelbrotInternalData::ProcessFncPtrSt = std::bind(Mandelbrot::ProcessStUsingVertexBuffer, std::placeholders::_1);
-			MandelbrotInternalData::ProcessFncPtrMt = std::bind(Mandelbrot::ProcessMtUsingVertexBuffer, std::placeholders::_1);
-			MandelbrotInternalData::DrawFncPtr = std::bind(Mandelbrot::DrawVertexBuffer, std::placeholders::_1);
+			MandelbrotProcessData data = frame;
+			data.MinX = tile.MinX;
+			data.MaxX = tile.MaxX;
+			data.MinY = tile.MinY;
+			data.MaxY = tile.MaxY;
+
+			if (clamping)
+			{
+				for (std::size_t y = tile.MinY; y < tile.MaxY; y++)
+				{
+					for (std::size_t j = y * MandelbrotInternalData::Width + tile.MinX; j < y * MandelbrotInternalData::Width + tile.MaxX; j++)
+					{
+						if (MandelbrotInternalData::FrameIterations[j] > max_iterations)
+						{
+							MandelbrotInternalData::FrameIterations[j] = max_iterations;
+							if (frame.Colors.Smooth)
+							{
+								MandelbrotInternalData::FrameSmooth[j] = static_cast<float>(max_iterations);
+							}
+						}
+					}
+				}
+			}
+			if (!equalized)
+			{
+				SetTileStatistics(tile, ColorizeRows(data));
+			}
+		};
+		if (clamping || !equalized)
+		{
+			const Trace::Scope trace("colorize", "phase");
+			const Stats::ScopedTimer phase(MandelbrotInternalData::FramePhases[static_cast<std::size_t>(Stats::Phase::Colorize)]);
+			RunTiles(MandelbrotInternalData::FrameTiles, frame.Render.Workers, process_tile, job);
 		}
-		// Use Sprite
-		else if(enable && !sf::VertexBuffer::isAvailable() || !enable)
+		if (equalized)
 		{
-			MandelbrotInternalData::ProcessFncPtrSt = std::bind(Mandelbrot::ProcessStUsingSprite, std::placeholders::_1);
-			MandelbrotInternalData::ProcessFncPtrMt = std::bind(Mandelbrot::ProcessMtUsingSprite, std::placeholders::_1);
-			MandelbrotInternalData::DrawFncPtr = std::bind(Mandelbrot::DrawSprite, std::placeholders::_1);
+			ColorizeFrame(frame, frame.Render.Workers, job);
 		}
-	}
+		PublishFrame(job);
 
-	bool IsUsingVertexBuffer()
-	{
-		return MandelbrotInternalData::UsingVertexBuffer;
+		Logger::GetLogger()->trace("Recolor: {} ms{}.", timer.elapsedMilliseconds(), clamping ? ", iterations clamped" : "");
 	}
 
-	void DrawMandelbrotSet(sf::RenderWindow& renderer)
+	bool CanResume(const MandelbrotProcessData& frame)
 	{
-		MandelbrotInternalData::DrawFncPtr(renderer);
+		const MandelbrotPlaneData& retained = MandelbrotInternalData::RetainedPlaneData;
+		return frame.Render.ResumableIterations
+			&& MandelbrotInternalData::RetainedFrameValid
+			&& MandelbrotInternalData::ResumeValid
+			&& MandelbrotInternalData::RetainedPrecision == frame.FramePrecision
+			&& MandelbrotInternalData::RetainedMaxIterations < frame.Colors.MaxIterations
+			&& (MandelbrotInternalData::RetainedSmooth || !frame.Colors.Smooth)
+			&& retained.Zoom == frame.Data.Zoom
+			&& retained.OffsetX == frame.Data.OffsetX
+			&& retained.OffsetY == frame.Data.OffsetY;
 	}
 
-	void DrawVertexBuffer(sf::RenderWindow& renderer)
+	void ProcessResume(const MandelbrotProcessData& frame, const RenderJob& job)
 	{
-		renderer.draw(MandelbrotInternalData::MdVertexBuffer.MandelbrotBuffer);
+		Timer timer;
+		timer.start();
+
+		const std::uint32_t previous_max = static_cast<std::uint32_t>(MandelbrotInternalData::RetainedMaxIterations);
+		const std::uint32_t max_iterations = static_cast<std::uint32_t>(frame.Colors.MaxIterations);
+
+		// Pixels at the previous limit are either interior or saved: the saved ones get overwritten below.
+		std::uint32_t* iterations = MandelbrotInternalData::FrameIterations.data();
+		float* smooth = MandelbrotInternalData::RetainedSmooth ? MandelbrotInternalData::FrameSmooth.data() : nullptr;
+		for (std::size_t j = 0; j < MandelbrotInternalData::FrameSize; j++)
+		{
+			if (iterations[j] == previous_max)
+			{
+				iterations[j] = max_iterations;
+				if (smooth)
+				{
+					smooth[j] = static_cast<float>(max_iterations);
+				}
+			}
+		}
+
+		const std::vector<Kernel::ResumePoint> points = std::move(MandelbrotInternalData::ResumePoints);
+		MandelbrotInternalData::ResumePoints.clear();
+		BeginResumePoints(frame, true);
+
+		// Saved points are spread all over the frame, so workers just take the next chunk of them.
+		const std::size_t chunks = (points.size() + MandelbrotInternalData::ResumeChunkSize - 1) / MandelbrotInternalData::ResumeChunkSize;
+		std::atomic<std::size_t> next_chunk = 0;
+		MandelbrotInternalData::Pool.Run(std::min(frame.Render.Workers, std::max<std::size_t>(chunks, 1)), [&](std::size_t worker)
+		{
+			const Trace::Scope trace("resume", "worker", { "worker", worker });
+			const Stats::ScopedTimer busy(MandelbrotInternalData::FrameWorkerBusy[worker]);
+			for (std::size_t chunk = next_chunk++; chunk < chunks && !job.IsCancelled(); chunk = next_chunk++)
+			{
+				const std::size_t first = chunk * MandelbrotInternalData::ResumeChunkSize;
+				const std::size_t count = std::min(MandelbrotInternalData::ResumeChunkSize, points.size() - first);
+				ContinueResumePoints(frame, points.data() + first, count, previous_max, GetWorkerResumePoints(worker));
+			}
+		});
+		MergeResumePoints();
+
+		ColorizeFrame(frame, frame.Render.Workers, job);
+		PublishFrame(job);
+
+		Logger::GetLogger()->trace("Resume: {} pixels continued from {} to {} iterations, {} still running, {} ms.", points.size(), previous_max, max_iterations, MandelbrotInternalData::ResumePoints.size(), timer.elapsedMilliseconds());
 	}
-	
-	void DrawSprite(sf::RenderWindow& renderer)
+
+	void BeginResumePoints(const MandelbrotProcessData& frame, bool enabled)
 	{
-		// Sprite must be updated here, otherwise, a black image would be drawn to the screen.
-		// I don't what causes that. Probably is related to the fact the one or more thread exists
-		// before others and the texture and sprite are updated before every thread being done.
-		// The `std::lock_guard` isn't needed also. The resource(sprite, texture and image) could be free at any time in the process thread.
-		MandelbrotInternalData::MdSprite.MdTexture.loadFromImage(MandelbrotInternalData::MdSprite.MdImage);
-		MandelbrotInternalData::MdSprite.MdSprite.setTexture(MandelbrotInternalData::MdSprite.MdTexture);
-		renderer.draw(MandelbrotInternalData::MdSprite.MdSprite);
+		// Saved points number their pixel on 32 bits.
+		MandelbrotInternalData::CollectingResumePoints = enabled && MandelbrotInternalData::FrameSize <= std::numeric_limits<std::uint32_t>::max();
+		MandelbrotInternalData::WorkerResumePoints.resize(frame.Render.Workers);
+		for (auto& points : MandelbrotInternalData::WorkerResumePoints)
+		{
+			points.clear();
+		}
 	}
 
-	void SetZoom(const long double& zoom)
+	std::vector<Kernel::ResumePoint>* GetWorkerResumePoints(std::size_t worker)
 	{
-		MandelbrotInternalData::PreviousPlaneData.Zoom = MandelbrotInternalData::PlaneData.Zoom;
-
-		MandelbrotInternalData::StateChanged = true;
-
-		MandelbrotInternalData::PlaneData.Zoom = zoom;
+		if (!MandelbrotInternalData::CollectingResumePoints || worker >= MandelbrotInternalData::WorkerResumePoints.size())
+		{
+			return nullptr;
+		}
+		return &MandelbrotInternalData::WorkerResumePoints[worker];
 	}
 
-	long double GetZoom()
+	void MergeResumePoints()
 	{
-		return MandelbrotInternalData::PlaneData.Zoom;
+		for (auto& points : MandelbrotInternalData::WorkerResumePoints)
+		{
+			MandelbrotInternalData::ResumePoints.insert(MandelbrotInternalData::ResumePoints.end(), points.begin(), points.end());
+			points.clear();
+		}
+		MandelbrotInternalData::CollectingResumePoints = false;
 	}
 
-	void SetDefaultZoom(long double zoom)
+	Scheduler::RunStatistics RunTiles(const std::vector<Scheduler::Tile>& tiles, std::size_t workers, const Scheduler::TileFunction& process, const RenderJob& job)
 	{
-		MandelbrotInternalData::DefaultPlaneData.Zoom = zoom;
+		const Scheduler::RunStatistics statistics = Scheduler::Run(MandelbrotInternalData::Pool, tiles, workers, process, job.GetCancellationToken());
+		AddWorkerBusy(statistics.WorkerBusy);
+		return statistics;
 	}
 
-	long double GetDefaultZoom()
+	void AddWorkerBusy(const std::vector<std::chrono::nanoseconds>& busy)
 	{
-		return MandelbrotInternalData::DefaultPlaneData.Zoom;
+		auto& frame_busy = MandelbrotInternalData::FrameWorkerBusy;
+		frame_busy.resize(std::max(frame_busy.size(), busy.size()), std::chrono::nanoseconds::zero());
+		for (std::size_t w = 0; w < busy.size(); w++)
+		{
+			frame_busy[w] += busy[w];
+		}
 	}
 
-	void SetOffset(const sf::Vector2ld& offset)
+	void ProcessTiled(const MandelbrotProcessData& frame, const RenderJob& job)
 	{
-		MandelbrotInternalData::PreviousPlaneData.OffsetX = MandelbrotInternalData::PlaneData.OffsetX;
-		MandelbrotInternalData::PreviousPlaneData.OffsetY = MandelbrotInternalData::PlaneData.OffsetY;
-
-		MandelbrotInternalData::StateChanged = true;
+		const Scheduler::TileFunction process_tile = [&frame](const Scheduler::Tile& tile, std::size_t worker)
+		{
+			MandelbrotProcessData data = frame;
+			data.MinX = tile.MinX;
+			data.MaxX = tile.MaxX;
+			data.MinY = tile.MinY;
+			data.MaxY = tile.MaxY;
+			ProcessRows(data, GetWorkerResumePoints(worker));
+		};
+		const Scheduler::RunStatistics statistics = RunTiles(MandelbrotInternalData::FrameTiles, frame.Render.Workers, process_tile, job);
+		Logger::GetLogger()->trace("Scheduler: {} tiles, {} stolen.", MandelbrotInternalData::FrameTiles.size(), statistics.Steals);
+		MergeResumePoints();
 
-		MandelbrotInternalData::PlaneData.OffsetX = offset.x;
-		MandelbrotInternalData::PlaneData.OffsetY = offset.y;
+		ColorizeFrame(frame, frame.Render.Workers, job);
+		PublishFrame(job);
 	}
 
-	sf::Vector2ld GetOffset()
+	// Offsets further from the origin, in pixels, leave `long double` too few bits to place a pixel on the tile grid.
+	static constexpr long double MaxGridPixels = 1099511627776.0L;
+
+	// Rounds toward negative infinity, so cells left of the origin get their own coordinates.
+	static long long FloorDivide(long long value, long long divisor)
 	{
-		return {
-			MandelbrotInternalData::PlaneData.OffsetX,
-			MandelbrotInternalData::PlaneData.OffsetY
-		};
+		const long long quotient = value / divisor;
+		return quotient * divisor > value ? quotient - 1 : quotient;
 	}
 
-	void SetDefaultOffset(const sf::Vector2ld& offset)
+	bool GetTileLayout(const MandelbrotProcessData& frame, std::size_t max_iterations, TileLayout& layout)
 	{
-		MandelbrotInternalData::DefaultPlaneData.OffsetX = offset.x;
-		MandelbrotInternalData::DefaultPlaneData.OffsetY = offset.y;
+		// The frame pixel (x, y) is the point ((origin_x + x) * zoom, (origin_y + y) * zoom), see `ScaleToPlane`.
+		const long double zoom = frame.Data.Zoom;
+		const long double origin_x = frame.Data.OffsetX.ToLongDouble() / zoom - MandelbrotInternalData::Width / 2.0L;
+		const long double origin_y = frame.Data.OffsetY.ToLongDouble() / zoom - MandelbrotInternalData::Height / 2.0L;
+		if (!(std::fabs(origin_x) < MaxGridPixels && std::fabs(origin_y) < MaxGridPixels))
+		{
+			return false;
+		}
+
+		const long long tile_size = static_cast<long long>(TileCache::TileSize);
+		layout.OriginX = std::llround(origin_x);
+		layout.OriginY = std::llround(origin_y);
+		layout.FirstKey.Zoom = static_cast<double>(zoom);
+		layout.FirstKey.TileX = FloorDivide(layout.OriginX, tile_size);
+		layout.FirstKey.TileY = FloorDivide(layout.OriginY, tile_size);
+		layout.FirstKey.PhaseX = static_cast<std::int32_t>(std::llround((origin_x - static_cast<long double>(layout.OriginX)) * TileCache::PhaseSteps));
+		layout.FirstKey.PhaseY = static_cast<std::int32_t>(std::llround((origin_y - static_cast<long double>(layout.OriginY)) * TileCache::PhaseSteps));
+		layout.FirstKey.MaxIterations = static_cast<std::uint32_t>(max_iterations);
+		layout.FirstKey.KeyPrecision = static_cast<std::uint32_t>(frame.FramePrecision);
+
+		const long long last_x = FloorDivide(layout.OriginX + static_cast<long long>(MandelbrotInternalData::Width) - 1, tile_size);
+		const long long last_y = FloorDivide(layout.OriginY + static_cast<long long>(MandelbrotInternalData::Height) - 1, tile_size);
+		layout.Columns = static_cast<std::size_t>(last_x - layout.FirstKey.TileX + 1);
+		layout.Rows = static_cast<std::size_t>(last_y - layout.FirstKey.TileY + 1);
+		layout.Cached.assign(layout.Columns * layout.Rows, nullptr);
+		layout.Hits = 0;
+		layout.DiskHits = 0;
+		return true;
 	}
 
-	sf::Vector2ld GetDefaultOffset()
+	// Key of the cell in column `column` and row `row` of `layout`.
+	static TileCache::Key GetCellKey(const TileLayout& layout, std::size_t column, std::size_t row)
 	{
-		return {
-			MandelbrotInternalData::DefaultPlaneData.OffsetX,
-			MandelbrotInternalData::DefaultPlaneData.OffsetY
-		};
+		TileCache::Key key = layout.FirstKey;
+		key.TileX += static_cast<std::int64_t>(column);
+		key.TileY += static_cast<std::int64_t>(row);
+		return key;
 	}
 
-	void Update()
+	void FindCachedTiles(const MandelbrotProcessData& frame, TileLayout& layout)
 	{
-		if (MandelbrotInternalData::StateChanged)
+		for (std::size_t row = 0; row < layout.Rows; row++)
 		{
-			ProcessMt();
-			MandelbrotInternalData::StateChanged = false;
+			for (std::size_t column = 0; column < layout.Columns; column++)
+			{
+				std::shared_ptr<const TileCache::Tile>& cached = layout.Cached[row * layout.Columns + column];
+				cached = MandelbrotInternalData::Tiles.Find(GetCellKey(layout, column, row), frame.Colors.Smooth);
+				layout.Hits += cached ? 1u : 0u;
+			}
 		}
+		layout.DiskHits = MandelbrotInternalData::Tiles.TakeStatistics().DiskHits;
 	}
 
-	void ForceUpdate()
+	void ProcessCached(const MandelbrotProcessData& frame, const TileLayout& layout, const RenderJob& job)
 	{
-		ProcessMt();
-		MandelbrotInternalData::StateChanged = false;
+		Timer timer;
+		timer.start();
+
+		const long long tile_size = static_cast<long long>(TileCache::TileSize);
+		const long long width = static_cast<long long>(MandelbrotInternalData::Width);
+		const long long height = static_cast<long long>(MandelbrotInternalData::Height);
+
+		// The part of every cell on screen.
+		std::vector<Scheduler::Tile> tiles;
+		tiles.reserve(layout.Cached.size());
+		for (std::size_t row = 0; row < layout.Rows; row++)
+		{
+			for (std::size_t column = 0; column < layout.Columns; column++)
+			{
+				const long long cell_x = (layout.FirstKey.TileX + static_cast<long long>(column)) * tile_size - layout.OriginX;
+				const long long cell_y = (layout.FirstKey.TileY + static_cast<long long>(row)) * tile_size - layout.OriginY;
+				tiles.push_back({
+					static_cast<std::size_t>(std::max(cell_x, 0LL)), static_cast<std::size_t>(std::max(cell_y, 0LL)),
+					static_cast<std::size_t>(std::min(cell_x + tile_size, width)), static_cast<std::size_t>(std::min(cell_y + tile_size, height))
+				});
+			}
+		}
+
+		const Scheduler::TileFunction process_tile = [&](const Scheduler::Tile& tile, std::size_t)
+		{
+			const std::size_t column = static_cast<std::size_t>(FloorDivide(layout.OriginX + static_cast<long long>(tile.MinX), tile_size) - layout.FirstKey.TileX);
+			const std::size_t row = static_cast<std::size_t>(FloorDivide(layout.OriginY + static_cast<long long>(tile.MinY), tile_size) - layout.FirstKey.TileY);
+			const long long cell_x = (layout.FirstKey.TileX + static_cast<long long>(column)) * tile_size - layout.OriginX;
+			const long long cell_y = (layout.FirstKey.TileY + static_cast<long long>(row)) * tile_size - layout.OriginY;
+
+			std::shared_ptr<const TileCache::Tile> cell = layout.Cached[row * layout.Columns + column];
+			if (!cell)
+			{
+				thread_local std::vector<std::uint32_t> iterations;
+				thread_local std::vector<float> smooth;
+				iterations.resize(TileCache::TilePixels);
+				smooth.resize(frame.Colors.Smooth ? TileCache::TilePixels : 0);
+				float* smooth_data = frame.Colors.Smooth ? smooth.data() : nullptr;
+
+				for (std::size_t y = 0; y < TileCache::TileSize; y++)
+				{
+					ComputeLinePixels(cell_x, cell_y + static_cast<long long>(y), TileCache::TileSize, false, 1, frame, iterations.data() + y * TileCache::TileSize, smooth_data ? smooth_data + y * TileCache::TileSize : nullptr, nullptr);
+				}
+				cell = TileCache::MakeTile(iterations.data(), smooth_data);
+
+				MandelbrotInternalData::Tiles.Insert(GetCellKey(layout, column, row), cell);
+			}
+
+			for (std::size_t y = tile.MinY; y < tile.MaxY; y++)
+			{
+				const std::size_t j = y * MandelbrotInternalData::Width + tile.MinX;
+				TileCache::CopyTileRow(*cell, static_cast<std::size_t>(static_cast<long long>(tile.MinX) - cell_x), static_cast<std::size_t>(static_cast<long long>(y) - cell_y), tile.MaxX - tile.MinX,
+					MandelbrotInternalData::FrameIterations.data() + j, frame.Colors.Smooth ? MandelbrotInternalData::FrameSmooth.data() + j : nullptr);
+			}
+		};
+		RunTiles(tiles, frame.Render.Workers, process_tile, job);
+
+		ColorizeFrame(frame, frame.Render.Workers, job);
+		PublishFrame(job);
+		timer.stop();
+
+		Logger::GetLogger()->trace("Tile cache: {} of {} tiles cached ({} from disk), {} ms.", layout.Hits, layout.Cached.size(), layout.DiskHits, timer.elapsedMilliseconds());
+		MandelbrotInternalData::Tiles.Flush();
+	}
+
+	void StoreFrameTiles(const MandelbrotProcessData& frame, const TileLayout& layout)
+	{
+		const long long tile_size = static_cast<long long>(TileCache::TileSize);
+		std::vector<std::uint32_t> iterations(TileCache::TilePixels);
+		std::vector<float> smooth(frame.Colors.Smooth ? TileCache::TilePixels : 0);
+
+		for (std::size_t row = 0; row < layout.Rows; row++)
+		{
+			for (std::size_t column = 0; column < layout.Columns; column++)
+			{
+				const std::shared_ptr<const TileCache::Tile>& cached = layout.Cached[row * layout.Columns + column];
+				if (cached && (!frame.Colors.Smooth || cached->Smooth))
+				{
+					continue;
+				}
+
+				const long long cell_x = (layout.FirstKey.TileX + static_cast<long long>(column)) * tile_size - layout.OriginX;
+				const long long cell_y = (layout.FirstKey.TileY + static_cast<long long>(row)) * tile_size - layout.OriginY;
+				if (cell_x < 0 || cell_y < 0 || cell_x + tile_size > static_cast<long long>(MandelbrotInternalData::Width) || cell_y + tile_size > static_cast<long long>(MandelbrotInternalData::Height))
+				{
+					continue;
+				}
+
+				for (std::size_t y = 0; y < TileCache::TileSize; y++)
+				{
+					const std::size_t j = (static_cast<std::size_t>(cell_y) + y) * MandelbrotInternalData::Width + static_cast<std::size_t>(cell_x);
+					std::copy_n(MandelbrotInternalData::FrameIterations.data() + j, TileCache::TileSize, iterations.data() + y * TileCache::TileSize);
+					if (frame.Colors.Smooth)
+					{
+						std::copy_n(MandelbrotInternalData::FrameSmooth.data() + j, TileCache::TileSize, smooth.data() + y * TileCache::TileSize);
+					}
+				}
+				MandelbrotInternalData::Tiles.Insert(GetCellKey(layout, column, row), TileCache::MakeTile(iterations.data(), frame.Colors.Smooth ? smooth.data() : nullptr));
+			}
+		}
+		MandelbrotInternalData::Tiles.Flush();
+	}
+
+	// Smallest distance to a whole number of pixels which still counts as one. The offsets
+	// are rounded to their own precision, so a pan by whole pixels is never exact.
+	static constexpr long double PanPixelTolerance = 1.0L / 1024.0L;
+
+	bool GetPixelShift(const MandelbrotProcessData& frame, std::size_t max_iterations, long long& shift_x, long long& shift_y)
+	{
+		const MandelbrotPlaneData& retained = MandelbrotInternalData::RetainedPlaneData;
+		if (!MandelbrotInternalData::RetainedFrameValid
+			|| MandelbrotInternalData::RetainedMaxIterations != max_iterations
+			|| MandelbrotInternalData::RetainedPrecision != frame.FramePrecision
+			|| (frame.Colors.Smooth && !MandelbrotInternalData::RetainedSmooth)
+			|| retained.Zoom != frame.Data.Zoom)
+		{
+			return false;
+		}
+
+		// The new pixel (x, y) is the retained pixel (x + shift_x, y + shift_y).
+		const long double pixels_x = (frame.Data.OffsetX - retained.OffsetX).ToLongDouble() / frame.Data.Zoom;
+		const long double pixels_y = (frame.Data.OffsetY - retained.OffsetY).ToLongDouble() / frame.Data.Zoom;
+		if (std::fabs(pixels_x - std::round(pixels_x)) > PanPixelTolerance || std::fabs(pixels_y - std::round(pixels_y)) > PanPixelTolerance)
+		{
+			return false;
+		}
+		if (std::fabs(pixels_x) >= MandelbrotInternalData::Width || std::fabs(pixels_y) >= MandelbrotInternalData::Height)
+		{
+			return false;
+		}
+
+		shift_x = std::llround(pixels_x);
+		shift_y = std::llround(pixels_y);
+		return true;
+	}
+
+	// Moves every row of a frame buffer so that pixel (x, y) gets the value of (x + shift_x, y + shift_y).
+	// Pixels without a source keep stale values and must be recomputed.
+	template<typename T>
+	void ShiftFrame(T* pixels, long long shift_x, long long shift_y)
+	{
+		const long long width = static_cast<long long>(MandelbrotInternalData::Width);
+		const long long height = static_cast<long long>(MandelbrotInternalData::Height);
+		const std::size_t count = static_cast<std::size_t>(width - std::llabs(shift_x));
+
+		// Rows are visited in the order which never overwrites a row before it is read.
+		for (long long i = 0; i < height; i++)
+		{
+			const long long y = shift_y >= 0 ? i : height - 1 - i;
+			const long long source_y = y + shift_y;
+			if (source_y < 0 || source_y >= height)
+			{
+				continue;
+			}
+
+			T* row = pixels + y * width;
+			const T* source = pixels + source_y * width;
+			std::memmove(row + std::max(-shift_x, 0LL), source + std::max(shift_x, 0LL), count * sizeof(T));
+		}
+	}
+
+	void ProcessPan(const MandelbrotProcessData& frame, long long shift_x, long long shift_y, const RenderJob& job)
+	{
+		ShiftFrame(MandelbrotInternalData::FrameIterations.data(), shift_x, shift_y);
+		if (frame.Colors.Smooth)
+		{
+			ShiftFrame(MandelbrotInternalData::FrameSmooth.data(), shift_x, shift_y);
+		}
+
+		// Pixels kept from the retained frame: `[kept_min_x, kept_max_x)` x `[kept_min_y, kept_max_y)`.
+		const std::size_t kept_min_x = static_cast<std::size_t>(std::max(-shift_x, 0LL));
+		const std::size_t kept_max_x = MandelbrotInternalData::Width - static_cast<std::size_t>(std::max(shift_x, 0LL));
+		const std::size_t kept_min_y = static_cast<std::size_t>(std::max(-shift_y, 0LL));
+		const std::size_t kept_max_y = MandelbrotInternalData::Height - static_cast<std::size_t>(std::max(shift_y, 0LL));
+
+		// Saved points move with their pixels, the ones leaving the screen are dropped.
+		if (MandelbrotInternalData::CollectingResumePoints)
+		{
+			auto& points = MandelbrotInternalData::ResumePoints;
+			std::size_t kept = 0;
+			for (const Kernel::ResumePoint& point : points)
+			{
+				const long long x = static_cast<long long>(point.Pixel % MandelbrotInternalData::Width) - shift_x;
+				const long long y = static_cast<long long>(point.Pixel / MandelbrotInternalData::Width) - shift_y;
+				if (x >= static_cast<long long>(kept_min_x) && x < static_cast<long long>(kept_max_x) && y >= static_cast<long long>(kept_min_y) && y < static_cast<long long>(kept_max_y))
+				{
+					points[kept] = point;
+					points[kept].Pixel = static_cast<std::uint32_t>(y * static_cast<long long>(MandelbrotInternalData::Width) + x);
+					kept++;
+				}
+			}
+			points.resize(kept);
+		}
+
+		std::atomic<std::size_t> computed = 0;
+		const Scheduler::TileFunction process_tile = [&](const Scheduler::Tile& tile, std::size_t worker)
+		{
+			std::vector<Kernel::ResumePoint>* resume = GetWorkerResumePoints(worker);
+			MandelbrotProcessData data = frame;
+			for (std::size_t y = tile.MinY; y < tile.MaxY; y++)
+			{
+				data.MinY = y;
+				data.MaxY = y + 1;
+
+				if (y < kept_min_y || y >= kept_max_y)
+				{
+					data.MinX = tile.MinX;
+					data.MaxX = tile.MaxX;
+					ProcessRows(data, resume);
+					computed += data.MaxX - data.MinX;
+					continue;
+				}
+
+				// Only the exposed columns at either end of the row.
+				if (tile.MinX < kept_min_x)
+				{
+					data.MinX = tile.MinX;
+					data.MaxX = std::min(tile.MaxX, kept_min_x);
+					ProcessRows(data, resume);
+					computed += data.MaxX - data.MinX;
+				}
+				if (tile.MaxX > kept_max_x)
+				{
+					data.MinX = std::max(tile.MinX, kept_max_x);
+					data.MaxX = tile.MaxX;
+					ProcessRows(data, resume);
+					computed += data.MaxX - data.MinX;
+				}
+			}
+		};
+		RunTiles(MandelbrotInternalData::FrameTiles, frame.Render.Workers, process_tile, job);
+		MergeResumePoints();
+		ColorizeFrame(frame, frame.Render.Workers, job);
+		PublishFrame(job);
+
+		Logger::GetLogger()->trace("Pan: shifted by ({}, {}) pixels, {} pixels computed.", shift_x, shift_y, computed.load());
+	}
+
+	void PreviewReprojection(const MandelbrotProcessData& frame, const RenderJob& job)
+	{
+		std::swap(MandelbrotInternalData::FrameIterations, MandelbrotInternalData::ScratchIterations);
+		std::swap(MandelbrotInternalData::FrameSmooth, MandelbrotInternalData::ScratchSmooth);
+		std::swap(MandelbrotInternalData::FrameColors, MandelbrotInternalData::ScratchColors);
+		MandelbrotInternalData::FrameIterations.resize(MandelbrotInternalData::FrameSize);
+		if (frame.Colors.Smooth)
+		{
+			MandelbrotInternalData::FrameSmooth.resize(MandelbrotInternalData::FrameSize);
+		}
+		MandelbrotInternalData::FrameColors.resize(MandelbrotInternalData::FrameSize);
+
+		// Position of a new pixel in the retained frame, rounded to the nearest retained pixel.
+		// Pixels which fall outside of it take the colour of its closest edge.
+		const MandelbrotPlaneData& retained = MandelbrotInternalData::RetainedPlaneData;
+		const long double ratio = frame.Data.Zoom / retained.Zoom;
+		const long double shift_x = (frame.Data.OffsetX - retained.OffsetX).ToLongDouble() / retained.Zoom;
+		const long double shift_y = (frame.Data.OffsetY - retained.OffsetY).ToLongDouble() / retained.Zoom;
+
+		const auto to_retained = [ratio](std::size_t pixel, long double shift, std::size_t size)
+		{
+			const long double half = size / 2.0L;
+			const long double position = std::round((pixel - half) * ratio + shift + half);
+			return static_cast<std::size_t>(std::clamp(position, 0.0L, static_cast<long double>(size - 1)));
+		};
+
+		std::vector<std::size_t> columns(MandelbrotInternalData::Width);
+		for (std::size_t x = 0; x < MandelbrotInternalData::Width; x++)
+		{
+			columns[x] = to_retained(x, shift_x, MandelbrotInternalData::Width);
+		}
+
+		const sf::Color* previous = MandelbrotInternalData::ScratchColors.data();
+		for (std::size_t y = 0; y < MandelbrotInternalData::Height; y++)
+		{
+			const sf::Color* source = previous + to_retained(y, shift_y, MandelbrotInternalData::Height) * MandelbrotInternalData::Width;
+			for (std::size_t x = 0; x < MandelbrotInternalData::Width; x++)
+			{
+				SetPixelColor(x, y, source[columns[x]]);
+			}
+		}
+		PublishFrame(job);
+	}
+
+	// Zooms by more than this many doublings keep too few pixels to be worth copying.
+	static constexpr int MaxZoomSteps = 4;
+
+	bool GetZoomSteps(const MandelbrotProcessData& frame, std::size_t max_iterations, int& steps)
+	{
+		// The center of the frame must fall on a pixel, between pixels it would move by half a pixel.
+		const MandelbrotPlaneData& retained = MandelbrotInternalData::RetainedPlaneData;
+		if (MandelbrotInternalData::Width % 2 != 0
+			|| MandelbrotInternalData::Height % 2 != 0
+			|| MandelbrotInternalData::RetainedMaxIterations != max_iterations
+			|| MandelbrotInternalData::RetainedPrecision != frame.FramePrecision
+			|| (frame.Colors.Smooth && !MandelbrotInternalData::RetainedSmooth)
+			|| retained.OffsetX != frame.Data.OffsetX
+			|| retained.OffsetY != frame.Data.OffsetY)
+		{
+			return false;
+		}
+
+		// Only a power of two has a mantissa of exactly one half.
+		int exponent = 0;
+		if (std::frexp(frame.Data.Zoom / retained.Zoom, &exponent) != 0.5L)
+		{
+			return false;
+		}
+
+		steps = exponent - 1;
+		return steps != 0 && std::abs(steps) <= MaxZoomSteps;
+	}
+
+	void ProcessZoom(const MandelbrotProcessData& frame, int steps, const RenderJob& job)
+	{
+		// Relative to the center of the screen, the new pixel `p` is the retained pixel `p * factor`
+		// when zooming out, and `p / factor` when zooming in, if `p` is a multiple of `factor`.
+		// Both sit on the exact same coordinate, so the retained iterations are reused as they are.
+		const long long factor = 1LL << std::abs(steps);
+		const std::size_t stride = static_cast<std::size_t>(factor);
+		const bool zooming_in = steps < 0;
+
+		const long long width = static_cast<long long>(MandelbrotInternalData::Width);
+		const long long height = static_cast<long long>(MandelbrotInternalData::Height);
+		const long long half_width = width / 2;
+		const long long half_height = height / 2;
+
+		const auto to_retained = [factor, zooming_in](std::size_t pixel, long long half, long long size, long long& retained)
+		{
+			const long long centered = static_cast<long long>(pixel) - half;
+			if (zooming_in)
+			{
+				retained = half + centered / factor;
+				return centered % factor == 0;
+			}
+			retained = half + centered * factor;
+			return retained >= 0 && retained < size;
+		};
+
+		const std::uint32_t* previous_iterations = MandelbrotInternalData::ScratchIterations.data();
+		const float* previous_smooth = MandelbrotInternalData::ScratchSmooth.data();
+		std::uint32_t* iterations = MandelbrotInternalData::FrameIterations.data();
+		float* smooth = frame.Colors.Smooth ? MandelbrotInternalData::FrameSmooth.data() : nullptr;
+
+		std::atomic<std::size_t> computed = 0;
+		const Scheduler::TileFunction process_tile = [&](const Scheduler::Tile& tile, std::size_t)
+		{
+			thread_local std::vector<std::uint32_t> samples;
+			thread_local std::vector<float> smooth_samples;
+			samples.resize((tile.MaxX - tile.MinX + stride - 1) / stride + 1);
+			smooth_samples.resize(smooth ? samples.size() : 0);
+
+			MandelbrotProcessData data = frame;
+			for (std::size_t y = tile.MinY; y < tile.MaxY; y++)
+			{
+				data.MinY = y;
+				data.MaxY = y + 1;
+
+				long long retained_y = 0;
+				if (!to_retained(y, half_height, height, retained_y))
+				{
+					data.MinX = tile.MinX;
+					data.MaxX = tile.MaxX;
+					ProcessRows(data);
+					computed += data.MaxX - data.MinX;
+					continue;
+				}
+
+				const std::size_t row = y * MandelbrotInternalData::Width;
+				const std::size_t retained_row = static_cast<std::size_t>(retained_y) * MandelbrotInternalData::Width;
+
+				for (std::size_t x = tile.MinX; x < tile.MaxX; x++)
+				{
+					long long retained_x = 0;
+					if (to_retained(x, half_width, width, retained_x))
+					{
+						iterations[row + x] = previous_iterations[retained_row + static_cast<std::size_t>(retained_x)];
+						if (smooth)
+						{
+							smooth[row + x] = previous_smooth[retained_row + static_cast<std::size_t>(retained_x)];
+						}
+					}
+				}
+
+				if (zooming_in)
+				{
+					// The missing pixels of the row are `factor - 1` lines of stride `factor`.
+					for (long long residue = 1; residue < factor; residue++)
+					{
+						const long long offset = ((residue - (static_cast<long long>(tile.MinX) - half_width)) % factor + factor) % factor;
+						const std::size_t min_x = tile.MinX + static_cast<std::size_t>(offset);
+						if (min_x >= tile.MaxX)
+						{
+							continue;
+						}
+
+						const std::size_t count = (tile.MaxX - min_x + stride - 1) / stride;
+						ComputeLineIterations(min_x, y, count, false, stride, frame, samples.data(), smooth ? smooth_samples.data() : nullptr);
+						for (std::size_t i = 0; i < count; i++)
+						{
+							const std::size_t x = min_x + i * stride;
+							iterations[row + x] = samples[i];
+							if (smooth)
+							{
+								smooth[row + x] = smooth_samples[i];
+							}
+						}
+						computed += count;
+					}
+				}
+				else
+				{
+					// The retained frame covers the middle of the row, the ends are new.
+					const std::size_t min_kept = static_cast<std::size_t>(half_width - half_width / factor);
+					const std::size_t max_kept = static_cast<std::size_t>(half_width + (width - 1 - half_width) / factor + 1);
+					if (tile.MinX < min_kept)
+					{
+						data.MinX = tile.MinX;
+						data.MaxX = std::min(tile.MaxX, min_kept);
+						ProcessRows(data);
+						computed += data.MaxX - data.MinX;
+					}
+					if (tile.MaxX > max_kept)
+					{
+						data.MinX = std::max(tile.MinX, max_kept);
+						data.MaxX = tile.MaxX;
+						ProcessRows(data);
+						computed += data.MaxX - data.MinX;
+					}
+				}
+			}
+		};
+		RunTiles(MandelbrotInternalData::FrameTiles, frame.Render.Workers, process_tile, job);
+		ColorizeFrame(frame, frame.Render.Workers, job);
+		PublishFrame(job);
+
+		Logger::GetLogger()->trace("Zoom: {} doublings, {} pixels computed.", steps, computed.load());
+	}
+
+	// Computes the samples of a tile which are new at `step`, then colours each `step` x `step`
+	// block of the tile with its top-left sample.
+	void ProcessProgressiveTile(const MandelbrotProcessData& frame, const Scheduler::Tile& tile, std::size_t step, std::vector<Kernel::ResumePoint>* resume)
+	{
+		std::uint32_t* iterations = MandelbrotInternalData::FrameIterations.data();
+		float* smooth = frame.Colors.Smooth ? MandelbrotInternalData::FrameSmooth.data() : nullptr;
+		const bool first_pass = step == MandelbrotInternalData::ProgressiveFirstStep;
+
+		thread_local std::vector<std::uint32_t> samples;
+		thread_local std::vector<float> smooth_samples;
+		samples.resize((tile.MaxX - tile.MinX + step - 1) / step);
+		smooth_samples.resize(smooth ? samples.size() : 0);
+
+		for (std::size_t y = tile.MinY; y < tile.MaxY; y += step)
+		{
+			// Rows sampled by the previous pass only miss the columns halfway between its samples.
+			const bool sampled_row = !first_pass && y % (2 * step) == 0;
+			const std::size_t min_x = sampled_row ? tile.MinX + step : tile.MinX;
+			const std::size_t stride = sampled_row ? 2 * step : step;
+			if (min_x >= tile.MaxX)
+			{
+				continue;
+			}
+
+			const std::size_t count = (tile.MaxX - min_x + stride - 1) / stride;
+			ComputeLineIterations(min_x, y, count, false, stride, frame, samples.data(), smooth ? smooth_samples.data() : nullptr, resume);
+
+			const std::size_t row = y * MandelbrotInternalData::Width;
+			for (std::size_t i = 0; i < count; i++)
+			{
+				iterations[row + min_x + i * stride] = samples[i];
+				if (smooth)
+				{
+					smooth[row + min_x + i * stride] = smooth_samples[i];
+				}
+			}
+		}
+
+		// The last pass leaves no block to fill: its rows go through the colour kernel, which also counts them.
+		if (step == 1)
+		{
+			MandelbrotProcessData data = frame;
+			data.MinX = tile.MinX;
+			data.MaxX = tile.MaxX;
+			data.MinY = tile.MinY;
+			data.MaxY = tile.MaxY;
+			SetTileStatistics(tile, ColorizeRows(data));
+			return;
+		}
+
+		for (std::size_t block_y = tile.MinY; block_y < tile.MaxY; block_y += step)
+		{
+			const std::size_t row = block_y * MandelbrotInternalData::Width;
+			for (std::size_t block_x = tile.MinX; block_x < tile.MaxX; block_x += step)
+			{
+				const sf::Color color = GetPixelColor(frame.Colors, iterations[row + block_x], smooth ? smooth[row + block_x] : 0.0f);
+				for (std::size_t y = block_y; y < std::min(block_y + step, tile.MaxY); y++)
+				{
+					for (std::size_t x = block_x; x < std::min(block_x + step, tile.MaxX); x++)
+					{
+						SetPixelColor(x, y, color);
+					}
+				}
+			}
+		}
+	}
+
+	void ProcessProgressive(const MandelbrotProcessData& frame, const RenderJob& job)
+	{
+		// Each pass halves the spacing of the previous one, whose samples are kept: the last pass
+		// computes three quarters of the pixels, and the frame as a whole costs the same as a
+		// single pass. Strided samples get the exact coordinates they have at full resolution.
+		for (std::size_t step = MandelbrotInternalData::ProgressiveFirstStep; step > 0 && !job.IsCancelled(); step /= 2)
+		{
+			const Trace::Scope trace("pass", "phase", { "step", step });
+			Timer timer;
+			timer.start();
+
+			const Scheduler::TileFunction process_tile = [&frame, step](const Scheduler::Tile& tile, std::size_t worker)
+			{
+				ProcessProgressiveTile(frame, tile, step, GetWorkerResumePoints(worker));
+			};
+			RunTiles(MandelbrotInternalData::FrameTiles, frame.Render.Workers, process_tile, job);
+			PublishFrame(job);
+
+			Logger::GetLogger()->trace("Progressive pass {}x{}: {} ms.", step, step, timer.elapsedMilliseconds());
+		}
+		MergeResumePoints();
+	}
+
+	void SetPixelColor(std::size_t x, std::size_t y, const sf::Color& color)
+	{
+		MandelbrotInternalData::FrameColors[(y * MandelbrotInternalData::Width) + x] = color;
+	}
+
+	bool PublishFrame(const RenderJob& job)
+	{
+		const Trace::Scope trace("publish", "phase");
+		const Stats::ScopedTimer phase(MandelbrotInternalData::FramePhases[static_cast<std::size_t>(Stats::Phase::Publish)]);
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+
+		// A newer job has been submitted: only its pixels may reach the screen from now on.
+		if (job.IsCancelled())
+		{
+			return false;
+		}
+
+		const auto& colors = MandelbrotInternalData::FrameColors;
+		if (MandelbrotInternalData::UsingVertexBuffer)
+		{
+			auto& vertices = MandelbrotInternalData::MdVertexBuffer.MandelbrotVertices;
+			if (vertices.size() != colors.size())
+			{
+				vertices.resize(colors.size());
+				for (std::size_t y = 0; y < MandelbrotInternalData::Height; y++)
+				{
+					for (std::size_t x = 0; x < MandelbrotInternalData::Width; x++)
+					{
+						vertices[y * MandelbrotInternalData::Width + x].position = { static_cast<float>(x), static_cast<float>(y) };
+					}
+				}
+			}
+			for (std::size_t j = 0; j < colors.size(); j++)
+			{
+				vertices[j].color = colors[j];
+			}
+		}
+		else
+		{
+			static_assert(sizeof(sf::Color) == 4, "`sf::Color` must be laid out as RGBA bytes.");
+			MandelbrotInternalData::MdSprite.MdImage.create(static_cast<unsigned int>(MandelbrotInternalData::Width), static_cast<unsigned int>(MandelbrotInternalData::Height), reinterpret_cast<const sf::Uint8*>(colors.data()));
+		}
+		MandelbrotInternalData::FrameDirty = true;
+		return true;
+	}
+
+	void ProcessSubdivided(const MandelbrotProcessData& frame, std::size_t threads, const RenderJob& job)
+	{
+		auto& iterations = MandelbrotInternalData::FrameIterations;
+
+		const Subdivision::LineFunction compute_line = [&frame](std::size_t x, std::size_t y, std::size_t count, bool vertical, std::uint32_t* line)
+		{
+			ComputeLineIterations(x, y, count, vertical, 1, frame, line);
+		};
+		const Subdivision::Statistics statistics = Subdivision::Render(MandelbrotInternalData::Pool, MandelbrotInternalData::Width, MandelbrotInternalData::Height, compute_line, iterations.data(), threads, job.GetCancellationToken());
+		if (job.IsCancelled())
+		{
+			return;
+		}
+
+		ColorizeFrame(frame, threads, job);
+		PublishFrame(job);
+
+		{
+			std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+			MandelbrotInternalData::LastSubdivisionStatistics = statistics;
+		}
+		AddWorkerBusy(statistics.WorkerBusy);
+		Logger::GetLogger()->trace("Subdivision: {} pixels computed, {} filled.", statistics.ComputedPixels, statistics.FilledPixels);
+	}
+
+	// Returns the true x-y coordinates of the Set.
+	sf::Vector2ld ScaleToPlane(const sf::Vector2ld& coords)
+	{
+		sf::Vector2ld plane_coords;
+		plane_coords.x = (coords.x - static_cast<long double>(MandelbrotInternalData::Width) / 2.0L) * GetZoom() + GetOffset().x;
+		plane_coords.y = (coords.y - static_cast<long double>(MandelbrotInternalData::Height) / 2.0L) * GetZoom() + GetOffset().y;
+		return plane_coords;
+	}
+
+	sf::Vector2ld ScaleToPlane(const sf::Vector2ld& coords, const MandelbrotPlaneData& data)
+	{
+		sf::Vector2ld plane_coords;
+		plane_coords.x = (coords.x - static_cast<long double>(MandelbrotInternalData::Width) / 2.0L) * data.Zoom + data.OffsetX.ToLongDouble();
+		plane_coords.y = (coords.y - static_cast<long double>(MandelbrotInternalData::Height) / 2.0L) * data.Zoom + data.OffsetY.ToLongDouble();
+		return plane_coords;
+	}
+
+	// Number of ulps that must separate two adjacent pixels for a type to be used.
+	// The margin leaves room for the rounding errors that build up while iterating, which
+	// otherwise show up as noise along the boundary of the set.
+	static constexpr long double PrecisionPixelUlps = 1024.0L;
+
+	// Smallest zoom the perturbation deltas can represent without denormals.
+	static constexpr long double PerturbationZoomLimit = 1e-290L;
+
+	template<typename T>
+	bool ResolvesPixels(const MandelbrotPlaneData& data)
+	{
+		// Largest coordinate on screen: this is where the ulp of the type is the widest.
+		const long double max_real = std::fabs(data.OffsetX.ToLongDouble()) + MandelbrotInternalData::Width / 2.0L * std::fabs(data.Zoom);
+		const long double max_imag = std::fabs(data.OffsetY.ToLongDouble()) + MandelbrotInternalData::Height / 2.0L * std::fabs(data.Zoom);
+		const long double ulp = std::max({ max_real, max_imag, 2.0L }) * static_cast<long double>(std::numeric_limits<T>::epsilon());
+
+		return std::fabs(data.Zoom) >= ulp * PrecisionPixelUlps
+			&& std::fabs(data.Zoom) >= static_cast<long double>(std::numeric_limits<T>::min());
+	}
+
+	// Cheapest precision resolving the pixels, whatever the minimum.
+	static Precision SelectResolvingPrecision(const MandelbrotPlaneData& data, bool deep_zoom)
+	{
+		if (ResolvesPixels<float>(data))
+		{
+			return Precision::Float;
+		}
+		if (ResolvesPixels<double>(data))
+		{
+			return Precision::Double;
+		}
+		// Perturbation deltas are `double` values around the zoom size, they must stay normal numbers.
+		if (deep_zoom && std::fabs(data.Zoom) >= PerturbationZoomLimit)
+		{
+			return Precision::Perturbation;
+		}
+		// On some compilers `long double` is just a `double`, it would not help then.
+		if (std::numeric_limits<long double>::digits > std::numeric_limits<double>::digits && ResolvesPixels<long double>(data))
+		{
+			return Precision::LongDouble;
+		}
+		return Precision::Exhausted;
+	}
+
+	Precision SelectPrecision(const MandelbrotPlaneData& data, const MandelbrotRenderData& render)
+	{
+		// Any precision above the one required resolves the pixels as well, except perturbation, whose deltas could underflow.
+		const Precision precision = SelectResolvingPrecision(data, render.DeepZoom);
+		const Precision minimum = render.MinimumPrecision;
+		if (precision >= minimum || (minimum == Precision::Perturbation && std::fabs(data.Zoom) < PerturbationZoomLimit))
+		{
+			return precision;
+		}
+		return minimum;
+	}
+
+	std::shared_ptr<const Perturbation::ReferenceOrbit> GetReferenceOrbit(const MandelbrotPlaneData& data, std::size_t max_iterations)
+	{
+		const std::size_t fraction_limbs = HighPrecision::LimbsForResolution(data.Zoom);
+		const auto& cached = MandelbrotInternalData::ReferenceOrbit;
+
+		// An orbit computed for more iterations starts with the shorter one, so lowering the
+		// max iterations keeps it: the recoloured frame doesn't wait for a new reference.
+		// One which escaped is complete whatever the limit.
+		if (cached
+			&& (cached->MaxIterations >= max_iterations || cached->Length < cached->MaxIterations)
+			&& cached->CenterX.GetFractionLimbs() >= fraction_limbs
+			&& cached->CenterX == data.OffsetX
+			&& cached->CenterY == data.OffsetY)
+		{
+			return cached;
+		}
+
+		HighPrecision center_x = data.OffsetX;
+		HighPrecision center_y = data.OffsetY;
+		center_x.SetFractionLimbs(std::max(fraction_limbs, center_x.GetFractionLimbs()));
+		center_y.SetFractionLimbs(std::max(fraction_limbs, center_y.GetFractionLimbs()));
+
+		auto orbit = std::make_shared<Perturbation::ReferenceOrbit>();
+		Perturbation::ComputeReferenceOrbit(center_x, center_y, max_iterations, *orbit);
+
+		Logger::GetLogger()->trace("Reference orbit: {} iterations at {} bits.", orbit->Length, fraction_limbs * 32);
+
+		MandelbrotInternalData::ReferenceOrbit = orbit;
+		return orbit;
+	}
+
+	std::shared_ptr<const Perturbation::BlaTable> GetBlaTable(const std::shared_ptr<const Perturbation::ReferenceOrbit>& orbit, const MandelbrotPlaneData& data)
+	{
+		// Distance from the reference (the center of the screen) to the farthest pixel.
+		const double max_delta_c = std::hypot(static_cast<double>(MandelbrotInternalData::Width) / 2.0, static_cast<double>(MandelbrotInternalData::Height) / 2.0) * static_cast<double>(std::fabs(data.Zoom));
+
+		const auto& cached = MandelbrotInternalData::ReferenceBla;
+		if (cached && MandelbrotInternalData::ReferenceBlaOrbit == orbit && cached->MaxDeltaC == max_delta_c)
+		{
+			return cached;
+		}
+
+		auto table = std::make_shared<Perturbation::BlaTable>();
+		Perturbation::BuildBlaTable(*orbit, max_delta_c, *table);
+
+		Logger::GetLogger()->trace("BLA table: {} levels.", table->Levels.size());
+
+		MandelbrotInternalData::ReferenceBlaOrbit = orbit;
+		MandelbrotInternalData::ReferenceBla = table;
+		return table;
+	}
+
+	void BeginFrame(MandelbrotProcessData& frame)
+	{
+		// Reference orbits are part of the frame as well.
+		MandelbrotInternalData::FrameStart = std::chrono::steady_clock::now();
+		frame.FramePrecision = SelectPrecision(frame.Data, frame.Render);
+
+		if (frame.FramePrecision == Precision::Exhausted && MandelbrotInternalData::FramePrecision != Precision::Exhausted)
+		{
+			Logger::GetLogger()->warn("Precision exhausted at zoom {}: adjacent pixels can no longer be told apart.", frame.Data.Zoom);
+		}
+		Logger::GetLogger()->trace("Frame precision: {}", GetPrecisionName(frame.FramePrecision));
+
+		if (frame.FramePrecision == Precision::Perturbation)
+		{
+			const Trace::Scope trace("reference orbit", "phase");
+			frame.Orbit = GetReferenceOrbit(frame.Data, frame.Colors.MaxIterations);
+			if (frame.Render.LinearApproximation)
+			{
+				frame.Bla = GetBlaTable(frame.Orbit, frame.Data);
+			}
+		}
+
+		{
+			// Only frames write it, so they read it without the lock.
+			std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+			MandelbrotInternalData::FramePrecision = frame.FramePrecision;
+		}
+		MandelbrotInternalData::FrameIterations.resize(MandelbrotInternalData::FrameSize);
+		if (frame.Colors.Smooth)
+		{
+			MandelbrotInternalData::FrameSmooth.resize(MandelbrotInternalData::FrameSize);
+		}
+		MandelbrotInternalData::FrameColors.resize(MandelbrotInternalData::FrameSize);
+		PrepareColorTable(frame.Colors);
+		MandelbrotInternalData::FrameRebases = 0;
+		MandelbrotInternalData::FrameSkippedIterations = 0;
+		MandelbrotInternalData::FrameInteriorRejected = 0;
+		MandelbrotInternalData::FramePeriodicExits = 0;
+		MandelbrotInternalData::FrameExecutedIterations = 0;
+		MandelbrotInternalData::FrameWorkerBusy.assign(frame.Render.Workers, std::chrono::nanoseconds::zero());
+		MandelbrotInternalData::FramePhases.fill(std::chrono::nanoseconds::zero());
+		MandelbrotInternalData::FrameMode = "none";
+
+		// Counts are kept: recoloured frames don't count their tiles again.
+		const auto& tiles = MandelbrotInternalData::FrameTiles;
+		MandelbrotInternalData::FrameTileStats.resize(tiles.size());
+		for (std::size_t t = 0; t < tiles.size(); t++)
+		{
+			Stats::TileStats& stats = MandelbrotInternalData::FrameTileStats[t];
+			stats.MinX = tiles[t].MinX;
+			stats.MinY = tiles[t].MinY;
+			stats.MaxX = tiles[t].MaxX;
+			stats.MaxY = tiles[t].MaxY;
+		}
+	}
+
+	void EndFrame(const MandelbrotProcessData& frame, const RenderJob& job)
+	{
+		const std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - MandelbrotInternalData::FrameStart;
+		std::vector<double> utilization;
+		for (const std::chrono::nanoseconds busy : MandelbrotInternalData::FrameWorkerBusy)
+		{
+			utilization.push_back(elapsed.count() > 0 ? static_cast<double>(busy.count()) / static_cast<double>(elapsed.count()) : 0.0);
+		}
+
+		Stats::FrameStats stats;
+		stats.Frame = ++MandelbrotInternalData::FrameCounter;
+		stats.Mode = MandelbrotInternalData::FrameMode;
+		stats.Complete = !job.IsCancelled();
+		stats.Width = MandelbrotInternalData::Width;
+		stats.Height = MandelbrotInternalData::Height;
+		stats.MaxIterations = frame.Colors.MaxIterations;
+		stats.FramePrecision = frame.FramePrecision;
+		stats.Total = elapsed;
+		stats.Phases = MandelbrotInternalData::FramePhases;
+		const std::chrono::nanoseconds others = stats.GetPhase(Stats::Phase::Colorize) + stats.GetPhase(Stats::Phase::Publish);
+		stats.Phases[static_cast<std::size_t>(Stats::Phase::Compute)] = std::max(elapsed - others, std::chrono::nanoseconds::zero());
+		stats.Tiles = MandelbrotInternalData::FrameTileStats;
+		for (const Stats::TileStats& tile : stats.Tiles)
+		{
+			stats.Iterations += tile.Iterations;
+			stats.EscapedPixels += tile.Escaped;
+		}
+		stats.LimitPixels = MandelbrotInternalData::FrameSize - std::min(stats.EscapedPixels, MandelbrotInternalData::FrameSize);
+		stats.InteriorRejectedPixels = MandelbrotInternalData::FrameInteriorRejected;
+		stats.PeriodicPixels = MandelbrotInternalData::FramePeriodicExits;
+		stats.SkippedIterations = MandelbrotInternalData::FrameSkippedIterations;
+		stats.ExecutedIterations = MandelbrotInternalData::FrameExecutedIterations;
+		stats.WorkerBusy = MandelbrotInternalData::FrameWorkerBusy;
+		for (const std::chrono::nanoseconds busy : stats.WorkerBusy)
+		{
+			stats.WorkerIdle.push_back(std::max(elapsed - busy, std::chrono::nanoseconds::zero()));
+		}
+		// Named after its mode, so the timeline tells the frames apart.
+		Trace::Record(stats.Mode, "frame", MandelbrotInternalData::FrameStart, MandelbrotInternalData::FrameStart + elapsed,
+			{ { "frame", stats.Frame }, { "generation", job.GetGeneration() }, { "complete", stats.Complete } });
+		Logger::GetLogger()->trace("Interior rejection: {} pixels short-circuited, {} periodic orbits.", stats.InteriorRejectedPixels, stats.PeriodicPixels);
+		if (frame.FramePrecision == Precision::Perturbation)
+		{
+			Logger::GetLogger()->trace("Perturbation: {} rebases, {} iterations skipped.", MandelbrotInternalData::FrameRebases.load(), stats.SkippedIterations);
+		}
+
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		MandelbrotInternalData::LastWorkerUtilization = std::move(utilization);
+		MandelbrotInternalData::LastSkippedIterations = stats.SkippedIterations;
+		MandelbrotInternalData::LastInteriorRejected = stats.InteriorRejectedPixels;
+		MandelbrotInternalData::LastPeriodicExits = stats.PeriodicPixels;
+		MandelbrotInternalData::LastFrameStats = std::move(stats);
+	}
+
+	template<typename T>
+	void ComputeLineIterations(long long x, long long y, std::size_t count, bool vertical, std::size_t stride, const MandelbrotProcessData& frame, std::uint32_t* iterations, float* smooth, std::vector<Kernel::ResumePoint>* resume)
+	{
+		const MandelbrotPlaneData& data = frame.Data;
+		const T scale = static_cast<T>(data.Zoom);
+		const T pixel_x = static_cast<T>(x) - static_cast<T>(MandelbrotInternalData::Width) / static_cast<T>(2);
+		const T pixel_y = static_cast<T>(y) - static_cast<T>(MandelbrotInternalData::Height) / static_cast<T>(2);
+		const T offset_x = static_cast<T>(data.OffsetX.ToLongDouble());
+		const T offset_y = static_cast<T>(data.OffsetY.ToLongDouble());
+
+		Kernel::RowSegment<T> segment;
+		segment.Origin = vertical ? offset_y : offset_x;
+		// With a power of two stride, `FirstPixel + i` stays exact and `(FirstPixel + i) * Scale` rounds
+		// the same product as at stride 1: samples are bit-identical to the full resolution pixels.
+		segment.Scale = scale * static_cast<T>(stride);
+		segment.FirstPixel = (vertical ? pixel_y : pixel_x) / static_cast<T>(stride);
+		segment.Fixed = vertical ? pixel_x * scale + offset_x : pixel_y * scale + offset_y;
+		segment.Vertical = vertical;
+		segment.Count = count;
+		segment.MaxIterations = frame.Colors.MaxIterations;
+		segment.PeriodTolerance = frame.Render.PeriodicityDetection ? Kernel::GetPeriodTolerance(scale) : static_cast<T>(0.0);
+		segment.Iterations = iterations;
+		segment.Smooth = smooth;
+		segment.Resume = resume;
+		const Kernel::RowStatistics statistics = Kernel::ComputeRow(segment);
+		MandelbrotInternalData::FrameInteriorRejected += statistics.InteriorRejected;
+		MandelbrotInternalData::FramePeriodicExits += statistics.PeriodicExits;
+		MandelbrotInternalData::FrameExecutedIterations += statistics.Iterations;
+	}
+
+	void ComputeLinePixels(long long x, long long y, std::size_t count, bool vertical, std::size_t stride, const MandelbrotProcessData& frame, std::uint32_t* iterations, float* smooth, std::vector<Kernel::ResumePoint>* resume)
+	{
+		switch (frame.FramePrecision)
+		{
+		case Precision::Float:
+			ComputeLineIterations<float>(x, y, count, vertical, stride, frame, iterations, smooth, resume);
+			break;
+		case Precision::Double:
+			ComputeLineIterations<double>(x, y, count, vertical, stride, frame, iterations, smooth, resume);
+			break;
+		case Precision::Perturbation:
+		{
+			// The reference orbit sits at the offset, so deltas are just the scaled pixel coordinates.
+			// There is no interior rejection here: `double` can not place these pixels relative
+			// to the cardioid boundary, and the whole frame may be closer to it than one ulp.
+			const double pixel_x = static_cast<double>(x) - static_cast<double>(MandelbrotInternalData::Width) / 2.0;
+			const double pixel_y = static_cast<double>(y) - static_cast<double>(MandelbrotInternalData::Height) / 2.0;
+			const double scale = static_cast<double>(frame.Data.Zoom);
+
+			Perturbation::DeltaRowSegment segment;
+			segment.FirstPixel = (vertical ? pixel_y : pixel_x) / static_cast<double>(stride);
+			segment.Scale = scale * static_cast<double>(stride);
+			segment.DeltaFixed = (vertical ? pixel_x : pixel_y) * scale;
+			segment.Vertical = vertical;
+			segment.Count = count;
+			segment.MaxIterations = frame.Colors.MaxIterations;
+			segment.Iterations = iterations;
+			segment.Smooth = smooth;
+			segment.Resume = resume;
+			const Perturbation::RowStatistics statistics = Perturbation::ComputeRow(*frame.Orbit, frame.Bla.get(), segment);
+			MandelbrotInternalData::FrameRebases += statistics.Rebases;
+			MandelbrotInternalData::FrameSkippedIterations += statistics.SkippedIterations;
+			MandelbrotInternalData::FrameExecutedIterations += statistics.Iterations;
+			break;
+		}
+		default:
+			// When precision is exhausted `long double` still gives the least blocky image.
+			// Its orbits are not saved: they would lose their precision in a `ResumePoint`.
+			ComputeLineIterations<long double>(x, y, count, vertical, stride, frame, iterations, smooth, nullptr);
+			break;
+		}
+	}
+
+	void ComputeLineIterations(std::size_t x, std::size_t y, std::size_t count, bool vertical, std::size_t stride, const MandelbrotProcessData& frame, std::uint32_t* iterations, float* smooth, std::vector<Kernel::ResumePoint>* resume)
+	{
+		const std::size_t first_point = resume ? resume->size() : 0;
+		ComputeLinePixels(static_cast<long long>(x), static_cast<long long>(y), count, vertical, stride, frame, iterations, smooth, resume);
+
+		// The kernels number the pixels along the line, the frame row by row.
+		if (resume)
+		{
+			for (std::size_t k = first_point; k < resume->size(); k++)
+			{
+				const std::size_t along = (*resume)[k].Pixel * stride;
+				const std::size_t pixel_x = vertical ? x : x + along;
+				const std::size_t pixel_y = vertical ? y + along : y;
+				(*resume)[k].Pixel = static_cast<std::uint32_t>(pixel_y * MandelbrotInternalData::Width + pixel_x);
+			}
+		}
+	}
+
+	void ComputeRowIterations(std::size_t x, std::size_t y, std::size_t count, const MandelbrotProcessData& frame, std::uint32_t* iterations, float* smooth, std::vector<Kernel::ResumePoint>* resume)
+	{
+		ComputeLineIterations(x, y, count, false, 1, frame, iterations, smooth, resume);
+	}
+
+	template<typename T>
+	void ContinueResumePoints(const MandelbrotProcessData& frame, const Kernel::ResumePoint* points, std::size_t count, std::size_t start_iteration, std::uint32_t* iterations, float* smooth, std::vector<Kernel::ResumePoint>* resume)
+	{
+		thread_local std::vector<T> cr;
+		thread_local std::vector<T> ci;
+		cr.resize(count);
+		ci.resize(count);
+
+		// Same formulas as `ComputeLineIterations` at stride 1: c is bit-identical to the one the points started from.
+		const T scale = static_cast<T>(frame.Data.Zoom);
+		const T offset_x = static_cast<T>(frame.Data.OffsetX.ToLongDouble());
+		const T offset_y = static_cast<T>(frame.Data.OffsetY.ToLongDouble());
+		for (std::size_t i = 0; i < count; i++)
+		{
+			const T pixel_x = static_cast<T>(points[i].Pixel % MandelbrotInternalData::Width) - static_cast<T>(MandelbrotInternalData::Width) / static_cast<T>(2);
+			const T pixel_y = static_cast<T>(points[i].Pixel / MandelbrotInternalData::Width) - static_cast<T>(MandelbrotInternalData::Height) / static_cast<T>(2);
+			cr[i] = pixel_x * scale + offset_x;
+			ci[i] = pixel_y * scale + offset_y;
+		}
+
+		Kernel::ResumeSegment<T> segment;
+		segment.Cr = cr.data();
+		segment.Ci = ci.data();
+		segment.Points = points;
+		segment.Count = count;
+		segment.StartIteration = start_iteration;
+		segment.MaxIterations = frame.Colors.MaxIterations;
+		segment.PeriodTolerance = frame.Render.PeriodicityDetection ? Kernel::GetPeriodTolerance(scale) : static_cast<T>(0.0);
+		segment.Iterations = iterations;
+		segment.Smooth = smooth;
+		segment.Resume = resume;
+		const Kernel::RowStatistics statistics = Kernel::ContinuePoints(segment);
+		MandelbrotInternalData::FrameInteriorRejected += statistics.InteriorRejected;
+		MandelbrotInternalData::FramePeriodicExits += statistics.PeriodicExits;
+		MandelbrotInternalData::FrameExecutedIterations += statistics.Iterations;
+	}
+
+	void ContinueResumePoints(const MandelbrotProcessData& frame, const Kernel::ResumePoint* points, std::size_t count, std::size_t start_iteration, std::vector<Kernel::ResumePoint>* resume)
+	{
+		thread_local std::vector<std::uint32_t> iterations;
+		thread_local std::vector<float> smooth;
+		iterations.resize(count);
+		smooth.resize(MandelbrotInternalData::RetainedSmooth ? count : 0);
+		float* smooth_data = MandelbrotInternalData::RetainedSmooth ? smooth.data() : nullptr;
+
+		const std::size_t first_point = resume ? resume->size() : 0;
+
+		switch (frame.FramePrecision)
+		{
+		case Precision::Float:
+			ContinueResumePoints<float>(frame, points, count, start_iteration, iterations.data(), smooth_data, resume);
+			break;
+		case Precision::Double:
+			ContinueResumePoints<double>(frame, points, count, start_iteration, iterations.data(), smooth_data, resume);
+			break;
+		case Precision::Perturbation:
+		{
+			thread_local std::vector<double> delta_cr;
+			thread_local std::vector<double> delta_ci;
+			delta_cr.resize(count);
+			delta_ci.resize(count);
+
+			const double scale = static_cast<double>(frame.Data.Zoom);
+			for (std::size_t i = 0; i < count; i++)
+			{
+				delta_cr[i] = (static_cast<double>(points[i].Pixel % MandelbrotInternalData::Width) - static_cast<double>(MandelbrotInternalData::Width) / 2.0) * scale;
+				delta_ci[i] = (static_cast<double>(points[i].Pixel / MandelbrotInternalData::Width) - static_cast<double>(MandelbrotInternalData::Height) / 2.0) * scale;
+			}
+
+			Perturbation::DeltaResumeSegment segment;
+			segment.DeltaCr = delta_cr.data();
+			segment.DeltaCi = delta_ci.data();
+			segment.Points = points;
+			segment.Count = count;
+			segment.StartIteration = start_iteration;
+			segment.MaxIterations = frame.Colors.MaxIterations;
+			segment.Iterations = iterations.data();
+			segment.Smooth = smooth_data;
+			segment.Resume = resume;
+			const Perturbation::RowStatistics statistics = Perturbation::ContinuePoints(*frame.Orbit, frame.Bla.get(), segment);
+			MandelbrotInternalData::FrameRebases += statistics.Rebases;
+			MandelbrotInternalData::FrameSkippedIterations += statistics.SkippedIterations;
+			MandelbrotInternalData::FrameExecutedIterations += statistics.Iterations;
+			break;
+		}
+		default:
+			// Never saved, see `ComputeLineIterations`.
+			return;
+		}
+
+		for (std::size_t i = 0; i < count; i++)
+		{
+			MandelbrotInternalData::FrameIterations[points[i].Pixel] = iterations[i];
+			if (smooth_data)
+			{
+				MandelbrotInternalData::FrameSmooth[points[i].Pixel] = smooth_data[i];
+			}
+		}
+		// The kernels number the points as given, the frame by pixel.
+		if (resume)
+		{
+			for (std::size_t k = first_point; k < resume->size(); k++)
+			{
+				(*resume)[k].Pixel = points[(*resume)[k].Pixel].Pixel;
+			}
+		}
+	}
+
+	std::size_t GetPointIterations(const sf::Vector2ld& plane_coords)
+	{
+		if (Kernel::IsInMainCardioidOrBulb(plane_coords.x, plane_coords.y))
+		{
+			return MandelbrotInternalData::MaxIterations;
+		}
+
+		long double zReal = plane_coords.x;
+		long double zImag = plane_coords.y;
+
+		// Brent's cycle detection: z is compared against a value saved at the end of windows doubling in length.
+		const bool check_period = MandelbrotInternalData::UsingPeriodicityDetection;
+		const long double tolerance = Kernel::GetPeriodTolerance(MandelbrotInternalData::PlaneData.Zoom);
+		long double savedReal = zReal;
+		long double savedImag = zImag;
+		std::size_t window = Kernel::PeriodCheckFirstWindow;
+		std::size_t steps = 0;
+
+		for (std::size_t iter = 0; iter < MandelbrotInternalData::MaxIterations; iter++) {
+			long double r2 = zReal * zReal;
+			long double i2 = zImag * zImag;
+			if (r2 + i2 > 4.0)
+			{
+				return iter;
+			}
+			zImag = 2.0 * zReal * zImag + plane_coords.y;
+			zReal = r2 - i2 + plane_coords.x;
+
+			if (check_period)
+			{
+				steps++;
+				const long double dReal = zReal - savedReal;
+				const long double dImag = zImag - savedImag;
+				if (dReal * dReal + dImag * dImag <= tolerance * tolerance && Kernel::IsAttractingCycle(zReal, zImag, plane_coords.x, plane_coords.y, steps))
+				{
+					break;
+				}
+				if (steps == window)
+				{
+					savedReal = zReal;
+					savedImag = zImag;
+					steps = 0;
+					window *= 2;
+				}
+			}
+		}
+		return MandelbrotInternalData::MaxIterations;
+	}
+
+	void SetMaxIterations(std::size_t iter)
+	{
+		MandelbrotInternalData::MaxIterations = iter;
+		MandelbrotInternalData::PlaneGeneration++;
+	}
+
+	std::size_t GetMaxIterations()
+	{
+		return MandelbrotInternalData::MaxIterations;
+	}
+
+	void SetDefaultMaxIterations(std::size_t iter)
+	{
+		if (iter > 0)
+		{
+			MandelbrotInternalData::DefaultMaxIterations = iter;
+		}
+	}
+
+	std::size_t GetDefaultMaxIterations()
+	{
+		return MandelbrotInternalData::DefaultMaxIterations;
+	}
+
+	sf::Color GetPointColor(std::size_t iterations)
+	{
+		if (iterations == MandelbrotInternalData::MaxIterations)
+		{
+			return { 0, 0, 0 };
+		}
+		return GetPaletteColor(Palette::Classic, iterations);
+	}
+
+	sf::Color GetPaletteColor(Palette palette, std::size_t index)
+	{
+		const std::uint32_t color = Palettes::GetEntry(palette, index);
+		return { static_cast<sf::Uint8>(color), static_cast<sf::Uint8>(color >> 8), static_cast<sf::Uint8>(color >> 16), static_cast<sf::Uint8>(color >> 24) };
+	}
+
+	void SetMaxThreads(std::size_t threads)
+	{
+		threads = std::max<std::size_t>(threads, 1);
+		if (threads == MandelbrotInternalData::ThreadCounter)
+		{
+			return;
+		}
+
+		// The running job works on the pool, so it must be done before the pool is restarted.
+		CancelActiveJob();
+		MandelbrotInternalData::ThreadCounter = threads;
+
+		// Threads are only ever created here and in `Init`, never while processing a frame.
+		// A single worker leaves the pool without threads, so the job runner tells whether `Init` ran.
+		if (MandelbrotInternalData::JobRunner.GetThreadCount() > 0)
+		{
+			MandelbrotInternalData::Pool.Start(MandelbrotInternalData::ThreadCounter - 1);
+		}
+	}
+
+	std::size_t GetMaxThreads()
+	{
+		return MandelbrotInternalData::ThreadCounter;
+	}
+
+	void UseVertexBuffer(bool enable)
+	{
+		// Disabling it never asks for the availability, so headless renders don't need an OpenGL context.
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		MandelbrotInternalData::UsingVertexBuffer = enable && sf::VertexBuffer::isAvailable();
+		if (!MandelbrotInternalData::UsingVertexBuffer)
+		{
+			std::vector<sf::Vertex>().swap(MandelbrotInternalData::MdVertexBuffer.MandelbrotVertices);
+		}
+
+		// Use VertexBuffer
+		if (MandelbrotInternalData::UsingVertexBuffer)
+		{
+			MandelbrotInternalData::DrawFncPtr = std::bind(Mandelbrot::DrawVertexBuffer, std::placeholders::_1);
+		}
+		// Use Sprite
+		else
+		{
+			MandelbrotInternalData::DrawFncPtr = std::bind(Mandelbrot::DrawSprite, std::placeholders::_1);
+		}
+	}
+
+	bool IsUsingVertexBuffer()
+	{
+		return MandelbrotInternalData::UsingVertexBuffer;
+	}
+
+	const sf::Color* GetFramePixels()
+	{
+		return MandelbrotInternalData::FrameColors.data();
+	}
+
+	void SetResolution(const sf::Vector2u& resolution)
+	{
+		const std::size_t width = std::max<std::size_t>(resolution.x, 1);
+		const std::size_t height = std::max<std::size_t>(resolution.y, 1);
+		if (width == MandelbrotInternalData::Width && height == MandelbrotInternalData::Height)
+		{
+			return;
+		}
+
+		// Render jobs read the size all along, so the running one must be done before it changes.
+		CancelActiveJob();
+
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		MandelbrotInternalData::Width = width;
+		MandelbrotInternalData::Height = height;
+		MandelbrotInternalData::FrameSize = width * height;
+		MandelbrotInternalData::FrameTiles = Scheduler::MakeTiles(width, height);
+
+		// Nothing of the previous frame can be reused. Its buffers are released here, and the
+		// next frame allocates them again with the new size.
+		MandelbrotInternalData::RetainedFrameValid = false;
+		MandelbrotInternalData::ResumeValid = false;
+		std::vector<Kernel::ResumePoint>().swap(MandelbrotInternalData::ResumePoints);
+		std::vector<std::uint32_t>().swap(MandelbrotInternalData::FrameIterations);
+		std::vector<float>().swap(MandelbrotInternalData::FrameSmooth);
+		std::vector<sf::Color>().swap(MandelbrotInternalData::FrameColors);
+		std::vector<std::uint32_t>().swap(MandelbrotInternalData::ScratchIterations);
+		std::vector<float>().swap(MandelbrotInternalData::ScratchSmooth);
+		std::vector<sf::Color>().swap(MandelbrotInternalData::ScratchColors);
+		std::vector<sf::Vertex>().swap(MandelbrotInternalData::MdVertexBuffer.MandelbrotVertices);
+
+		MandelbrotInternalData::StateChanged = true;
+		MandelbrotInternalData::PlaneGeneration++;
+	}
+
+	sf::Vector2u GetResolution()
+	{
+		return { static_cast<unsigned int>(MandelbrotInternalData::Width), static_cast<unsigned int>(MandelbrotInternalData::Height) };
+	}
+
+	void DrawMandelbrotSet(sf::RenderWindow& renderer)
+	{
+		MandelbrotInternalData::DrawFncPtr(renderer);
+	}
+
+	// Both draw functions upload the last published frame themselves, so the GPU resources are only
+	// touched by the thread which draws.
+	void DrawVertexBuffer(sf::RenderWindow& renderer)
+	{
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		const auto& vertices = MandelbrotInternalData::MdVertexBuffer.MandelbrotVertices;
+		if (vertices.empty())
+		{
+			return;
+		}
+
+		auto& buffer = MandelbrotInternalData::MdVertexBuffer.MandelbrotBuffer;
+		if (!buffer)
+		{
+			buffer = std::make_unique<sf::VertexBuffer>(sf::PrimitiveType::Points, sf::VertexBuffer::Usage::Stream);
+		}
+		// Grown or shrunk along with the resolution.
+		if (buffer->getVertexCount() != vertices.size())
+		{
+			buffer->create(vertices.size());
+			MandelbrotInternalData::FrameDirty = true;
+		}
+		if (MandelbrotInternalData::FrameDirty)
+		{
+			MandelbrotInternalData::LastUpload = std::chrono::nanoseconds::zero();
+			const Trace::Scope trace("upload", "phase");
+			const Stats::ScopedTimer upload(MandelbrotInternalData::LastUpload);
+			buffer->update(vertices.data());
+			MandelbrotInternalData::FrameDirty = false;
+		}
+		MandelbrotInternalData::LastDraw = std::chrono::nanoseconds::zero();
+		const Trace::Scope trace("draw", "phase");
+		const Stats::ScopedTimer draw(MandelbrotInternalData::LastDraw);
+		renderer.draw(*buffer);
+	}
+	
+	void DrawSprite(sf::RenderWindow& renderer)
+	{
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		auto& texture = MandelbrotInternalData::MdSprite.MdTexture;
+		if (!texture)
+		{
+			texture = std::make_unique<sf::Texture>();
+		}
+		if (MandelbrotInternalData::FrameDirty)
+		{
+			MandelbrotInternalData::LastUpload = std::chrono::nanoseconds::zero();
+			const Trace::Scope trace("upload", "phase");
+			const Stats::ScopedTimer upload(MandelbrotInternalData::LastUpload);
+			texture->loadFromImage(MandelbrotInternalData::MdSprite.MdImage);
+			MandelbrotInternalData::MdSprite.MdSprite.setTexture(*texture);
+			MandelbrotInternalData::FrameDirty = false;
+		}
+		MandelbrotInternalData::LastDraw = std::chrono::nanoseconds::zero();
+		const Trace::Scope trace("draw", "phase");
+		const Stats::ScopedTimer draw(MandelbrotInternalData::LastDraw);
+		renderer.draw(MandelbrotInternalData::MdSprite.MdSprite);
+	}
+
+	void SetZoom(const long double& zoom)
+	{
+		MandelbrotInternalData::PreviousPlaneData.Zoom = MandelbrotInternalData::PlaneData.Zoom;
+
+		MandelbrotInternalData::StateChanged = true;
+		MandelbrotInternalData::PlaneGeneration++;
+
+		MandelbrotInternalData::PlaneData.Zoom = zoom;
+	}
+
+	long double GetZoom()
+	{
+		return MandelbrotInternalData::PlaneData.Zoom;
+	}
+
+	void SetDefaultZoom(long double zoom)
+	{
+		MandelbrotInternalData::DefaultPlaneData.Zoom = zoom;
+	}
+
+	long double GetDefaultZoom()
+	{
+		return MandelbrotInternalData::DefaultPlaneData.Zoom;
+	}
+
+	Precision GetFramePrecision()
+	{
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		return MandelbrotInternalData::FramePrecision;
+	}
+
+	Precision GetRequiredPrecision()
+	{
+		return SelectPrecision(MandelbrotInternalData::PlaneData, GetRenderData());
+	}
+
+	const char* GetPrecisionName(Precision precision)
+	{
+		switch (precision)
+		{
+		case Precision::Float:
+			return "float";
+		case Precision::Double:
+			return "double";
+		case Precision::LongDouble:
+			return "long double";
+		case Precision::Perturbation:
+			return "perturbation";
+		default:
+			return "exhausted";
+		}
+	}
+
+	void UseDeepZoom(bool enable)
+	{
+		MandelbrotInternalData::UsingDeepZoom = enable;
+	}
+
+	bool IsUsingDeepZoom()
+	{
+		return MandelbrotInternalData::UsingDeepZoom;
+	}
+
+	void UseLinearApproximation(bool enable)
+	{
+		MandelbrotInternalData::UsingLinearApproximation = enable;
+	}
+
+	bool IsUsingLinearApproximation()
+	{
+		return MandelbrotInternalData::UsingLinearApproximation;
+	}
+
+	std::size_t GetSkippedIterations()
+	{
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		return MandelbrotInternalData::LastSkippedIterations;
+	}
+
+	std::size_t GetInteriorRejectedPixels()
+	{
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		return MandelbrotInternalData::LastInteriorRejected;
+	}
+
+	void UsePeriodicityDetection(bool enable)
+	{
+		MandelbrotInternalData::UsingPeriodicityDetection = enable;
+	}
+
+	bool IsUsingPeriodicityDetection()
+	{
+		return MandelbrotInternalData::UsingPeriodicityDetection;
+	}
+
+	std::size_t GetPeriodicPixels()
+	{
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		return MandelbrotInternalData::LastPeriodicExits;
+	}
+
+	// Tells why the frames aren't subdivided, see `GetRenderData`.
+	static void WarnSubdivisionSkipped()
+	{
+		if (MandelbrotInternalData::UsingSubdivision && MandelbrotInternalData::UsingSmoothColoring)
+		{
+			Logger::GetLogger()->warn("Subdivision is skipped while smooth colouring is on.");
+		}
+	}
+
+	void UseSubdivision(bool enable)
+	{
+		MandelbrotInternalData::UsingSubdivision = enable;
+		WarnSubdivisionSkipped();
+	}
+
+	bool IsUsingSubdivision()
+	{
+		return MandelbrotInternalData::UsingSubdivision;
+	}
+
+	std::size_t GetComputedPixels()
+	{
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		return MandelbrotInternalData::LastSubdivisionStatistics.ComputedPixels;
+	}
+
+	std::size_t GetFilledPixels()
+	{
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		return MandelbrotInternalData::LastSubdivisionStatistics.FilledPixels;
+	}
+
+	void UseIncrementalPanning(bool enable)
+	{
+		MandelbrotInternalData::UsingIncrementalPanning = enable;
+	}
+
+	bool IsUsingIncrementalPanning()
+	{
+		return MandelbrotInternalData::UsingIncrementalPanning;
+	}
+
+	void UseZoomReprojection(bool enable)
+	{
+		MandelbrotInternalData::UsingZoomReprojection = enable;
+	}
+
+	bool IsUsingZoomReprojection()
+	{
+		return MandelbrotInternalData::UsingZoomReprojection;
+	}
+
+	void UseResumableIterations(bool enable)
+	{
+		MandelbrotInternalData::UsingResumableIterations = enable;
+	}
+
+	bool IsUsingResumableIterations()
+	{
+		return MandelbrotInternalData::UsingResumableIterations;
+	}
+
+	void SetMinimumPrecision(Precision precision)
+	{
+		// Frames can't be forced to run out of precision.
+		MandelbrotInternalData::MinimumPrecision = std::min(precision, Precision::Perturbation);
+	}
+
+	Precision GetMinimumPrecision()
+	{
+		return MandelbrotInternalData::MinimumPrecision;
+	}
+
+	std::vector<double> GetWorkerUtilization()
+	{
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		return MandelbrotInternalData::LastWorkerUtilization;
+	}
+
+	Stats::FrameStats GetLastFrameStats()
+	{
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		Stats::FrameStats stats = MandelbrotInternalData::LastFrameStats;
+		stats.Phases[static_cast<std::size_t>(Stats::Phase::Upload)] = MandelbrotInternalData::LastUpload;
+		stats.Phases[static_cast<std::size_t>(Stats::Phase::Draw)] = MandelbrotInternalData::LastDraw;
+		return stats;
+	}
+
+	const std::uint32_t* GetFrameIterations()
+	{
+		return MandelbrotInternalData::FrameIterations.data();
+	}
+
+	void DiscardRetainedFrame()
+	{
+		// The retained frame belongs to the render job thread.
+		RenderJob active;
+		{
+			std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+			active = MandelbrotInternalData::ActiveJob;
+		}
+		active.Wait();
+
+		MandelbrotInternalData::RetainedFrameValid = false;
+		MandelbrotInternalData::ResumeValid = false;
+	}
+
+	void UseTileCache(bool enable)
+	{
+		MandelbrotInternalData::UsingTileCache = enable;
+	}
+
+	bool IsUsingTileCache()
+	{
+		return MandelbrotInternalData::UsingTileCache;
+	}
+
+	void SetTileCacheBudget(std::size_t bytes)
+	{
+		MandelbrotInternalData::Tiles.SetBudget(bytes);
+	}
+
+	std::size_t GetTileCacheBudget()
+	{
+		return MandelbrotInternalData::Tiles.GetBudget();
+	}
+
+	void SetTileCacheDirectory(const std::string& path)
+	{
+		MandelbrotInternalData::Tiles.SetDirectory(path);
+	}
+
+	std::string GetTileCacheDirectory()
+	{
+		return MandelbrotInternalData::Tiles.GetDirectory();
+	}
+
+	void SetTileCacheDiskBudget(std::size_t bytes)
+	{
+		MandelbrotInternalData::Tiles.SetDiskBudget(bytes);
+	}
+
+	std::size_t GetTileCacheDiskBudget()
+	{
+		return MandelbrotInternalData::Tiles.GetDiskBudget();
+	}
+
+	void UseTracing(bool enable)
+	{
+		Trace::Enable(enable);
+	}
+
+	bool IsUsingTracing()
+	{
+		return Trace::IsEnabled();
+	}
+
+	bool WriteTrace(const std::string& path)
+	{
+		// Between two jobs, and under the publication lock, the workers and the draw functions record nothing.
+		std::promise<std::string> trace;
+		std::future<std::string> json = trace.get_future();
+		MandelbrotInternalData::JobRunner.Submit([&trace]()
+		{
+			std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+			std::string events = Trace::ToJson();
+			// Before the caller is released, since it may record again.
+			Trace::Clear();
+			trace.set_value(std::move(events));
+		});
+		return Stats::WriteJson(json.get(), path);
+	}
+
+	void UseProgressiveRendering(bool enable)
+	{
+		MandelbrotInternalData::UsingProgressiveRendering = enable;
+	}
+
+	bool IsUsingProgressiveRendering()
+	{
+		return MandelbrotInternalData::UsingProgressiveRendering;
+	}
+
+	// Colour changes mark the state as changed without touching the plane generation:
+	// the next frame only recolours the retained one.
+	void SetPalette(Palette palette)
+	{
+		MandelbrotInternalData::ColorPalette = palette;
+		MandelbrotInternalData::StateChanged = true;
+	}
+
+	Palette GetPalette()
+	{
+		return MandelbrotInternalData::ColorPalette;
+	}
+
+	const char* GetPaletteName(Palette palette)
+	{
+		switch (palette)
+		{
+		case Palette::Grayscale:
+			return "grayscale";
+		default:
+			return "classic";
+		}
+	}
+
+	void SetColorCycle(std::size_t offset)
+	{
+		MandelbrotInternalData::ColorCycle = offset;
+		MandelbrotInternalData::StateChanged = true;
+	}
+
+	std::size_t GetColorCycle()
+	{
+		return MandelbrotInternalData::ColorCycle;
+	}
+
+	void UseSmoothColoring(bool enable)
+	{
+		MandelbrotInternalData::UsingSmoothColoring = enable;
+		MandelbrotInternalData::StateChanged = true;
+		WarnSubdivisionSkipped();
+	}
+
+	bool IsUsingSmoothColoring()
+	{
+		return MandelbrotInternalData::UsingSmoothColoring;
+	}
+
+	void UseHistogramColoring(bool enable)
+	{
+		MandelbrotInternalData::UsingHistogramColoring = enable;
+		MandelbrotInternalData::StateChanged = true;
+	}
+
+	bool IsUsingHistogramColoring()
+	{
+		return MandelbrotInternalData::UsingHistogramColoring;
+	}
+
+	void SetOffset(const sf::Vector2ld& offset)
+	{
+		SetPreciseOffset({ HighPrecision(offset.x), HighPrecision(offset.y) });
+	}
+
+	sf::Vector2ld GetOffset()
+	{
+		return {
+			MandelbrotInternalData::PlaneData.OffsetX.ToLongDouble(),
+			MandelbrotInternalData::PlaneData.OffsetY.ToLongDouble()
+		};
+	}
+
+	void SetDefaultOffset(const sf::Vector2ld& offset)
+	{
+		SetPreciseDefaultOffset({ HighPrecision(offset.x), HighPrecision(offset.y) });
+	}
+
+	sf::Vector2ld GetDefaultOffset()
+	{
+		return {
+			MandelbrotInternalData::DefaultPlaneData.OffsetX.ToLongDouble(),
+			MandelbrotInternalData::DefaultPlaneData.OffsetY.ToLongDouble()
+		};
+	}
+
+	void SetPreciseOffset(const sf::Vector2hp& offset)
+	{
+		MandelbrotInternalData::PreviousPlaneData.OffsetX = MandelbrotInternalData::PlaneData.OffsetX;
+		MandelbrotInternalData::PreviousPlaneData.OffsetY = MandelbrotInternalData::PlaneData.OffsetY;
+
+		MandelbrotInternalData::StateChanged = true;
+		MandelbrotInternalData::PlaneGeneration++;
+
+		MandelbrotInternalData::PlaneData.OffsetX = offset.x;
+		MandelbrotInternalData::PlaneData.OffsetY = offset.y;
+	}
+
+	sf::Vector2hp GetPreciseOffset()
+	{
+		return {
+			MandelbrotInternalData::PlaneData.OffsetX,
+			MandelbrotInternalData::PlaneData.OffsetY
+		};
+	}
+
+	void SetPreciseDefaultOffset(const sf::Vector2hp& offset)
+	{
+		MandelbrotInternalData::DefaultPlaneData.OffsetX = offset.x;
+		MandelbrotInternalData::DefaultPlaneData.OffsetY = offset.y;
+	}
+
+	sf::Vector2hp GetPreciseDefaultOffset()
+	{
+		return {
+			MandelbrotInternalData::DefaultPlaneData.OffsetX,
+			MandelbrotInternalData::DefaultPlaneData.OffsetY
+		};
+	}
+
+	void MoveOffset(const sf::Vector2ld& delta)
+	{
+		// The offset must be precise enough to hold both the delta and a pixel of the current zoom.
+		const long double resolution = std::min(std::fabs(MandelbrotInternalData::PlaneData.Zoom), std::max(std::fabs(delta.x), std::fabs(delta.y)));
+		const std::size_t fraction_limbs = HighPrecision::LimbsForResolution(resolution);
+
+		sf::Vector2hp offset = GetPreciseOffset();
+		offset.x.SetFractionLimbs(std::max(fraction_limbs, offset.x.GetFractionLimbs()));
+		offset.y.SetFractionLimbs(std::max(fraction_limbs, offset.y.GetFractionLimbs()));
+		offset.x += HighPrecision(delta.x, offset.x.GetFractionLimbs());
+		offset.y += HighPrecision(delta.y, offset.y.GetFractionLimbs());
+
+		SetPreciseOffset(offset);
+	}
+
+	RenderJob Update()
+	{
+		if (MandelbrotInternalData::StateChanged)
+		{
+			return ForceUpdate();
+		}
+
+		std::lock_guard<std::mutex> lock(MandelbrotInternalData::Mutex);
+		return MandelbrotInternalData::ActiveJob;
+	}
+
+	RenderJob ForceUpdate()
+	{
+		MandelbrotInternalData::StateChanged = false;
+		return SubmitRender();
+	}
+
+	std::uint64_t GetPlaneGeneration()
+	{
+		return MandelbrotInternalData::PlaneGeneration;
 	}
 
 }
\ No newline at end of file